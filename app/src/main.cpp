@@ -1,28 +1,203 @@
 #include "dot_Engine.h"
 #include "dot_Exception.h"
+#include "dot_Logger.h"
 
+#include <algorithm>
 #include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
 
-int main()
+// usage: App [--benchmark <scene> [--frames N] [--results path] [--baseline path [--record-baseline]] [--tolerance t]]
+//            [--microbench N]
+//            [--capture path] [--replay path [--paced] [--timings path]]
+//            [--log-level verbose|info|warning|error] [--crash-dump path]
+//            [--on-demand] [--idle-check seconds] [--cache-commands] [--frames-in-flight N] [--no-depth] [--no-sort]
+//            [--post tonemap,grade,vignette,fxaa|all [--post-split]] [--msaa 2|4|8] [--no-dynamic-rendering]
+//            [--no-dynamic-state] [--no-pipeline-library] [--push-transforms] [--hot-reload]
+// benchmark runs open a hidden window and exit with 1 when a metric regresses against the baseline, 77 when skipped
+// idle check renders a static scene on demand and exits with 1 when the process uses more than 2% of a core
+
+int main(int argc, char** argv)
 {
-    Window wnd;
-    dot::Engine engine(wnd);
+    std::vector<std::string> args(argv + 1, argv + argc);
+
+    bool benchmark = false;
+    size_t microbenchIterations = 0;
+    dot::BenchmarkConfig benchmarkConfig;
+    dot::ReplayConfig replayConfig;
+    std::string capturePath;
+    dot::LoggerConfig loggerConfig;
+    bool onDemand = false;
+    bool cacheCommands = false;
+    dot::RendererConfig rendererConfig;
+    double idleCheckSeconds = 0.0;
+
+    try
+    {
+        for(size_t i = 0; i < args.size(); i++)
+        {
+            const bool hasValue = i + 1 < args.size();
+
+            if(args[i] == "--benchmark" && hasValue)
+            {
+                benchmark = true;
+                benchmarkConfig.scene = dot::Benchmark::parseScene(args[++i]);
+            }
+            else if(args[i] == "--microbench" && hasValue)
+                microbenchIterations = std::stoul(args[++i]);
+            else if(args[i] == "--capture" && hasValue)
+                capturePath = args[++i];
+            else if(args[i] == "--replay" && hasValue)
+                replayConfig.capturePath = args[++i];
+            else if(args[i] == "--paced")
+                replayConfig.paced = true;
+            else if(args[i] == "--timings" && hasValue)
+                replayConfig.timingsPath = args[++i];
+            else if(args[i] == "--frames" && hasValue)
+                benchmarkConfig.frames = std::stoul(args[++i]);
+            else if(args[i] == "--results" && hasValue)
+                benchmarkConfig.resultsPath = args[++i];
+            else if(args[i] == "--baseline" && hasValue)
+                benchmarkConfig.baselinePath = args[++i];
+            else if(args[i] == "--record-baseline")
+                benchmarkConfig.recordBaseline = true;
+            else if(args[i] == "--tolerance" && hasValue)
+                benchmarkConfig.tolerance = std::stod(args[++i]);
+            else if(args[i] == "--log-level" && hasValue)
+            {
+                // the given severity and everything more severe
+
+                const std::string level = args[++i];
+                const std::vector<std::string> levels = {"verbose", "info", "warning", "error"};
+
+                auto found = std::find(levels.begin(), levels.end(), level);
+                if(found == levels.end())
+                    throw DOT_RUNTIME("Unknown log level: " + level);
+
+                loggerConfig.severities = ~((1U << (found - levels.begin())) - 1) & 0xF;
+            }
+            else if(args[i] == "--crash-dump" && hasValue)
+                loggerConfig.crashDumpPath = args[++i];
+            else if(args[i] == "--on-demand")
+                onDemand = true;
+            else if(args[i] == "--frames-in-flight" && hasValue)
+                rendererConfig.framesInFlight = std::stoul(args[++i]);
+            else if(args[i] == "--no-depth")
+                rendererConfig.depth = false;
+            else if(args[i] == "--post" && hasValue)
+            {
+                // comma separated effects, they always run in the order tonemap, grade, vignette, fxaa
+
+                const std::vector<std::pair<std::string, uint32_t>> effects =
+                {
+                    {"tonemap", dot::PostTonemap}, {"grade", dot::PostGrade}, {"vignette", dot::PostVignette}, {"fxaa", dot::PostFxaa},
+                    {"all", dot::PostTonemap | dot::PostGrade | dot::PostVignette | dot::PostFxaa}
+                };
+
+                std::stringstream list(args[++i]);
+                for(std::string name; std::getline(list, name, ',');)
+                {
+                    auto found = std::find_if(effects.begin(), effects.end(), [&](const auto& effect){ return effect.first == name; });
+                    if(found == effects.end())
+                        throw DOT_RUNTIME("Unknown post effect: " + name);
+
+                    rendererConfig.post.effects |= found->second;
+                }
+            }
+            else if(args[i] == "--post-split")
+                rendererConfig.post.merged = false;
+            else if(args[i] == "--msaa" && hasValue)
+                rendererConfig.samples = std::stoul(args[++i]);
+            else if(args[i] == "--hot-reload")
+                rendererConfig.hotReload = true;
+            else if(args[i] == "--no-dynamic-rendering")
+                rendererConfig.dynamicRendering = false;
+            else if(args[i] == "--no-dynamic-state")
+                benchmarkConfig.dynamicState = false;
+            else if(args[i] == "--no-pipeline-library")
+                benchmarkConfig.pipelineLibrary = false;
+            else if(args[i] == "--push-transforms")
+                benchmarkConfig.pushTransforms = true;
+            else if(args[i] == "--no-sort")
+                benchmarkConfig.sortOpaque = false;
+            else if(args[i] == "--cache-commands")
+                benchmarkConfig.cacheCommands = cacheCommands = true;
+            else if(args[i] == "--idle-check" && hasValue)
+                idleCheckSeconds = std::stod(args[++i]);
+            else
+                throw DOT_RUNTIME("Unknown argument: " + args[i]);
+        }
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        return 2;
+    }
+
+    // configured before the engine so the debug messenger is registered with the final filter
+    dot::Logger::get().configure(loggerConfig);
+
+    Window wnd(!benchmark && !microbenchIterations && !idleCheckSeconds);
+    dot::Engine engine(wnd, capturePath, rendererConfig);
 
     try
     {
+        if(benchmark)
+        {
+            switch(engine.benchmark(benchmarkConfig))
+            {
+                case dot::BenchmarkResult::Passed:      return 0;
+                case dot::BenchmarkResult::Regressed:   return 1;
+                case dot::BenchmarkResult::Skipped:     return dot::Benchmark::skipExitCode;
+            }
+
+            return 1;
+        }
+
+        if(!replayConfig.capturePath.empty())
+        {
+            engine.replay(replayConfig);
+            return 0;
+        }
+
+        if(microbenchIterations)
+        {
+            engine.microbench(microbenchIterations);
+            return 0;
+        }
+
+        if(idleCheckSeconds > 0.0)
+        {
+            const double usage = engine.idleCpuUsage(idleCheckSeconds);
+            std::cout << "Idle cpu usage: " << usage * 100.0 << "%\n";
+            return usage <= 0.02 ? 0 : 1;
+        }
+
+        if(onDemand)
+            engine.setRenderMode(dot::RenderMode::OnDemand);
+
+        engine.setCommandCaching(cacheCommands);
+
         engine.run();
     }
     catch(const dot::RuntimeError& e)
     {
+        dot::Logger::get().flush();
         std::cerr << e.what() << '\n';
+        return 1;
     }
     catch(const std::exception& e)
     {
+        dot::Logger::get().flush();
         std::cerr << e.what() << '\n';
+        return 1;
     }
     catch(...)
     {
+        dot::Logger::get().flush();
         std::cerr << "Unknown error occurred!" << '\n';
+        return 1;
     }
 
     return 0;
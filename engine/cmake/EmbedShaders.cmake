@@ -0,0 +1,60 @@
+# writes a source defining the words of every spir-v file as a constexpr array, with a lookup by file name
+# usage: cmake -DOUTPUT=<source> -DSHADERS=<a.spv|b.spv|...> -P EmbedShaders.cmake
+
+string(REPLACE "|" ";" SHADERS "${SHADERS}")
+
+set(ARRAYS "")
+set(ENTRIES "")
+set(INDEX 0)
+
+foreach(SHADER IN LISTS SHADERS)
+    file(READ ${SHADER} HEX HEX)
+    get_filename_component(NAME ${SHADER} NAME)
+
+    # spir-v is a stream of little endian words, 8 hex digits each; 8 words per line
+    string(REGEX REPLACE "(..)(..)(..)(..)" "0x\\4\\3\\2\\1," WORDS "${HEX}")
+    string(REPEAT "0x........," 8 LINE)
+    string(REGEX REPLACE "(${LINE})" "\\1\n        " WORDS "${WORDS}")
+    string(REPLACE ",0x" ", 0x" WORDS "${WORDS}")
+    string(STRIP "${WORDS}" WORDS)
+
+    string(APPEND ARRAYS "    alignas(4) constexpr uint32_t shader${INDEX}[] =\n    {\n        ${WORDS}\n    };\n\n")
+    string(APPEND ENTRIES "        {\"${NAME}\", shader${INDEX}},\n")
+    math(EXPR INDEX "${INDEX} + 1")
+endforeach()
+
+file(WRITE ${OUTPUT}.tmp
+"// generated by EmbedShaders.cmake, do not edit
+
+#include \"dot_EmbeddedShaders.h\"
+
+namespace
+{
+${ARRAYS}    struct Entry
+    {
+        std::string_view name;
+        std::span<const uint32_t> code;
+    };
+
+    constexpr Entry entries[] =
+    {
+${ENTRIES}        {}
+    };
+}
+
+namespace dot
+{
+    std::span<const uint32_t> findEmbeddedShader(std::string_view name) noexcept
+    {
+        for(const Entry* pEntry = entries; !pEntry->name.empty(); pEntry++)
+            if(pEntry->name == name)
+                return pEntry->code;
+
+        return {};
+    }
+}
+")
+
+# an unchanged source keeps the library from recompiling
+file(COPY_FILE ${OUTPUT}.tmp ${OUTPUT} ONLY_IF_DIFFERENT)
+file(REMOVE ${OUTPUT}.tmp)
@@ -4,6 +4,7 @@
 
 #include <string>
 #include <fstream>
+#include <span>
 #include <vector>
 
 class Shader
@@ -14,13 +15,19 @@ public:
     ~Shader();
     operator const vk::ShaderModule&() const noexcept;
     void read(const std::string& filename);
+    void load(std::vector<char> bytes);
+    void load(std::span<const uint32_t> staticCode);
     const vk::ShaderModule& getModule() const noexcept;
+    std::span<const uint32_t> getCode() const noexcept;    // spir-v words, valid as long as the shader
+
+    static std::vector<char> readCode(const std::string& filename);     // embedded code by file name
+    static std::vector<char> readFile(const std::string& filename);
 private:
-    std::vector<char> readFile() const;
-    vk::ShaderModule createShaderModule() const;
+    vk::ShaderModule createShaderModule(std::span<const uint32_t> code) const;
 
     std::string filename;
     std::vector<char> data;
+    std::span<const uint32_t> code;     // into data or an embedded array
     vk::ShaderModule shaderModule;
 
     const vk::Device& device;
@@ -5,17 +5,23 @@
 class Window
 {
 public:
-    Window();
+    Window(bool visible = true);
     ~Window();
     bool Resized() const noexcept;
     void Resized(bool) noexcept;
+    bool Damaged() const noexcept;
+    void Damaged(bool) noexcept;
+    bool Minimized() const noexcept;
     operator GLFWwindow*() const noexcept;
 private:
     void initGLFWhints() const noexcept;
     static void framebufferResizeCallback(GLFWwindow*, int width, int height) noexcept;
+    static void refreshCallback(GLFWwindow*) noexcept;
 
     GLFWwindow* pWnd;
     int width = 800;
     int height = 600; 
+    bool visible = true;
     bool _resized = false;
+    bool _damaged = false;  // contents have to be presented again, set on resize and when the system asks for a redraw
 };
\ No newline at end of file
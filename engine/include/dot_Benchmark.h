@@ -0,0 +1,130 @@
+#pragma once
+
+#include "dot_Device.h"
+#include "dot_Renderer.h"
+#include "dot_Model.h"
+#include "dot_Pipeline.h"
+#include "dot_PipelineLibrary.h"
+#include "dot_DrawQueue.h"
+#include "dot_RenderGraph.h"
+#include "dot_Image.h"
+#include "dot_Buffer.h"
+#include "dot_Bindless.h"
+
+#include "Window.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dot
+{
+    enum class BenchmarkScene
+    {
+        ManySmallModels,    // thousands of tiny vertex buffers, one draw each
+        LargeMesh,          // a single dense mesh
+        HeavyInstancing,    // a single model drawn with a large instance count
+        BufferChurn,        // models destroyed and recreated every frame
+        LiveResize,         // window resized every frame like a continuous drag
+        Overdraw,           // full screen layers at different depths, created back to front
+        SortedDraws,        // 100k draws of few meshes and pipelines issued in random order, sorted by state
+        RenderGraph,        // deferred style offscreen passes ahead of the scene, transient targets share memory
+        MaterialPermutations,   // draws over every combination of cull, winding, depth and blend state, one pipeline each without dynamic state
+        ShaderVariants,         // draws over specialization constant variants of one pair of shaders
+        MovingObjects,          // 100k objects of few meshes whose model matrices change every frame
+        BindlessMaterials       // draws over textured materials selected by bindless index, one pipeline and one set for all
+    };
+
+    enum class BenchmarkResult
+    {
+        Passed,
+        Regressed,
+        Skipped     // the device cannot render the scene or there is no baseline to compare against
+    };
+
+    struct BenchmarkConfig
+    {
+        BenchmarkScene scene = BenchmarkScene::ManySmallModels;
+        size_t warmupFrames = 60;
+        size_t frames = 600;
+        std::string resultsPath;    // metrics of this run are written here when not empty
+        std::string baselinePath;   // run fails if any metric exceeds the baseline by more than tolerance, skipped if there is no baseline
+        double tolerance = 0.1;
+        bool recordBaseline = false;    // metrics of this run are written to the baseline instead of compared against it
+        bool cacheCommands = false; // scene commands recorded once and reused until the scene changes
+        bool sortOpaque = true;     // models drawn front to back so the depth test rejects hidden fragments early
+        bool dynamicState = true;   // fixed function state set per draw where the device supports extended dynamic state
+        bool pipelineLibrary = true;    // variants linked from shared parts where the device supports graphics pipeline libraries
+        bool pushTransforms = false;    // a draw and a pushed matrix per object instead of instanced draws reading the object buffer
+    };
+
+    using BenchmarkMetrics = std::map<std::string, double>;
+
+    class Benchmark
+    {
+    public:
+        Benchmark(Window&, Device&, Renderer&);
+        Benchmark(const Benchmark&) = delete;
+        Benchmark(const Benchmark&&) = delete;
+        Benchmark& operator=(const Benchmark&) = delete;
+        Benchmark& operator=(const Benchmark&&) = delete;
+        BenchmarkResult run(const BenchmarkConfig&);
+        const BenchmarkMetrics& getMetrics() const noexcept;
+
+        static constexpr int skipExitCode = 77;     // exit code of a skipped run, registered with ctest as SKIP_RETURN_CODE
+
+        static BenchmarkScene parseScene(const std::string&);
+        static std::string sceneName(BenchmarkScene) noexcept;
+    private:
+        void loadScene(BenchmarkScene);
+        void loadMaterials();
+        vk::Pipeline getVariant(size_t variant);
+        void moveObjects(size_t frame) noexcept;
+        void loadBindlessMaterials(Bindless&, size_t textureCount, size_t materialCount);
+        void unloadBindlessMaterials() noexcept;
+        void updateScene(BenchmarkScene, size_t frame);
+        void renderScene(BenchmarkScene, const vk::CommandBuffer&) noexcept;
+        void sortModels() noexcept;
+        void buildGraph();
+        vk::QueryPool createStatisticsQueries(const BenchmarkConfig&) const;
+        void readStatisticsQueries(const vk::QueryPool&, size_t queryCount, double frameMsTotal);
+        BenchmarkResult compareBaseline(const BenchmarkConfig&) const;
+
+        static bool usesDrawQueue(BenchmarkScene) noexcept;
+        static std::vector<Model::Vertex> makeTriangle(float x, float y, float size, const glm::vec3& color, float depth = 0.5f) noexcept;
+        static BenchmarkMetrics readMetrics(const std::string& path);
+        static void writeMetrics(const std::string& path, const BenchmarkMetrics&);
+        static double hostMemoryPeakKb() noexcept;
+        static double hitchCount(const std::vector<double>& frameTimes, double median) noexcept;
+
+        Window& wnd;
+        Device& device;
+        Renderer& renderer;
+
+        std::vector<std::unique_ptr<Model>> models;
+        std::vector<std::unique_ptr<Pipeline>> pipelines;
+        std::vector<DrawState> materials;  // referenced by the scene draws, never resized once loaded
+        std::unique_ptr<PipelineLibrary> pLibrary;
+        std::vector<std::pair<DrawState, ShaderFeatures>> variants;     // requested from the library, indexed by drawVariants
+        std::vector<uint32_t> drawVariants;                             // per scene draw when the scene uses the library
+        uint32_t dynamicMask = 0;
+        bool usePipelineLibrary = false;
+        bool pushTransforms = false;
+        std::vector<glm::mat4> objectTransforms;                       // referenced by the scene draws when pushed, never resized once loaded
+        double transformMs = 0.0;
+        std::vector<std::unique_ptr<Image>> textures;
+        std::vector<vk::Sampler> samplers;
+        std::unique_ptr<Buffer> pMaterialBuffer;
+        std::vector<uint32_t> bindlessMaterials;                       // bindless index of every material's range of the material buffer
+        std::vector<std::pair<BindlessType, uint32_t>> bindlessIndices; // everything the scene registered, removed when it unloads
+        std::vector<std::pair<uint64_t, DrawQueue::Draw>> sceneDraws;  // submission order, pushed into the queue every frame
+        DrawQueue drawQueue;
+        dot::RenderGraph graph;
+        std::unique_ptr<Image> pGraphOutput;
+        uint32_t instanceCount = 1;
+        uint64_t sceneVersion = 0;
+        uint64_t sortedVersion = 0;
+        BenchmarkMetrics metrics;
+    };
+}
\ No newline at end of file
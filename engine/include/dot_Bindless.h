@@ -0,0 +1,81 @@
+#pragma once
+
+#include "dot_Device.h"
+#include "dot_Descriptors.h"
+#include "dot_Result.h"
+
+#include <array>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace dot
+{
+    // binding numbers of the arrays in the bindless set
+
+    enum class BindlessType : uint32_t
+    {
+        SampledImage,
+        Sampler,
+        StorageBuffer
+    };
+
+    struct BindlessStats
+    {
+        std::array<uint32_t, 3> registered = {};    // live indices per BindlessType
+        std::array<uint32_t, 3> capacity = {};
+        size_t writes = 0;
+        size_t pendingReleases = 0;                 // removed indices waiting for the frames that may still read them
+    };
+
+    // one global descriptor set holding every sampled image, sampler and storage buffer in large partially bound arrays.
+    // Resources are registered once and keep their index until removed, shaders pick them by an index from push
+    // constants or instance data; the set is bound once per pipeline change instead of per material, and written while
+    // bound since only unused indices ever change
+
+    class Bindless
+    {
+    public:
+        static constexpr uint32_t set = 1;  // set 0 holds the frame's transforms
+
+        Bindless(Device&, uint32_t maxImages = 1 << 16, uint32_t maxSamplers = 1 << 10, uint32_t maxBuffers = 1 << 16);
+        Bindless(const Bindless&) = delete;
+        Bindless(const Bindless&&) = delete;
+        Bindless& operator=(const Bindless&) = delete;
+        Bindless& operator=(const Bindless&&) = delete;
+        ~Bindless();
+        Result<uint32_t> addImage(const vk::ImageView&, vk::ImageLayout = vk::ImageLayout::eShaderReadOnlyOptimal) noexcept;
+        Result<uint32_t> addSampler(const vk::Sampler&) noexcept;
+        Result<uint32_t> addBuffer(const vk::Buffer&, vk::DeviceSize offset = 0, vk::DeviceSize range = VK_WHOLE_SIZE) noexcept;
+        void remove(BindlessType, uint32_t index) noexcept;     // the index is reused once the next frame submitted completed
+        void frameSubmitted(uint64_t timelineValue) noexcept;   // called by the renderer with the value of each frame it submits
+        void bind(const vk::CommandBuffer&, const vk::PipelineLayout&) const noexcept;
+        const vk::DescriptorSetLayout& getSetLayout() const noexcept;
+        const vk::DescriptorSet& getSet() const noexcept;
+        BindlessStats getStats() const noexcept;
+        uint64_t getRemovals() const noexcept;                  // changes with every remove, commands recorded before may read removed indices
+    private:
+        struct Slots
+        {
+            uint32_t capacity = 0;
+            uint32_t next = 0;                                  // indices below were handed out at least once
+            std::vector<uint32_t> free;
+            std::vector<std::pair<uint32_t, uint64_t>> released; // index and the timeline value it is free after
+        };
+
+        static constexpr uint64_t pendingFrame = ~0ULL;         // released during a frame that is not submitted yet
+
+        void createSet();
+        Result<uint32_t> acquire(BindlessType) noexcept;
+        void write(BindlessType, uint32_t index, const DescriptorInfo&) noexcept;
+
+        std::array<Slots, 3> slots;
+        vk::DescriptorSetLayout setLayout;  // owned by the layout cache
+        vk::DescriptorPool pool;
+        vk::DescriptorSet descriptorSet;
+        size_t writes = 0;
+        uint64_t removals = 0;
+
+        Device& device;
+    };
+}
\ No newline at end of file
@@ -19,13 +19,15 @@ namespace dot
         Buffer& operator=(Buffer&&) = delete;
         ~Buffer();
         operator const vk::Buffer&() const noexcept;
-        void map(const vk::DeviceSize& size = VK_WHOLE_SIZE, const vk::DeviceSize& offset = 0) noexcept;
+        Result<> map(const vk::DeviceSize& size = VK_WHOLE_SIZE, const vk::DeviceSize& offset = 0) noexcept;
         void unmap() noexcept;
-        void write(void* data, const vk::DeviceSize& size = VK_WHOLE_SIZE, const vk::DeviceSize& offset = 0) noexcept;
+        Result<> write(void* data, const vk::DeviceSize& size = VK_WHOLE_SIZE, const vk::DeviceSize& offset = 0) noexcept;
         const vk::Buffer& getVkBuffer() const noexcept;
     private:
         void createBuffer(const vk::BufferUsageFlags&, const vk::MemoryPropertyFlags&);
         void destroyBuffer() noexcept;
+
+        vk::DeviceSize allocationSize = 0;
     public:
         vk::Buffer buffer;
         vk::DeviceMemory memory;
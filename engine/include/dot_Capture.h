@@ -0,0 +1,79 @@
+#pragma once
+
+#include "dot_Model.h"
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace dot
+{
+    // binary layout: header {magic, version}, then records of {uint8 op, op specific payload}
+    // fields are written in host byte order, the magic doubles as an endianness check
+
+    enum class CaptureOp : uint8_t
+    {
+        FrameBegin = 1,     // double deltaTime
+        FrameEnd,           // -
+        ModelCreate,        // uint32 modelId, uint32 vertexCount, Vertex[vertexCount]
+        ModelWrite,         // uint32 modelId, uint32 vertexCount, Vertex[vertexCount]
+        PipelineBind,       // uint32 pipelineId
+        Draw,               // uint32 modelId, uint32 instanceCount
+        Resize              // int32 width, int32 height
+    };
+
+    struct CaptureRecord
+    {
+        CaptureOp op;
+        uint32_t id = 0;
+        uint32_t count = 0;
+        int32_t width = 0;
+        int32_t height = 0;
+        double deltaTime = 0.0;
+        std::vector<Model::Vertex> verticies;
+    };
+
+    class CaptureWriter
+    {
+    public:
+        CaptureWriter(const std::string& path);
+        CaptureWriter(const CaptureWriter&) = delete;
+        CaptureWriter(const CaptureWriter&&) = delete;
+        CaptureWriter& operator=(const CaptureWriter&) = delete;
+        CaptureWriter& operator=(const CaptureWriter&&) = delete;
+        void frameBegin(double deltaTime);
+        void frameEnd();
+        void modelCreate(uint32_t modelId, const std::vector<Model::Vertex>&);
+        void modelWrite(uint32_t modelId, const std::vector<Model::Vertex>&);
+        void pipelineBind(uint32_t pipelineId);
+        void draw(uint32_t modelId, uint32_t instanceCount);
+        void resize(int32_t width, int32_t height);
+    private:
+        template<typename T>
+        void put(const T&);
+        void putVerticies(const std::vector<Model::Vertex>&);
+
+        std::ofstream file;
+    };
+
+    class CaptureReader
+    {
+    public:
+        CaptureReader(const std::string& path);
+        CaptureReader(const CaptureReader&) = delete;
+        CaptureReader(const CaptureReader&&) = delete;
+        CaptureReader& operator=(const CaptureReader&) = delete;
+        CaptureReader& operator=(const CaptureReader&&) = delete;
+        bool next(CaptureRecord&);
+    private:
+        template<typename T>
+        T get();
+        void getVerticies(CaptureRecord&);
+
+        std::ifstream file;
+    };
+
+    inline constexpr uint32_t captureMagic = 0x43544F44; // "DOTC"
+    inline constexpr uint32_t captureVersion = 2;
+}
\ No newline at end of file
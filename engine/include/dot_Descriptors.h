@@ -0,0 +1,109 @@
+#pragma once
+
+#include "dot_Device.h"
+#include "dot_Result.h"
+
+#include <memory>
+#include <span>
+#include <unordered_map>
+#include <vector>
+
+namespace dot
+{
+    // one descriptor as update templates read it, zeroed first so the cache never keys on padding
+
+    union DescriptorInfo
+    {
+        uint64_t words[3] = {};
+        VkDescriptorImageInfo image;
+        VkDescriptorBufferInfo buffer;
+        VkBufferView texelBuffer;
+
+        static DescriptorInfo fromImage(const vk::Sampler&, const vk::ImageView&, vk::ImageLayout) noexcept;
+        static DescriptorInfo fromBuffer(const vk::Buffer&, vk::DeviceSize offset = 0, vk::DeviceSize range = VK_WHOLE_SIZE) noexcept;
+        static DescriptorInfo fromTexelBuffer(const vk::BufferView&) noexcept;
+    };
+
+    // a set layout and the template writing every descriptor of a set in one call, it reads descriptorCount infos:
+    // the bindings in ascending order, one info per array element
+
+    struct DescriptorLayout
+    {
+        vk::DescriptorSetLayout setLayout;
+        vk::DescriptorUpdateTemplate updateTemplate;
+        uint32_t descriptorCount = 0;
+    };
+
+    // sets from a growing list of pools, pools are added when the current ones run out and kept when reset
+
+    class DescriptorAllocator
+    {
+    public:
+        DescriptorAllocator(const vk::Device&, uint32_t setsPerPool = 64);
+        DescriptorAllocator(const DescriptorAllocator&) = delete;
+        DescriptorAllocator(const DescriptorAllocator&&) = delete;
+        DescriptorAllocator& operator=(const DescriptorAllocator&) = delete;
+        DescriptorAllocator& operator=(const DescriptorAllocator&&) = delete;
+        ~DescriptorAllocator();
+        Result<vk::DescriptorSet> allocate(const vk::DescriptorSetLayout&) noexcept;
+        void reset() noexcept;          // frees every set, the gpu must be done with them
+        size_t getPoolCount() const noexcept;
+    private:
+        Result<vk::DescriptorPool> createPool() noexcept;
+
+        std::vector<vk::DescriptorPool> pools;
+        size_t current = 0;             // pools before it are full
+        uint32_t setsPerPool;           // doubles with every new pool up to maxSetsPerPool
+
+        static constexpr uint32_t maxSetsPerPool = 4096;
+
+        const vk::Device& device;
+    };
+
+    struct DescriptorStats
+    {
+        size_t frameSets = 0;       // transient sets allocated since the last reset of their frame
+        size_t cachedSets = 0;
+        size_t cacheHits = 0;
+        size_t updates = 0;         // template updates, one per set written
+        size_t pools = 0;
+    };
+
+    // descriptor sets for the renderer: transient ones allocated per frame in flight and reset when the frame slot is
+    // reused, and long lived ones cached by layout and contents. Transient sets must not be used by commands that are
+    // reused across frames; used from the render thread only
+
+    class Descriptors
+    {
+    public:
+        Descriptors(Device&, size_t framesInFlight);
+        Descriptors(const Descriptors&) = delete;
+        Descriptors(const Descriptors&&) = delete;
+        Descriptors& operator=(const Descriptors&) = delete;
+        Descriptors& operator=(const Descriptors&&) = delete;
+        ~Descriptors();
+        const DescriptorLayout& getLayout(std::span<const vk::DescriptorSetLayoutBinding>);
+        void beginFrame(size_t frameInFlight) noexcept;
+        Result<vk::DescriptorSet> allocateFrame(const DescriptorLayout&, std::span<const DescriptorInfo>) noexcept;
+        Result<vk::DescriptorSet> getCached(const DescriptorLayout&, std::span<const DescriptorInfo>) noexcept;
+        Result<> update(const vk::DescriptorSet&, const DescriptorLayout&, std::span<const DescriptorInfo>) noexcept;
+        void clearCache();              // cached sets are retired once frames in flight are done with them
+        DescriptorStats getStats() const noexcept;
+    private:
+        using Key = std::vector<uint64_t>;
+
+        struct KeyHash
+        {
+            size_t operator()(const Key&) const noexcept;
+        };
+
+        std::unordered_map<VkDescriptorSetLayout, DescriptorLayout> layouts;
+        std::vector<std::unique_ptr<DescriptorAllocator>> frameAllocators;
+        std::unique_ptr<DescriptorAllocator> cacheAllocator;
+        std::unordered_map<Key, vk::DescriptorSet, KeyHash> cachedSets;
+        size_t currentFrame = 0;
+        DescriptorStats stats;
+
+        Device& device;
+    };
+}
\ No newline at end of file
@@ -2,10 +2,19 @@
 
 #include "dot_Vulkan.h"
 #include "dot_Instance.h"
+#include "dot_Result.h"
+#include "dot_DynamicState.h"
+#include "dot_LayoutCache.h"
 
 #include "Window.h"
 
 #include <optional>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
 
 namespace dot
 {
@@ -39,9 +48,22 @@ namespace dot
         Device& operator=(const Device&&) = delete;
         ~Device();
         operator const vk::Device&() const noexcept;
-        vk::CommandBuffer beginTransferCmd() const noexcept;
-        void endTransferCmd(const vk::CommandBuffer&) const noexcept;
-        void copyBuffer(const vk::Buffer& src, const vk::Buffer& dst, const vk::DeviceSize& size) const noexcept;
+        Result<vk::CommandBuffer> beginTransferCmd() const noexcept;
+        Result<> endTransferCmd(const vk::CommandBuffer&) const noexcept;
+        Result<> copyBuffer(const vk::Buffer& src, const vk::Buffer& dst, const vk::DeviceSize& size) const noexcept;
+        Result<> copyBufferToImage(const vk::Buffer& src, const vk::Image& dst, const vk::Extent2D&) const noexcept;  // leaves the image shader read only
+        Result<uint64_t> submitGfx
+        (
+            const vk::CommandBuffer&,
+            std::span<const VkSemaphore> waitSemaphores = {}, std::span<const VkPipelineStageFlags> waitStages = {},
+            std::span<const VkSemaphore> signalSemaphores = {}
+        ) const noexcept;   // a null command buffer submits only the semaphore operations
+        Result<> waitTimeline(uint64_t value) const noexcept;
+        uint64_t getCompletedTimelineValue() const noexcept;
+        uint64_t getSubmittedTimelineValue() const noexcept;
+        void destroyAfterUse(std::function<void()> destroy);
+        void retire(const std::function<void()>& destroy) noexcept;    // destroyAfterUse, waiting for the device when deferring fails
+        void collectGarbage(bool all = false) noexcept;
         const SwapchainSupportDetails& getSwapchainDetails() const noexcept;
         const vk::SurfaceKHR& getSurface() const noexcept;
         const QueueFamilyIndices& getQueueFamiliyIndices() const noexcept;
@@ -49,7 +71,28 @@ namespace dot
         const vk::Queue& getGfxQueue() const noexcept;
         const vk::Queue& getPresentQueue() const noexcept;
         const vk::CommandPool& getCmdPoolGfx() const noexcept;
+        const vk::PipelineCache& getPipelineCache() const noexcept;
+        LayoutCache& getLayoutCache() const noexcept;
         uint32_t getMemoryType(uint32_t typeFilter, const vk::MemoryPropertyFlags& properties) const;
+        bool hasMemoryType(uint32_t typeFilter, const vk::MemoryPropertyFlags& properties) const noexcept;
+        vk::Format findSupportedFormat(const std::vector<vk::Format>& candidates, vk::ImageTiling, const vk::FormatFeatureFlags&) const;
+        vk::Format getDepthFormat() const;
+        vk::SampleCountFlagBits getSampleCount(uint32_t requested) const noexcept;
+        vk::PhysicalDeviceLimits getLimits() const noexcept;
+        vk::PhysicalDeviceVulkan12Properties getProperties12() const noexcept;
+        const vk::PhysicalDeviceFeatures& getEnabledFeatures() const noexcept;
+        const vk::PhysicalDeviceVulkan12Features& getEnabledFeatures12() const noexcept;
+        bool dynamicRenderingEnabled() const noexcept;
+        void cmdBeginRendering(const vk::CommandBuffer&, const vk::RenderingInfoKHR&) const noexcept;
+        void cmdEndRendering(const vk::CommandBuffer&) const noexcept;
+        const DynamicStateCommands& getDynamicStateCommands() const noexcept;
+        bool pipelineLibraryEnabled() const noexcept;
+        bool descriptorIndexingEnabled() const noexcept;
+        void memoryAllocated(const vk::DeviceSize&) noexcept;
+        void memoryFreed(const vk::DeviceSize&) noexcept;
+        vk::DeviceSize getAllocatedMemory() const noexcept;
+        vk::DeviceSize getPeakAllocatedMemory() const noexcept;
+        void resetPeakAllocatedMemory() noexcept;
     private:
         void createSurface();
 
@@ -57,20 +100,56 @@ namespace dot
         bool deviceSupported(const vk::PhysicalDevice&);
         void setQueueFamilies(const vk::PhysicalDevice&) noexcept;
         bool deviceExtensionsSupported(const vk::PhysicalDevice&) const;
+        bool deviceExtensionSupported(const char* name) const;
         void setSwapchainDetails(const vk::PhysicalDevice&) noexcept;
 
         void createLogicalDevice();
+        void loadExtensionFunctions() noexcept;
 
         void createCmdPoolGfx();
         void createCmdPoolTransfer();
+        void createPipelineCache();
+        void createTimeline();
 
         vk::SurfaceKHR surface;
         vk::PhysicalDevice physicalDevice;
+        vk::PhysicalDeviceFeatures enabledFeatures;
+        vk::PhysicalDeviceVulkan12Features enabledFeatures12;
+        vk::PhysicalDeviceDynamicRenderingFeaturesKHR enabledDynamicRendering;
+        vk::PhysicalDeviceExtendedDynamicStateFeaturesEXT enabledDynamicState;
+        vk::PhysicalDeviceExtendedDynamicState2FeaturesEXT enabledDynamicState2;
+        vk::PhysicalDeviceExtendedDynamicState3FeaturesEXT enabledDynamicState3;
+        vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT enabledPipelineLibrary;
+        std::vector<const char*> enabledExtensions;
         vk::Device device;
         vk::Queue graphicQueue;
         vk::Queue presentQueue;
         vk::CommandPool cmdPoolGfx;
         vk::CommandPool cmdPoolTransfer;
+        vk::PipelineCache pipelineCache;
+        std::unique_ptr<LayoutCache> layoutCache;
+
+        // extension commands are not exported by the loader, they are fetched from the device
+        PFN_vkCmdBeginRenderingKHR pfnCmdBeginRendering = nullptr;
+        PFN_vkCmdEndRenderingKHR pfnCmdEndRendering = nullptr;
+        DynamicStateCommands dynamicStateCommands;
+
+        // every submission to the graphics queue signals the next value, resources retire against the last submitted one
+        vk::Semaphore timeline;
+        mutable std::atomic<uint64_t> submittedValue = 0;
+        mutable std::mutex gfxQueueMutex;
+
+        struct Garbage
+        {
+            uint64_t timelineValue;
+            std::function<void()> destroy;
+        };
+
+        std::mutex garbageMutex;
+        std::vector<Garbage> garbage;
+
+        std::atomic<vk::DeviceSize> allocatedMemory = 0;
+        std::atomic<vk::DeviceSize> peakAllocatedMemory = 0;
 
         const std::vector<const char*> deviceExtensions =
         {
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "dot_Model.h"
+#include "dot_DynamicState.h"
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <stop_token>
+#include <thread>
+#include <vector>
+
+namespace dot
+{
+    // counts of one recorded queue, the unsorted counts are what recording in submission order would have bound
+
+    struct DrawQueueStats
+    {
+        size_t draws = 0;
+        size_t pipelineBinds = 0;
+        size_t vertexBufferBinds = 0;
+        size_t descriptorBinds = 0;
+        size_t stateSets = 0;           // draws that set extended dynamic state, not counted as binds
+        size_t transformPushes = 0;     // push constant updates for per draw transforms and object indices
+        size_t materialPushes = 0;      // bindless material indices pushed without a transform
+        size_t unsortedBinds = 0;
+        double sortMs = 0.0;
+
+        size_t binds() const noexcept { return pipelineBinds + vertexBufferBinds + descriptorBinds; }
+    };
+
+    class DrawQueue
+    {
+    public:
+        static constexpr uint32_t noIndex = ~0U;
+
+        struct Draw
+        {
+            const Model* pModel;
+            uint32_t instanceCount = 1;
+            vk::Pipeline pipeline;                  // null keeps the pipeline bound by the renderer
+            vk::PipelineLayout layout;              // layout the descriptor set and transforms are bound with
+            vk::DescriptorSet descriptorSet;        // material set, bound at set 1 after the transforms; null when the draw reads none
+            uint32_t dynamicMask = 0;               // DynamicStateBits the pipeline leaves to the draw
+            const DrawState* pState = nullptr;      // values of the dynamic states, shared by draws of one material
+            const glm::mat4* pTransform = nullptr;  // model matrix pushed before the draw, null keeps the pushed one
+            uint32_t objectIndex = noIndex;         // first object buffer entry of the draw's instances, pushed when set
+            uint32_t materialIndex = noIndex;       // bindless index of the draw's material, pushed when set
+        };
+
+        // bits from the most significant: pass 4, pipeline 10, material 14, mesh 20, depth 16
+
+        static uint64_t makeKey(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, float depth) noexcept;
+
+        DrawQueue(size_t workerCount = 0);
+        DrawQueue(const DrawQueue&) = delete;
+        DrawQueue(const DrawQueue&&) = delete;
+        DrawQueue& operator=(const DrawQueue&) = delete;
+        DrawQueue& operator=(const DrawQueue&&) = delete;
+        ~DrawQueue();
+        void clear() noexcept;
+        void reserve(size_t drawCount);
+        void push(uint64_t key, const Draw&);
+        void sort();
+        void record(const vk::CommandBuffer&, const DynamicStateCommands* = nullptr) noexcept;
+        const DrawQueueStats& getStats() const noexcept;
+        const Draw& getDraw(size_t position) const noexcept;    // in recording order once sorted
+        size_t size() const noexcept;
+    private:
+        struct Entry
+        {
+            uint64_t key;
+            uint32_t draw;  // index into draws
+        };
+
+        void radixSort();
+        void runWorkers(const std::function<void(size_t)>& job);   // job(thread) on every worker, job(0) on the caller
+        void work(std::stop_token, size_t thread);
+        size_t countUnsortedBinds() const noexcept;
+
+        // below this many draws the threads cost more than they save
+
+        static constexpr size_t parallelThreshold = 16384;
+
+        std::vector<Draw> draws;
+        std::vector<Entry> entries;
+        std::vector<Entry> scratch;
+        size_t workerCount;
+        DrawQueueStats stats;
+
+        // started by the first parallel sort and kept, a sort only wakes them
+
+        std::mutex workMutex;
+        std::condition_variable_any workReady;
+        std::condition_variable workDone;
+        const std::function<void(size_t)>* pJob = nullptr;
+        uint64_t jobGeneration = 0;     // bumped per job, a worker runs every generation once
+        size_t busyWorkers = 0;
+        std::vector<std::jthread> workers;  // threads 1 to workerCount - 1, the sorting thread is thread 0
+    };
+}
\ No newline at end of file
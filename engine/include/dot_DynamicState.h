@@ -0,0 +1,57 @@
+#pragma once
+
+#include "dot_Vulkan.h"
+
+#include <cstdint>
+
+namespace dot
+{
+    enum DynamicStateBits : uint32_t
+    {
+        DynamicCullMode     = 1 << 0,   // extended dynamic state
+        DynamicFrontFace    = 1 << 1,
+        DynamicTopology     = 1 << 2,   // within the topology class the pipeline was built with
+        DynamicDepth        = 1 << 3,   // test, write and compare op
+        DynamicDepthBias    = 1 << 4,   // extended dynamic state 2
+        DynamicBlend        = 1 << 5,   // extended dynamic state 3, enable and equation
+        DynamicAll          = (1 << 6) - 1
+    };
+
+    // fixed function values of a draw, baked into its pipeline or set per draw when the pipeline has them dynamic
+
+    struct DrawState
+    {
+        vk::CullModeFlagBits cullMode = vk::CullModeFlagBits::eBack;
+        vk::FrontFace frontFace = vk::FrontFace::eClockwise;
+        vk::PrimitiveTopology topology = vk::PrimitiveTopology::eTriangleList;
+        bool depthTest = true;
+        bool depthWrite = true;
+        vk::CompareOp depthCompare = vk::CompareOp::eLess;
+        bool depthBias = false;
+        bool blend = false;         // source alpha over one minus source alpha
+
+        uint64_t key(uint32_t dynamicMask = 0) const noexcept;  // packs the values a pipeline with the mask bakes in
+
+        static constexpr float depthBiasConstant = 1.0f;        // factors of an enabled depth bias
+        static constexpr float depthBiasSlope = 1.0f;
+    };
+
+    // extension commands fetched by the device, empty when no extended dynamic state is available
+
+    struct DynamicStateCommands
+    {
+        uint32_t supported = 0;     // DynamicStateBits the device can set
+
+        PFN_vkCmdSetCullModeEXT cmdSetCullMode = nullptr;
+        PFN_vkCmdSetFrontFaceEXT cmdSetFrontFace = nullptr;
+        PFN_vkCmdSetPrimitiveTopologyEXT cmdSetPrimitiveTopology = nullptr;
+        PFN_vkCmdSetDepthTestEnableEXT cmdSetDepthTestEnable = nullptr;
+        PFN_vkCmdSetDepthWriteEnableEXT cmdSetDepthWriteEnable = nullptr;
+        PFN_vkCmdSetDepthCompareOpEXT cmdSetDepthCompareOp = nullptr;
+        PFN_vkCmdSetDepthBiasEnableEXT cmdSetDepthBiasEnable = nullptr;
+        PFN_vkCmdSetColorBlendEnableEXT cmdSetColorBlendEnable = nullptr;
+        PFN_vkCmdSetColorBlendEquationEXT cmdSetColorBlendEquation = nullptr;
+
+        void set(const vk::CommandBuffer&, uint32_t mask, const DrawState&) const noexcept;
+    };
+}
\ No newline at end of file
@@ -0,0 +1,13 @@
+#pragma once
+
+#include <cstdint>
+#include <span>
+#include <string_view>
+
+namespace dot
+{
+    // spir-v compiled, optimized and validated by the build, looked up by the file name the build gives it
+    // ("vert.spv" for shader.vert, "tonemap_frag.spv" for tonemap.frag); empty when the name is unknown
+
+    std::span<const uint32_t> findEmbeddedShader(std::string_view name) noexcept;
+}
\ No newline at end of file
@@ -3,27 +3,76 @@
 #include "dot_Device.h"
 #include "dot_Renderer.h"
 #include "dot_Model.h"
+#include "dot_DrawQueue.h"
+#include "dot_Benchmark.h"
+#include "dot_Microbench.h"
+#include "dot_Capture.h"
+#include "dot_Replay.h"
 
 #include "Window.h"
 
+#include <atomic>
+#include <chrono>
 #include <memory>
+#include <string>
+#include <vector>
 
 namespace dot
 {
+    enum class RenderMode
+    {
+        Continuous, // a frame every iteration
+        OnDemand    // frames only after something changed, the loop sleeps in between
+    };
+
+    enum DirtyFlags : uint32_t
+    {
+        DirtyScene  = 1 << 0,
+        DirtyCamera = 1 << 1,
+        DirtyResize = 1 << 2,
+        DirtyAll    = DirtyScene | DirtyCamera | DirtyResize
+    };
+
     class Engine
     {
     public:
-        Engine(Window&);
+        Engine(Window&, const std::string& capturePath = {}, const RendererConfig& = {});
         void run();
+        void setRenderMode(RenderMode) noexcept;
+        void setCommandCaching(bool) noexcept;
+        Result<> setSampleCount(uint32_t) noexcept;
+        void invalidate(uint32_t dirtyFlags = DirtyAll) noexcept;
+        double idleCpuUsage(double seconds);
+        BenchmarkResult benchmark(const BenchmarkConfig&);
+        void microbench(size_t iterations);
+        void replay(const ReplayConfig&);
     private:
         void loadModels();
-        void updateFrame();
+        void tick();
+        void updateFrame(double deltaTime);
         void renderFrame();
+        void captureResize();
+
+        uint32_t createModel(const std::vector<Model::Vertex>&);
+        void writeModel(uint32_t id, const std::vector<Model::Vertex>&);
+        void drawModel(uint32_t id, uint32_t instanceCount = 1);
 
         Window& wnd;
         Device device;
         Renderer renderer;
 
-        std::unique_ptr<Model> triangle;
+        std::unique_ptr<CaptureWriter> pCapture = nullptr;  // records engine level commands when a capture path is given
+        int capturedWidth = 0;
+        int capturedHeight = 0;
+
+        RenderMode renderMode = RenderMode::Continuous;
+        std::atomic<uint32_t> dirty = DirtyAll;
+        std::chrono::steady_clock::time_point lastFrame = std::chrono::steady_clock::now();
+        bool firstFrame = true;
+
+        std::vector<std::unique_ptr<Model>> models;
+        uint64_t drawListVersion = 0;   // bumped by every model change, keys the renderer's recorded scene commands
+        DrawQueue drawQueue;            // draws of the current frame, sorted by state before recording
+        uint32_t triangle;
     };
 }
\ No newline at end of file
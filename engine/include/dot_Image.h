@@ -0,0 +1,39 @@
+#pragma once
+
+#include "dot_Device.h"
+
+namespace dot
+{
+    class Image
+    {
+    public:
+        Image
+        (
+            Device&,
+            const vk::Extent2D&, const vk::Format&,
+            const vk::ImageUsageFlags& usage, const vk::MemoryPropertyFlags& memoryProperty,
+            const vk::ImageAspectFlags& aspect, vk::SampleCountFlagBits samples = vk::SampleCountFlagBits::e1
+        );
+        Image(Image&) = delete;
+        Image(Image&&) = delete;
+        Image& operator=(Image&) = delete;
+        Image& operator=(Image&&) = delete;
+        ~Image();
+        operator const vk::Image&() const noexcept;
+        const vk::ImageView& getView() const noexcept;
+        const vk::Format& getFormat() const noexcept;
+    private:
+        void createImage(const vk::ImageUsageFlags&, const vk::MemoryPropertyFlags&, vk::SampleCountFlagBits);
+        void createView(const vk::ImageAspectFlags&);
+        void destroyImage() noexcept;
+
+        vk::Image image;
+        vk::DeviceMemory memory;
+        vk::ImageView view;
+        vk::Extent2D extent;
+        vk::Format format;
+        vk::DeviceSize allocationSize = 0;
+
+        Device& device;
+    };
+}
\ No newline at end of file
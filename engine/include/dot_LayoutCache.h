@@ -0,0 +1,56 @@
+#pragma once
+
+#include "dot_Vulkan.h"
+#include "dot_ShaderReflection.h"
+
+#include <mutex>
+#include <span>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace dot
+{
+    struct LayoutCacheStats
+    {
+        size_t setLayouts = 0;
+        size_t pipelineLayouts = 0;
+        size_t hits = 0;            // requests served by an existing layout
+    };
+
+    // descriptor set and pipeline layouts keyed by a hash of their description, identical layouts are created once and
+    // shared; the cache owns every layout it returns, they live until the device is destroyed
+
+    class LayoutCache
+    {
+    public:
+        LayoutCache(const vk::Device&);
+        LayoutCache(const LayoutCache&) = delete;
+        LayoutCache(const LayoutCache&&) = delete;
+        LayoutCache& operator=(const LayoutCache&) = delete;
+        LayoutCache& operator=(const LayoutCache&&) = delete;
+        ~LayoutCache();
+        vk::DescriptorSetLayout getSetLayout
+        (
+            std::span<const vk::DescriptorSetLayoutBinding>, vk::DescriptorSetLayoutCreateFlags = {},
+            std::span<const vk::DescriptorBindingFlags> bindingFlags = {}  // per binding in the given order, empty for none
+        );
+        vk::PipelineLayout getPipelineLayout(const vk::PipelineLayoutCreateInfo&);
+        vk::PipelineLayout getPipelineLayout(const ShaderLayout&, std::span<const std::pair<uint32_t, vk::DescriptorSetLayout>> fixedSets = {});
+        LayoutCacheStats getStats() const noexcept;
+    private:
+        using Key = std::vector<uint32_t>;
+
+        struct KeyHash
+        {
+            size_t operator()(const Key&) const noexcept;
+        };
+
+        std::unordered_map<Key, vk::DescriptorSetLayout, KeyHash> setLayouts;
+        std::unordered_map<Key, vk::PipelineLayout, KeyHash> pipelineLayouts;
+        LayoutCacheStats stats;
+        mutable std::mutex mutex;   // pipelines are also created from background threads
+
+        const vk::Device& device;
+    };
+}
\ No newline at end of file
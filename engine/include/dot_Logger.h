@@ -0,0 +1,115 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace dot
+{
+    enum class LogSeverity : uint32_t
+    {
+        Verbose = 1 << 0,
+        Info    = 1 << 1,
+        Warning = 1 << 2,
+        Error   = 1 << 3
+    };
+
+    enum class LogCategory : uint32_t
+    {
+        General     = 1 << 0,
+        Validation  = 1 << 1,
+        Performance = 1 << 2,
+        Engine      = 1 << 3
+    };
+
+    struct LoggerConfig
+    {
+        uint32_t severities = uint32_t(LogSeverity::Warning) | uint32_t(LogSeverity::Error);
+        uint32_t categories = ~0U;
+        std::string crashDumpPath;  // binary dump of the newest entries written when the process crashes, disabled when empty
+    };
+
+    // producers push fixed size entries into their own lock free queue, a background thread formats and writes them in batches
+
+    class Logger
+    {
+    public:
+        static Logger& get();
+        Logger(const Logger&) = delete;
+        Logger(const Logger&&) = delete;
+        Logger& operator=(const Logger&) = delete;
+        Logger& operator=(const Logger&&) = delete;
+        void configure(const LoggerConfig&);
+        const LoggerConfig& getConfig() const noexcept;
+        bool enabled(LogSeverity, LogCategory) const noexcept;
+        void log(LogSeverity, LogCategory, int32_t messageId, const char* message) noexcept;
+        void flush();
+        void dumpCrashBuffer(std::ostream&) const;
+    private:
+        struct Entry
+        {
+            uint64_t timeUs;
+            LogSeverity severity;
+            LogCategory category;
+            int32_t messageId;
+            uint32_t length;
+            char message[488];
+        };
+
+        class Queue
+        {
+        public:
+            bool push(const Entry&) noexcept;
+            bool pop(Entry&) noexcept;
+            const Entry* pending(size_t index) const noexcept;   // entries not consumed yet, for the crash dump
+        private:
+            static constexpr size_t capacity = 512;
+
+            std::array<Entry, capacity> entries;
+            std::atomic<size_t> head = 0;   // consumed by the flusher thread
+            std::atomic<size_t> tail = 0;   // produced by the owning thread
+        };
+
+        Logger();
+        ~Logger();
+        Queue* localQueue() noexcept;
+        void flushLoop();
+        void drain();
+        void write(const Entry&, std::string& out);
+        void writeRepeats(std::string& out);
+        static void format(const Entry&, std::string& out);
+        static void crashHandler(int signal);
+
+        LoggerConfig config;
+        std::atomic<uint32_t> severities;
+        std::atomic<uint32_t> categories;
+        std::atomic<uint64_t> dropped = 0;
+
+        mutable std::mutex queuesMutex;
+        std::vector<std::unique_ptr<Queue>> queues;
+
+        std::mutex flushMutex;
+        std::condition_variable flushCondition;
+        std::atomic<bool> pending = false;              // entries logged since the flusher last woke
+        std::unordered_map<int32_t, uint64_t> repeats;  // validation message id -> occurrences not printed yet
+        std::unordered_map<int32_t, uint64_t> seen;
+
+        static constexpr size_t crashBufferSize = 1024;
+        std::array<Entry, crashBufferSize> crashBuffer;
+        std::atomic<size_t> crashBufferNext = 0;
+        char crashDumpPath[256] = {};
+
+        bool running = true;
+        std::thread flusher;
+    };
+}
+
+#define DOT_LOG(severity, category, message) dot::Logger::get().log(dot::LogSeverity::severity, dot::LogCategory::category, 0, message);
\ No newline at end of file
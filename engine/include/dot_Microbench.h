@@ -0,0 +1,49 @@
+#pragma once
+
+#include "dot_Device.h"
+#include "dot_Renderer.h"
+#include "dot_Stats.h"
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace dot
+{
+    struct MicrobenchResult
+    {
+        std::string name;
+        Statistics stats;           // milliseconds per iteration
+        vk::DeviceSize bytes = 0;   // bytes moved per iteration, reported as bandwidth when not zero
+    };
+
+    class Microbench
+    {
+    public:
+        Microbench(Device&, Renderer&, size_t iterations = 100);
+        Microbench(const Microbench&) = delete;
+        Microbench(const Microbench&&) = delete;
+        Microbench& operator=(const Microbench&) = delete;
+        Microbench& operator=(const Microbench&&) = delete;
+        const std::vector<MicrobenchResult>& run();
+        void report(std::ostream&) const;
+    private:
+        void measure(const std::string& name, const std::function<void()>&, vk::DeviceSize bytes = 0);
+
+        void benchBufferCreateDestroy();
+        void benchBufferWrite();
+        void benchCopyBuffer();
+        void benchShaderModule();
+        void benchPipeline();
+        void benchCmdBufferAlloc();
+        void benchDescriptors();
+
+        Device& device;
+        Renderer& renderer;
+        size_t iterations;
+        size_t warmupIterations;
+
+        std::vector<MicrobenchResult> results;
+    };
+}
\ No newline at end of file
@@ -15,19 +15,22 @@ namespace dot
     public:
         struct Vertex
         {
-            glm::vec2 pos;
+            glm::vec3 pos;  // z is the depth in [0, 1], smaller is closer
             glm::vec3 color;
 
             static std::vector<vk::VertexInputBindingDescription> getBindingDescription() noexcept;
             static std::vector<vk::VertexInputAttributeDescription> getAttributeDescription() noexcept;
         };
         Model(Device&, const std::vector<Vertex>&);
+        void write(const std::vector<Vertex>&);
         void bind(const vk::CommandBuffer&) const noexcept;
-        void draw(const vk::CommandBuffer&) const noexcept;
+        void draw(const vk::CommandBuffer&, uint32_t instanceCount = 1) const noexcept;
+        float getDepth() const noexcept;
     private:
-        void createVertexBuffer(const std::vector<Vertex>&) noexcept;
+        void createVertexBuffer(const std::vector<Vertex>&);
         std::unique_ptr<Buffer> vertexBuffer;
         uint32_t vertexCount;
+        float depth = 0.0f;    // mean vertex depth, sort key for opaque draws
 
         Device& device;
     };
@@ -5,11 +5,29 @@
 
 #include "Shader.h"
 
-#include <vector>
+#include <span>
 #include <string>
+#include <utility>
+#include <vector>
 
 namespace dot
 {
+    // toggles and constants the scene shaders are specialized with, in constant_id order
+
+    struct ShaderFeatures
+    {
+        bool vertexColor = true;    // white when off
+        bool instancing = false;    // instances spread on a grid by their index
+        bool alphaTest = false;     // fragments with a luminance below alphaCutoff are discarded
+        uint32_t lightCount = 0;    // procedural point lights, the loop is unrolled for the count, clamped to maxLightCount
+        float alphaCutoff = 0.5f;
+        bool objectBuffer = false;  // model matrices read from the frame's object buffer instead of push constants
+
+        uint64_t key() const noexcept;
+
+        static constexpr uint32_t maxLightCount = 0xFF; // what fits the key
+    };
+
     struct PipelineConfig
     {
         PipelineConfig() = default;
@@ -31,26 +49,64 @@ namespace dot
         vk::PipelineColorBlendStateCreateInfo colorBlendStateInfo;              // sets blend constants
         std::vector<vk::DynamicState> dynamicStates;                            // determines which states of pipeline can be dynamically changed
         vk::PipelineDynamicStateCreateInfo dynamicStateInfo;                    // allows some changes to pipeline without need to rebuild               
+        ShaderFeatures features;                                                // shader variant, constants are folded in when the pipeline compiles
+        std::vector<vk::SpecializationMapEntry> specializationEntries;          // constant_id to offset in the data, one 4 byte value per feature
+        std::vector<uint32_t> specializationData;
+        vk::SpecializationInfo specializationInfo;                              // references entries and data, shared by both shader stages
+        uint32_t dynamicMask = 0;                                               // DynamicStateBits set per draw with extended dynamic state instead of baked in
+        std::vector<vk::DescriptorSetLayout> setLayouts;                        // descriptor sets the shaders read, referenced by the layout info
+        std::vector<vk::PushConstantRange> pushConstantRanges;                  // small per draw values recorded straight into the command buffer
         vk::PipelineLayoutCreateInfo layoutInfo;                                // information about push-constants and descriptors (ways to provide data to shaders)
+        bool reflectLayout = false;                                             // derive the layout from the shaders' spir-v instead of the layout info
+        std::vector<std::pair<uint32_t, uint32_t>> dynamicBuffers;              // set and binding of buffers bound with dynamic offsets, reflection cannot tell
+        std::vector<std::pair<uint32_t, vk::DescriptorSetLayout>> fixedSetLayouts;  // sets shared with other pipelines whose layout is given instead of reflected
         vk::RenderPass renderPass;                                              // in order to render, a render pass must be started. A Renderpass will render into a Framebuffer. The framebuffer links to the images you will render to, and it’s used when starting a renderpass to set the target images for rendering
+        std::vector<vk::Format> colorFormats;                                   // with dynamic rendering there is no render pass, the pipeline only knows the attachment formats
+        vk::PipelineRenderingCreateInfoKHR renderingInfo;                       // references the color formats, used when the render pass is null
         uint32_t subpass;                                                       // splits the rendering operations of a render pass into subpasses. All subpasses in a render pass share the same resolution and tile arrangement, and as a result, they can access the results of previous subpass
     };
 
+    // layouts come from the device's layout cache and are shared, vertex input is checked against the vertex shader
+
     class Pipeline
     {
     public:
-        Pipeline(Device&, const std::string& vertShaderPath, const std::string& fragShaderPath, const PipelineConfig&);
+        Pipeline
+        (
+            Device&, 
+            const std::string& vertShaderPath, const std::string& fragShaderPath, 
+            const PipelineConfig&, const vk::PipelineCache& cache = {}
+        );
+        Pipeline
+        (
+            Device&, 
+            std::vector<char> vertShaderCode, std::vector<char> fragShaderCode, 
+            const PipelineConfig&, const vk::PipelineCache& cache = {}
+        );
         Pipeline(const Pipeline&) = delete;
         Pipeline(const Pipeline&&) = delete;
         Pipeline& operator=(const Pipeline&) = delete;
         Pipeline& operator=(const Pipeline&&) = delete;
         operator const vk::Pipeline&() const noexcept;
+        const vk::PipelineLayout& getLayout() const noexcept;
         ~Pipeline();
 
-        static void defaultConfig(PipelineConfig&, const vk::RenderPass&);
+        static vk::PipelineLayout layoutFor(Device&, const PipelineConfig&, std::span<const uint32_t> vertCode, std::span<const uint32_t> fragCode);
+        static vk::Pipeline create    // owned by the caller, from modules and a layout that outlive the call
+        (
+            Device&, const vk::ShaderModule& vertShader, const vk::ShaderModule& fragShader,
+            const vk::PipelineLayout&, const PipelineConfig&, const vk::PipelineCache& cache = {}
+        );
+        static void defaultConfig(PipelineConfig&, const vk::RenderPass&, vk::SampleCountFlagBits samples = vk::SampleCountFlagBits::e1);
+        static void renderingConfig(PipelineConfig&, std::vector<vk::Format> colorFormats, vk::Format depthFormat);
+        static void featureConfig(PipelineConfig&, const ShaderFeatures&);
+        static void drawStateConfig(PipelineConfig&, const DrawState&);
+        static void dynamicStateConfig(PipelineConfig&, uint32_t dynamicMask);
+        static void bindlessConfig(PipelineConfig&, uint32_t set, const vk::DescriptorSetLayout&);
+        static void postConfig(PipelineConfig&, const vk::RenderPass&, uint32_t subpass, const vk::DescriptorSetLayout&);
     private:
         void createLayout(const PipelineConfig&);
-        void createPipeline(const PipelineConfig&);
+        void createPipeline(const PipelineConfig&, const vk::PipelineCache&);
 
         Shader vertShader;
         Shader fragShader;
@@ -0,0 +1,86 @@
+#pragma once
+
+#include "dot_Device.h"
+#include "dot_Pipeline.h"
+#include "dot_DynamicState.h"
+
+#include <functional>
+#include <future>
+#include <map>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace dot
+{
+    struct PipelineLibraryStats
+    {
+        size_t parts = 0;           // vertex input, pre-rasterization, fragment shader and fragment output libraries compiled
+        size_t variants = 0;        // complete pipelines handed out
+        size_t optimized = 0;       // variants whose fast link was replaced by the optimized one
+        double partMs = 0.0;
+        double linkMs = 0.0;        // fast links only, the optimized ones run in the background
+        double linkMsMax = 0.0;     // worst time a first use of a variant waited for
+    };
+
+    // variants of one pipeline layout differing in shaders, their specialization and fixed function state, the four parts of a pipeline are
+    // compiled once as libraries and shared, a new combination only costs a fast link; an optimized link is started in
+    // the background and swapped in by update. Without graphics pipeline library support every variant is a full compile
+
+    class PipelineLibrary
+    {
+    public:
+        using ConfigFn = std::function<void(PipelineConfig&)>;  // fills the state the variants share, layout included
+
+        PipelineLibrary(Device&, ConfigFn baseConfig, uint32_t dynamicMask = 0, const vk::PipelineCache& cache = {}, bool linkParts = true);
+        PipelineLibrary(const PipelineLibrary&) = delete;
+        PipelineLibrary(const PipelineLibrary&&) = delete;
+        PipelineLibrary& operator=(const PipelineLibrary&) = delete;
+        PipelineLibrary& operator=(const PipelineLibrary&&) = delete;
+        ~PipelineLibrary();
+        vk::Pipeline get(const std::string& vertShaderPath, const std::string& fragShaderPath, const DrawState&, const ShaderFeatures& = {});
+        bool update() noexcept;     // true when an optimized variant replaced a handle returned before
+        const vk::PipelineLayout& getLayout() const noexcept;     // null until the first variant was requested
+        bool linking() const noexcept;
+        const PipelineLibraryStats& getStats() const noexcept;
+    private:
+        enum Part : uint32_t
+        {
+            VertexInput,
+            PreRasterization,
+            FragmentShader,
+            FragmentOutput,
+            PartCount
+        };
+
+        struct Variant
+        {
+            vk::Pipeline pipeline;                  // fast linked until the optimized link is swapped in
+            std::future<vk::Pipeline> optimized;
+        };
+
+        using PartKey = std::tuple<uint32_t, std::string, uint64_t, uint64_t>;         // part, shader, state, features
+        using VariantKey = std::tuple<std::string, std::string, uint64_t, uint64_t>;   // shaders, state, features
+
+        void createLayout(const std::string& vertShaderPath, const std::string& fragShaderPath);
+        vk::Pipeline getPart(Part, const std::string& shaderPath, const DrawState&, const ShaderFeatures&);
+        vk::Pipeline createPart(Part, const std::string& shaderPath, const DrawState&, const ShaderFeatures&) const;
+        vk::Pipeline createComplete(const std::string& vertShaderPath, const std::string& fragShaderPath, const DrawState&, const ShaderFeatures&) const;
+        vk::Pipeline link(std::vector<vk::Pipeline> parts, bool optimize) const;
+        void configure(PipelineConfig&, const DrawState&, const ShaderFeatures&) const;
+
+        static uint32_t partStates(Part) noexcept;
+        static vk::GraphicsPipelineLibraryFlagsEXT partFlags(Part) noexcept;
+
+        ConfigFn baseConfig;
+        uint32_t dynamicMask;
+        vk::PipelineCache cache;
+        bool useLibraries;
+        vk::PipelineLayout layout;
+        std::map<PartKey, vk::Pipeline> parts;
+        std::map<VariantKey, Variant> variants;
+        PipelineLibraryStats stats;
+
+        Device& device;
+    };
+}
\ No newline at end of file
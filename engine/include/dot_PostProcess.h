@@ -0,0 +1,52 @@
+#pragma once
+
+#include "dot_Device.h"
+#include "dot_Swapchain.h"
+#include "dot_Pipeline.h"
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dot
+{
+    // pipelines and descriptors of the swapchain's post stages, merged stages are recorded as subpasses of the
+    // frame's render pass, the others as render passes of their own after it
+
+    class PostProcess
+    {
+    public:
+        PostProcess(Device&);
+        PostProcess(const PostProcess&) = delete;
+        PostProcess(const PostProcess&&) = delete;
+        PostProcess& operator=(const PostProcess&) = delete;
+        PostProcess& operator=(const PostProcess&&) = delete;
+        ~PostProcess();
+        void setSwapchain(const Swapchain&);
+        void updatePipelines(const Swapchain&);
+        bool reloadShader(const Swapchain&, const std::string& name, std::vector<char> code);
+        void recordMerged(const vk::CommandBuffer&, const Swapchain&, size_t imageIndex) const noexcept;
+        void recordSeparate(const vk::CommandBuffer&, const Swapchain&, size_t imageIndex) const noexcept;
+    private:
+        void createSetLayouts();
+        void createSampler();
+        std::unique_ptr<Pipeline> createPipeline(const Swapchain&, size_t stage) const;
+        std::vector<char> getCode(const std::string& name) const;
+        void createDescriptors(const Swapchain&);
+        void retirePipeline(std::unique_ptr<Pipeline>) noexcept;
+        void retireDescriptors() noexcept;
+        void recordStage(const vk::CommandBuffer&, const Swapchain&, size_t stage, size_t imageIndex) const noexcept;
+
+        vk::DescriptorSetLayout inputSetLayout;     // previous stage as an input attachment, same pixel only
+        vk::DescriptorSetLayout samplerSetLayout;   // previous stage as a sampled image, any pixel
+        vk::Sampler sampler;
+        std::vector<std::unique_ptr<Pipeline>> pipelines;               // stage s uses pipelines[s - 1]
+        std::vector<vk::RenderPass> pipelineRenderPasses;               // render passes the pipelines are built for
+        std::unordered_map<std::string, std::vector<char>> reloadedCode; // spv file name to code replacing the embedded one
+        vk::DescriptorPool descriptorPool;
+        std::vector<std::vector<vk::DescriptorSet>> descriptorSets;     // [s - 1][image]
+
+        Device& device;
+    };
+}
\ No newline at end of file
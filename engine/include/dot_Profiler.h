@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dot
+{
+    // collects named phase durations from any thread, used to break down time to first frame
+
+    class Profiler
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        class Scope
+        {
+        public:
+            Scope(std::string phase) noexcept;
+            Scope(const Scope&) = delete;
+            Scope(const Scope&&) = delete;
+            Scope& operator=(const Scope&) = delete;
+            Scope& operator=(const Scope&&) = delete;
+            ~Scope();
+        private:
+            std::string phase;
+            Clock::time_point start;
+        };
+
+        static void record(const std::string& phase, Clock::time_point start, Clock::time_point end);
+        static void report(std::ostream&);
+        static double sinceStart() noexcept;
+    private:
+        struct Phase
+        {
+            std::string name;
+            double startMs;
+            double durationMs;
+            std::thread::id thread;
+        };
+
+        static std::mutex mutex;
+        static std::vector<Phase> phases;
+        static const Clock::time_point startTime;
+    };
+}
+
+#define DOT_PROFILE_CONCAT_(a, b) a##b
+#define DOT_PROFILE_CONCAT(a, b) DOT_PROFILE_CONCAT_(a, b)
+#define DOT_PROFILE_SCOPE(name) dot::Profiler::Scope DOT_PROFILE_CONCAT(profileScope, __LINE__)(name);
\ No newline at end of file
@@ -0,0 +1,150 @@
+#pragma once
+
+#include "dot_Device.h"
+
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace dot
+{
+    enum class RenderGraphAccess
+    {
+        ColorAttachment,    // written as a color attachment of the pass' render pass
+        DepthAttachment,    // written as the depth attachment of the pass' render pass
+        Sampled,            // read by fragment shaders
+        TransferSrc,
+        TransferDst
+    };
+
+    struct RenderGraphImageDesc
+    {
+        vk::Format format;
+        vk::Extent2D extent;
+    };
+
+    struct RenderGraphStats
+    {
+        size_t passes = 0;
+        size_t culledPasses = 0;
+        size_t barriers = 0;
+        vk::DeviceSize transientBytes = 0;  // every transient image in its own memory
+        vk::DeviceSize allocatedBytes = 0;  // transient memory actually allocated, images with disjoint lifetimes share it
+    };
+
+    // passes declare the images they read and write, compile derives order, culling, barriers and memory from that
+
+    class RenderGraph
+    {
+    public:
+        using ResourceId = uint32_t;
+        using PassId = uint32_t;
+        using ExecuteFn = std::function<void(const vk::CommandBuffer&)>;
+
+        class PassBuilder
+        {
+        public:
+            ResourceId create(const std::string& name, const RenderGraphImageDesc&);
+            void read(ResourceId, RenderGraphAccess = RenderGraphAccess::Sampled);
+            void write(ResourceId, RenderGraphAccess = RenderGraphAccess::ColorAttachment);
+            void sideEffect() noexcept; // kept even when nothing reads its outputs
+        private:
+            friend class RenderGraph;
+            PassBuilder(RenderGraph&, PassId) noexcept;
+
+            RenderGraph& graph;
+            PassId pass;
+        };
+
+        using SetupFn = std::function<void(PassBuilder&)>;
+
+        RenderGraph(Device&);
+        RenderGraph(const RenderGraph&) = delete;
+        RenderGraph(const RenderGraph&&) = delete;
+        RenderGraph& operator=(const RenderGraph&) = delete;
+        RenderGraph& operator=(const RenderGraph&&) = delete;
+        ~RenderGraph();
+        ResourceId importImage
+        (
+            const std::string& name, const vk::Image&, const vk::ImageView&, const RenderGraphImageDesc&,
+            vk::ImageLayout initialLayout, vk::ImageLayout finalLayout
+        );
+        PassId addPass(const std::string& name, const SetupFn&, ExecuteFn);
+        void compile();
+        void execute(const vk::CommandBuffer&) const noexcept;
+        void reset() noexcept;
+        const vk::RenderPass& getRenderPass(PassId) const noexcept;
+        const vk::ImageView& getView(ResourceId) const noexcept;
+        const RenderGraphStats& getStats() const noexcept;
+        void report(std::ostream&) const;
+    private:
+        struct Resource
+        {
+            std::string name;
+            RenderGraphImageDesc desc;
+            bool imported = false;
+            vk::ImageLayout initialLayout = vk::ImageLayout::eUndefined;
+            vk::ImageLayout finalLayout = vk::ImageLayout::eUndefined;
+            vk::ImageUsageFlags usage;
+            vk::Image image;
+            vk::ImageView view;
+            size_t firstUse = ~size_t(0);   // positions in the compiled order
+            size_t lastUse = 0;
+            vk::DeviceSize size = 0;
+            vk::DeviceSize offset = 0;
+            bool aliased = false;           // shares memory with another transient image
+        };
+
+        struct Access
+        {
+            ResourceId resource;
+            RenderGraphAccess type;
+            bool write;
+        };
+
+        struct Barriers
+        {
+            vk::PipelineStageFlags srcStages;
+            vk::PipelineStageFlags dstStages;
+            std::vector<vk::ImageMemoryBarrier> images;
+        };
+
+        struct Pass
+        {
+            std::string name;
+            std::vector<Access> accesses;
+            ExecuteFn execute;
+            bool sideEffect = false;
+            bool culled = false;
+            Barriers barriers;                          // recorded before the pass
+            vk::RenderPass renderPass;                  // only for passes writing attachments
+            vk::Framebuffer framebuffer;
+            vk::Extent2D extent;
+            std::vector<vk::ClearValue> clearValues;
+        };
+
+        void cullPasses();
+        void sortPasses();
+        void computeLifetimes();
+        void allocateTransients();
+        void createRenderPass(Pass&, size_t position);
+        void computeBarriers();
+        void destroyObjects() noexcept;
+
+        static bool isDepthFormat(vk::Format) noexcept;
+        static vk::ImageAspectFlags aspectOf(vk::Format) noexcept;
+        static vk::ImageAspectFlags viewAspectOf(vk::Format) noexcept;
+
+        std::vector<Resource> resources;
+        std::vector<Pass> passes;
+        std::vector<PassId> order;      // compiled execution order of the passes that survived culling
+        Barriers finalBarriers;         // imported images to their final layouts
+        std::vector<vk::DeviceMemory> memories;
+        RenderGraphStats stats;
+        bool compiled = false;
+
+        Device& device;
+    };
+}
\ No newline at end of file
@@ -3,43 +3,131 @@
 #include "dot_Device.h"
 #include "dot_Swapchain.h"
 #include "dot_Pipeline.h"
+#include "dot_PostProcess.h"
+#include "dot_Descriptors.h"
+#include "dot_Transforms.h"
+#include "dot_Bindless.h"
+#include "dot_ShaderWatcher.h"
+#include "dot_Result.h"
 
 #include "Window.h"
 
 #include <string>
 #include <memory>
 #include <vector>
+#include <future>
+#include <functional>
 
 namespace dot
 {
+    struct RendererConfig
+    {
+        size_t framesInFlight = 2;  // frames the cpu records ahead of the gpu, independent of the swapchain image count
+        bool depth = true;          // depth attachment in a format the device supports
+        uint32_t samples = 1;       // msaa sample count of the scene, clamped to what the device supports
+        PostConfig post;            // effects run on the scene before presenting
+        bool dynamicRendering = true;   // without render pass objects when the device supports it and no post effects run
+        bool hotReload = false;         // scene shaders recompiled and swapped in when their sources change
+        std::string shaderSourceDir = "engine/shaders";
+        uint32_t maxObjects = 1 << 17;  // model matrices the object buffer holds per frame, 8 MiB per swapchain image
+    };
+
     class Renderer
     {
+        // objects replaced while frames using them may still be in flight, destroyed once those frames completed
+        struct Retired
+        {
+            std::unique_ptr<Swapchain> pSwapchain;
+            std::unique_ptr<Pipeline> pPipeline;
+            std::vector<vk::CommandBuffer> cmdBuffers;
+            uint64_t timelineValue; // device timeline value after which nothing uses the objects anymore
+        };
+
     public:
-        Renderer(Window&, Device&);
+        using RecordFn = std::function<void(const vk::CommandBuffer&)>;
+
+        Renderer(Window&, Device&, const RendererConfig& = {});
         Renderer(const Renderer&) = delete;
         Renderer(const Renderer&&) = delete;
         Renderer& operator=(const Renderer&) = delete;
         Renderer& operator=(const Renderer&&) = delete;
         ~Renderer();
-        void beginFrame();
-        void endFrame();
+        Result<> beginFrame() noexcept;
+        Result<> endFrame() noexcept;
+        Result<> recordOffscreen(const RecordFn&);
+        Result<> recordScene(uint64_t version, const RecordFn&);
+        void setCommandCaching(bool) noexcept;
+        Result<> setSampleCount(uint32_t) noexcept;
+        vk::SampleCountFlagBits getSampleCount() const noexcept;
+        void invalidateCommands() noexcept;
         const vk::CommandBuffer& getCurrentCmdBufferGfx() const noexcept;
+        const vk::RenderPass& getRenderPass() const noexcept;
+        void defaultPipelineConfig(PipelineConfig&) const;
+        size_t getFramesInFlight() const noexcept;
+        Descriptors& getDescriptors() noexcept;
+        Transforms& getTransforms() noexcept;
+        Bindless* getBindless() noexcept;       // null when the device has no descriptor indexing
         bool frameStarted() const noexcept;
+        const PostConfig& getPostConfig() const noexcept;
+        vk::DeviceSize getPostTrafficBytes() const noexcept;
+        bool shaderReloadPending() const noexcept;
     private:
-        void beginRenderPass() const noexcept;
+        void beginRenderPass() noexcept;
         void endRenderPass() const noexcept;
-        void recreateSwapchain() noexcept;
-        void createPipeline(const std::string& vertPath, const std::string& fragPath);
+        void setFrameState(const vk::CommandBuffer&) const noexcept;
+        Result<> recreateSwapchain() noexcept;
+        void releaseRetired(bool all = false) noexcept;
+        void createPipeline(std::vector<char> vertCode, std::vector<char> fragCode, bool required = true);
+        Result<> waitPipeline() noexcept;
+        void reloadShaders() noexcept;
         void allocateCmdBuffersGfx();
+        void allocateSceneCmdBuffers();
+        void createSyncObjects();
 
         Window& wnd;
         Device& device;
         std::unique_ptr<Swapchain> pSwapchain = nullptr;
         std::unique_ptr<Pipeline> pPipeline = nullptr;
+        std::unique_ptr<PostProcess> pPost = nullptr;
+        std::unique_ptr<Descriptors> pDescriptors = nullptr;   // transient sets are reset when their frame slot is reused
+        std::unique_ptr<Transforms> pTransforms = nullptr;     // a region per swapchain image, recreated when the image count changes
+        std::unique_ptr<Bindless> pBindless = nullptr;         // the global set every bindless pipeline binds at Bindless::set
+        uint64_t bindlessRemovals = 0;                          // removals the cached scene commands were recorded after
+        uint32_t maxObjects;
+        std::future<std::unique_ptr<Pipeline>> pipelineFuture;  // pipeline compiling in the background, joined by the first frame that needs it
+        bool pipelineRequired = true;                           // false for reloads, frames keep the current pipeline until it is ready
+        vk::RenderPass pipelineRenderPass;                      // render pass the newest pipeline is built for, null with dynamic rendering
+        vk::Format pipelineColorFormat = vk::Format::eUndefined;
+        std::vector<char> vertCode;                             // kept to rebuild the pipeline when the render pass changes, always linked once
+        std::vector<char> fragCode;
+        std::vector<char> reloadedVertCode;                     // compiled by the watcher and not yet linked, empty when unchanged
+        std::vector<char> reloadedFragCode;
+        std::vector<char> linkingVertCode;                      // code of the reload compiling now, adopted once its pipeline is in use
+        std::vector<char> linkingFragCode;
+        std::unique_ptr<ShaderWatcher> pWatcher = nullptr;      // only with hot reload
+        bool shadersChanged = false;                            // reloaded code waiting for the running compile to finish
+        std::vector<Retired> retired;
         std::vector<vk::CommandBuffer> cmdBuffersGfx;
 
+        // scene commands recorded once into secondary buffers, one per swapchain image, reused while the version matches
+        static constexpr uint64_t noVersion = ~0ULL;
+        std::vector<vk::CommandBuffer> sceneCmdBuffers;
+        std::vector<uint64_t> sceneVersions;
+        bool commandCaching = false;
+        bool frameCaching = false;  // caching mode of the current frame, fixed when its render pass begins
+
+        size_t framesInFlight;
+        vk::Format depthFormat = vk::Format::eUndefined;
+        vk::SampleCountFlagBits samples = vk::SampleCountFlagBits::e1;
+        PostConfig postConfig;
+        bool dynamicRendering = false;
         size_t currentFrameInFlight = 0;
+        std::vector<vk::Semaphore> imageAvailableSemaphores;    // per frame in flight
+        std::vector<uint64_t> frameTimelineValues;              // per frame in flight, timeline value of its last submission
+        std::vector<uint64_t> imageTimelineValues;              // per swapchain image, timeline value of the last frame rendering to it
         uint32_t currentImageIndex = 0;
         bool _frameStarted = false;
+        bool renderPassBegun = false;   // the swapchain pass begins lazily so offscreen work can be recorded ahead of it
+        bool swapchainOutdated = false; // recreation postponed while the window is minimized
     };
 }
\ No newline at end of file
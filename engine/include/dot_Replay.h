@@ -0,0 +1,50 @@
+#pragma once
+
+#include "dot_Device.h"
+#include "dot_Renderer.h"
+#include "dot_Model.h"
+#include "dot_Capture.h"
+
+#include "Window.h"
+
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace dot
+{
+    struct ReplayConfig
+    {
+        std::string capturePath;
+        std::string timingsPath;    // per frame "frame cpu_ms checksum" lines, for comparing two builds frame by frame
+        bool paced = false;         // sleeps to the captured frame deltas instead of running as fast as possible
+    };
+
+    class Replay
+    {
+    public:
+        Replay(Window&, Device&, Renderer&);
+        Replay(const Replay&) = delete;
+        Replay(const Replay&&) = delete;
+        Replay& operator=(const Replay&) = delete;
+        Replay& operator=(const Replay&&) = delete;
+        void run(const ReplayConfig&);
+    private:
+        struct Draw
+        {
+            uint32_t modelId;
+            uint32_t instanceCount;
+        };
+
+        void renderFrame();
+        Model& getModel(uint32_t id) const;
+
+        Window& wnd;
+        Device& device;
+        Renderer& renderer;
+
+        std::map<uint32_t, std::unique_ptr<Model>> models;
+        std::vector<Draw> draws;
+    };
+}
\ No newline at end of file
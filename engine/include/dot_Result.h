@@ -0,0 +1,53 @@
+#pragma once
+
+#include "dot_Vulkan.h"
+
+#include <utility>
+
+namespace dot
+{
+    // error codes of the per-frame path, propagated by value without unwinding or heap allocation
+
+    struct Error
+    {
+        vk::Result code;
+        const char* what;   // static string
+    };
+
+    template<typename T = void>
+    class Result
+    {
+    public:
+        Result(T value) noexcept
+            : _value(std::move(value)){}
+        Result(Error error) noexcept
+            : _error(error){}
+        explicit operator bool() const noexcept { return _error.code == vk::Result::eSuccess; }
+        T& value() noexcept { return _value; }
+        const T& value() const noexcept { return _value; }
+        const Error& error() const noexcept { return _error; }
+    private:
+        T _value = {};
+        Error _error = {vk::Result::eSuccess, nullptr};
+    };
+
+    template<>
+    class Result<void>
+    {
+    public:
+        Result() noexcept = default;
+        Result(Error error) noexcept
+            : _error(error){}
+        explicit operator bool() const noexcept { return _error.code == vk::Result::eSuccess; }
+        const Error& error() const noexcept { return _error; }
+    private:
+        Error _error = {vk::Result::eSuccess, nullptr};
+    };
+
+    // turns an error into dot::RuntimeError at the boundary to exception based code
+
+    [[noreturn]] void throwError(const Error&, const char* file, int line);
+}
+
+#define DOT_TRY(expr) if(auto dotResult = (expr); !dotResult) return dotResult.error();
+#define DOT_CHECK(expr) if(auto dotResult = (expr); !dotResult) dot::throwError(dotResult.error(), __FILE__, __LINE__);
\ No newline at end of file
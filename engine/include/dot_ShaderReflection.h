@@ -0,0 +1,45 @@
+#pragma once
+
+#include "dot_Vulkan.h"
+
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace dot
+{
+    struct ShaderBinding
+    {
+        uint32_t set;
+        uint32_t binding;
+        vk::DescriptorType type;
+        uint32_t count;             // array length, 0 for a runtime sized array
+        vk::ShaderStageFlags stages;
+    };
+
+    struct ShaderInput
+    {
+        uint32_t location;
+        vk::Format format;          // one location per column for matrices
+    };
+
+    // the interface of one or more shader stages read from their spir-v, enough to build the pipeline layout
+    // and to check vertex input against what the vertex shader consumes
+
+    struct ShaderLayout
+    {
+        vk::ShaderStageFlags stages;
+        std::vector<ShaderBinding> bindings;                // sorted by set, then binding
+        std::vector<vk::PushConstantRange> pushConstants;   // at most one range, all stages share a block
+        std::vector<uint32_t> specConstants;                // constant_id values, sorted
+        std::vector<ShaderInput> inputs;                    // vertex stage only, sorted by location
+
+        void merge(const ShaderLayout&);
+        void makeDynamic(uint32_t set, uint32_t binding) noexcept;  // a buffer bound with dynamic offsets, spir-v does not tell
+        uint32_t setCount() const noexcept;
+        std::vector<vk::DescriptorSetLayoutBinding> setBindings(uint32_t set) const;
+        void validateVertexInput(std::span<const vk::VertexInputAttributeDescription>) const;   // throws when an input is unfed or fed another numeric type
+
+        static ShaderLayout reflect(std::span<const uint32_t> code);
+    };
+}
\ No newline at end of file
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <atomic>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace dot
+{
+    // watches a shader source directory with inotify and recompiles changed sources on a background thread with the
+    // build's glslc, spirv-opt and spirv-val steps, results are collected by the renderer at a frame boundary; failed
+    // compiles are logged and produce nothing
+
+    class ShaderWatcher
+    {
+    public:
+        struct Compiled
+        {
+            std::string name;           // spir-v file name the build gives the source, "vert.spv" for shader.vert
+            std::vector<char> code;
+        };
+
+        ShaderWatcher(const std::string& sourceDir, std::function<void()> onCompiled = {}, const std::string& compiler = "glslc");
+        ShaderWatcher(const ShaderWatcher&) = delete;
+        ShaderWatcher(const ShaderWatcher&&) = delete;
+        ShaderWatcher& operator=(const ShaderWatcher&) = delete;
+        ShaderWatcher& operator=(const ShaderWatcher&&) = delete;
+        ~ShaderWatcher();
+        std::vector<Compiled> takeCompiled();
+        bool hasCompiled() const noexcept;
+
+        static std::string spirvName(const std::string& source);
+    private:
+        void watch();
+        void compile(const std::string& source);
+        static bool run(const std::vector<std::string>& args, std::string& output);   // true when the tool exited with 0
+
+        // changes arriving this close together are one save, editors write and rename in several steps
+        static constexpr int debounceMs = 50;
+        static constexpr int pollMs = 100;
+        static constexpr const char* optimizer = "spirv-opt";
+        static constexpr const char* validator = "spirv-val";
+
+        std::string sourceDir;
+        std::string compiler;
+        std::function<void()> onCompiled;   // called from the watcher thread
+        int inotifyFd = -1;
+        std::atomic<bool> stopping = false;
+        std::thread watcher;
+
+        mutable std::mutex compiledMutex;
+        std::vector<Compiled> compiled;
+        std::atomic<bool> compiledPending = false;
+    };
+}
\ No newline at end of file
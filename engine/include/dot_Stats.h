@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+
+namespace dot
+{
+    struct Statistics
+    {
+        Statistics() = default;
+        Statistics(std::vector<double> samples);
+
+        size_t count = 0;
+        double min = 0.0;
+        double max = 0.0;
+        double mean = 0.0;
+        double median = 0.0;
+        double stddev = 0.0;
+        double p95 = 0.0;
+        double p99 = 0.0;
+    private:
+        static double percentile(const std::vector<double>& sorted, double p) noexcept;
+    };
+}
\ No newline at end of file
@@ -2,34 +2,85 @@
 
 #include "dot_Vulkan.h"
 #include "dot_Device.h"
+#include "dot_Image.h"
 
 #include "Window.h"
 
 #include <memory>
+#include <vector>
 
 namespace dot
 {
+    enum PostEffect : uint32_t
+    {
+        PostTonemap     = 1 << 0,
+        PostGrade       = 1 << 1,
+        PostVignette    = 1 << 2,
+        PostFxaa        = 1 << 3    // samples neighbours, always a render pass of its own
+    };
+
+    struct PostConfig
+    {
+        uint32_t effects = 0;   // PostEffect bits, run in declaration order
+        bool merged = true;     // per pixel effects as subpasses of the frame's render pass, otherwise one render pass each
+
+        bool operator==(const PostConfig&) const = default;
+    };
+
+    // stage 0 renders the scene, stage s > 0 runs the s-th enabled post effect on the output of stage s - 1;
+    // stages up to the merged count are subpasses of the frame's render pass, the rest are render passes of their own
+
     class Swapchain
     {
     public:
-        Swapchain(Window&, Device&, std::shared_ptr<Swapchain> oldSwapchain = nullptr);
+        Swapchain
+        (
+            Window&, Device&, Swapchain* pOldSwapchain = nullptr, vk::Format depthFormat = vk::Format::eUndefined,
+            vk::SampleCountFlagBits samples = vk::SampleCountFlagBits::e1, const PostConfig& = {}, bool dynamicRendering = false
+        );
         Swapchain(const Swapchain&) = delete;
         Swapchain(const Swapchain&&) = delete;
         Swapchain& operator=(const Swapchain&) = delete;
         Swapchain& operator=(const Swapchain&&) = delete;
         ~Swapchain();
-        vk::Result acquireNextImage(uint32_t&) const;
-        vk::Result submitCmdBuffer(const vk::CommandBuffer&, uint32_t index);
+        vk::Result acquireNextImage(VkSemaphore imageAvailable, uint32_t& index) const noexcept;
+        vk::Result present(uint32_t index) const noexcept;
         operator const vk::SwapchainKHR&() const noexcept;
         const vk::Extent2D& getExtent() const noexcept;
         const vk::RenderPass& getRenderPass() const noexcept;
+        const std::vector<vk::ClearValue>& getClearValues() const noexcept;
+        bool hasDepth() const noexcept;
+        bool usesDynamicRendering() const noexcept;
+        vk::Format getColorFormat() const noexcept;
+        vk::Format getDepthFormat() const noexcept;
+        void beginRendering(const vk::CommandBuffer&, size_t index, vk::RenderingFlagsKHR) const noexcept;
+        void endRendering(const vk::CommandBuffer&, size_t index) const noexcept;
+        void setSamples(vk::SampleCountFlagBits);
+        vk::SampleCountFlagBits getSamples() const noexcept;
         const vk::Framebuffer& getFramebuffer(size_t) const noexcept;
-        size_t getMaxFramesInFlight() const noexcept;
+        size_t getStageCount() const noexcept;
+        size_t getMergedStageCount() const noexcept;
+        PostEffect getStageEffect(size_t stage) const noexcept;
+        const vk::RenderPass& getStageRenderPass(size_t stage) const noexcept;
+        uint32_t getStageSubpass(size_t stage) const noexcept;
+        const vk::Framebuffer& getStageFramebuffer(size_t stage, size_t index) const noexcept;
+        const vk::ImageView& getStageInput(size_t stage, size_t index) const noexcept;
+        vk::DeviceSize getPostTrafficBytes() const noexcept;
+        const vk::Semaphore& getRenderFinishedSemaphore(size_t index) const noexcept;
+        size_t getImageCount() const noexcept;
     private:
-        void createSwapchain();
+        void createSwapchain(Swapchain* pOldSwapchain);
         void createImageViews();
-        void createRenderPass();
+        void createDepthImages();
+        void createColorImages();
+        void createPostTargets();
+        void createRenderPass(Swapchain* pOldSwapchain);
+        void createStageRenderPasses(Swapchain* pOldSwapchain);
         void createFramebuffers();
+        void createStageFramebuffers();
+        vk::Framebuffer createFramebuffer(const vk::RenderPass&, const std::vector<vk::ImageView>& attachments) const;
+        vk::Format getStageFormat(size_t stage) const noexcept;
+        const vk::ImageView& getStageOutput(size_t stage, size_t index) const noexcept;
         void createSyncObjects();
         void destroySyncObjects();
         vk::Extent2D getExtent(const vk::SurfaceCapabilitiesKHR&) const noexcept;
@@ -43,17 +94,26 @@ namespace dot
         vk::PresentModeKHR presentMode;
         vk::Format imageFormat;
         vk::SwapchainKHR swapchain;
-        std::shared_ptr<Swapchain> oldSwapchain = nullptr;
         std::vector<vk::Image> images;
         std::vector<vk::ImageView> imageViews;
+        vk::Format depthFormat;                             // no depth attachment when undefined
+        std::vector<std::unique_ptr<Image>> depthImages;    // one per swapchain image, each framebuffer gets its own
+        vk::SampleCountFlagBits samples;
+        std::vector<std::unique_ptr<Image>> colorImages;    // multisampled scene color, resolved into the first stage output
         vk::RenderPass renderPass;
+        bool ownsRenderPass = true;         // handed over to the next swapchain when it reuses the render pass
+        bool ownsStageRenderPasses = true;  // the same for the stage passes, they do not depend on the sample count
+        bool dynamicRendering;              // no render pass or framebuffers, the scene attachments are bound when rendering begins
+        std::vector<vk::ClearValue> clearValues;
         std::vector<vk::Framebuffer> framebuffers;
 
-        std::vector<vk::Semaphore> imageAvailableSemaphores;
-        std::vector<vk::Semaphore> renderFinishedSemaphores;
-        std::vector<vk::Fence> imageInFlightFences;
+        PostConfig post;
+        std::vector<PostEffect> effects;                                // stage s runs effects[s - 1]
+        size_t mergedStages = 0;
+        std::vector<std::vector<std::unique_ptr<Image>>> postTargets;   // output of stage s for every image, s below the stage count
+        std::vector<vk::RenderPass> stageRenderPasses;                  // stages after the merged ones
+        std::vector<std::vector<vk::Framebuffer>> stageFramebuffers;
 
-        size_t maxFramesInFlight;
-        size_t currentFrameInFlight = 0;
+        std::vector<vk::Semaphore> renderFinishedSemaphores;
     };
 }
\ No newline at end of file
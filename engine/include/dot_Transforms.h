@@ -0,0 +1,70 @@
+#pragma once
+
+#include "dot_Device.h"
+#include "dot_Buffer.h"
+#include "dot_Descriptors.h"
+#include "dot_Result.h"
+
+#include <glm/glm.hpp>
+
+#include <memory>
+#include <span>
+#include <vector>
+
+namespace dot
+{
+    // the push constant block of shader.vert
+
+    struct TransformPush
+    {
+        glm::mat4 model = glm::mat4(1.0f);  // read when the pipeline is not specialized for the object buffer
+        uint32_t objectIndex = 0;           // first object of the draw, instances add their index
+        uint32_t materialIndex = 0;         // bindless index of the draw's material, ignored by shader.vert
+    };
+
+    // camera and object model matrices the scene shaders read from set 0, one region per swapchain image in two persistently
+    // mapped buffers bound with dynamic offsets. Objects are written straight into the region as they are added, moving
+    // every object is one contiguous write per frame instead of a buffer update per object
+
+    class Transforms
+    {
+    public:
+        Transforms(Device&, Descriptors&, size_t regionCount, uint32_t capacity);
+        Transforms(const Transforms&) = delete;
+        Transforms(const Transforms&&) = delete;
+        Transforms& operator=(const Transforms&) = delete;
+        Transforms& operator=(const Transforms&&) = delete;
+        void begin(size_t region) noexcept;     // the gpu is done with the region, objects start again at index 0
+        void setCamera(const glm::mat4& viewProj) noexcept;
+        const glm::mat4& getCamera() const noexcept;
+        Result<uint32_t> add(const glm::mat4& model) noexcept;
+        Result<uint32_t> add(std::span<const glm::mat4> models) noexcept;  // consecutive indices, returns the first
+        void bind(const vk::CommandBuffer&, const vk::PipelineLayout&) const noexcept;
+        size_t getRegionCount() const noexcept;
+        uint32_t getCount() const noexcept;
+        uint32_t getCapacity() const noexcept;
+
+        static void push(const vk::CommandBuffer&, const vk::PipelineLayout&, const TransformPush&) noexcept;
+        static void pushObject(const vk::CommandBuffer&, const vk::PipelineLayout&, uint32_t objectIndex) noexcept;
+        static void pushMaterial(const vk::CommandBuffer&, const vk::PipelineLayout&, uint32_t materialIndex) noexcept;
+        static std::vector<vk::DescriptorSetLayoutBinding> getBindings();
+    private:
+        void createBuffers();
+        void createDescriptorSet();
+
+        std::unique_ptr<Buffer> pCameraBuffer;
+        std::unique_ptr<Buffer> pObjectBuffer;
+        vk::DeviceSize cameraStride;    // region sizes rounded up to the dynamic offset alignment
+        vk::DeviceSize objectStride;
+        DescriptorAllocator allocator;
+        vk::DescriptorSet descriptorSet;
+        glm::mat4 camera = glm::mat4(1.0f);
+        size_t regionCount;
+        size_t region = 0;
+        uint32_t capacity;
+        uint32_t count = 0;
+
+        Device& device;
+        Descriptors& descriptors;
+    };
+}
\ No newline at end of file
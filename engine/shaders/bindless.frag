@@ -0,0 +1,34 @@
+#version 450
+#extension GL_EXT_nonuniform_qualifier : require
+
+// the global bindless set (Bindless), arrays are indexed by the indices resources were registered at
+layout(set = 1, binding = 0) uniform texture2D textures[];
+layout(set = 1, binding = 1) uniform sampler samplers[];
+
+struct Material
+{
+	vec4 color;
+	uint texture;
+	uint sampler;
+};
+
+layout(std430, set = 1, binding = 2) readonly buffer Materials
+{
+	Material material;
+} materials[];
+
+layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec2 fragPosition;
+layout(location = 2) in vec2 fragUv;
+layout(location = 3) flat in uint fragMaterial;
+
+layout(location = 0) out vec4 outColor;
+
+void main()
+{
+	// draws of different materials are batched together, indices may diverge within a subgroup
+	Material material = materials[nonuniformEXT(fragMaterial)].material;
+
+	vec4 texel = texture(sampler2D(textures[nonuniformEXT(material.texture)], samplers[nonuniformEXT(material.sampler)]), fragUv * 8.0);
+	outColor = vec4(fragColor, 1.0) * material.color * texel;
+}
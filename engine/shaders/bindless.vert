@@ -0,0 +1,43 @@
+#version 450
+
+// specialization constants, set per pipeline variant from ShaderFeatures
+layout(constant_id = 0) const bool VERTEX_COLOR = true;
+layout(constant_id = 5) const bool OBJECT_BUFFER = false;
+
+// per frame, the same set 0 as shader.vert
+layout(set = 0, binding = 0) uniform Camera
+{
+	mat4 viewProj;
+} camera;
+
+layout(std430, set = 0, binding = 1) readonly buffer Objects
+{
+	mat4 models[];
+} objects;
+
+// per draw, the block of shader.vert (TransformPush)
+layout(push_constant) uniform Push
+{
+	mat4 model;
+	uint objectIndex;
+	uint materialIndex;
+} push;
+
+layout(location = 0) in vec3 inPosition;
+layout(location = 1) in vec3 inColor;
+
+layout(location = 0) out vec3 outFragColor;
+layout(location = 1) out vec2 outPosition;
+layout(location = 2) out vec2 outUv;
+layout(location = 3) flat out uint outMaterial;
+
+void main()
+{
+	mat4 model = OBJECT_BUFFER ? objects.models[push.objectIndex + gl_InstanceIndex] : push.model;
+
+	gl_Position = camera.viewProj * model * vec4(inPosition, 1.0);
+	outFragColor = VERTEX_COLOR ? inColor : vec3(1.0);
+	outPosition = gl_Position.xy / gl_Position.w;
+	outUv = outPosition * 0.5 + 0.5;
+	outMaterial = push.materialIndex;
+}
@@ -0,0 +1,52 @@
+#version 450
+
+layout(set = 0, binding = 0) uniform sampler2D inputColor;
+
+layout(push_constant) uniform Push
+{
+	vec2 invExtent;
+} push;
+
+layout(location = 0) in vec2 fragUV;
+
+layout(location = 0) out vec4 outColor;
+
+// fxaa 3.11 console variant: blends along the edge direction found from the luma of the four diagonal neighbours
+
+const float edgeThresholdMin = 1.0 / 16.0;
+const float edgeThreshold = 1.0 / 8.0;
+const float edgeSharpness = 8.0;
+
+float luma(vec3 color)
+{
+	return dot(color, vec3(0.299, 0.587, 0.114));
+}
+
+void main()
+{
+	vec3 center = texture(inputColor, fragUV).rgb;
+	float lumaM = luma(center);
+	float lumaNW = luma(texture(inputColor, fragUV + vec2(-0.5, -0.5) * push.invExtent).rgb);
+	float lumaNE = luma(texture(inputColor, fragUV + vec2( 0.5, -0.5) * push.invExtent).rgb);
+	float lumaSW = luma(texture(inputColor, fragUV + vec2(-0.5,  0.5) * push.invExtent).rgb);
+	float lumaSE = luma(texture(inputColor, fragUV + vec2( 0.5,  0.5) * push.invExtent).rgb);
+
+	float lumaMax = max(max(max(lumaNW, lumaNE), max(lumaSW, lumaSE)), lumaM);
+	float lumaMin = min(min(min(lumaNW, lumaNE), min(lumaSW, lumaSE)), lumaM);
+
+	if(lumaMax - lumaMin < max(edgeThresholdMin, lumaMax * edgeThreshold))
+	{
+		outColor = vec4(center, 1.0);
+		return;
+	}
+
+	vec2 dir = vec2(-((lumaNW + lumaNE) - (lumaSW + lumaSE)), (lumaNW + lumaSW) - (lumaNE + lumaSE));
+	dir /= min(abs(dir.x), abs(dir.y)) * edgeSharpness + 1e-4;
+	dir = clamp(dir, -2.0, 2.0) * push.invExtent;
+
+	vec3 near = 0.5 * (texture(inputColor, fragUV - dir * 0.5).rgb + texture(inputColor, fragUV + dir * 0.5).rgb);
+	vec3 far = 0.5 * near + 0.25 * (texture(inputColor, fragUV - dir * 2.0).rgb + texture(inputColor, fragUV + dir * 2.0).rgb);
+
+	float lumaFar = luma(far);
+	outColor = vec4(lumaFar < lumaMin || lumaFar > lumaMax ? near : far, 1.0);
+}
@@ -0,0 +1,19 @@
+#version 450
+
+layout(input_attachment_index = 0, set = 0, binding = 0) uniform subpassInput inputColor;
+
+layout(location = 0) out vec4 outColor;
+
+const float saturation = 1.15;
+const float contrast = 1.05;
+const vec3 tint = vec3(1.02, 1.0, 0.97);
+
+void main()
+{
+	vec3 color = subpassLoad(inputColor).rgb;
+	float luma = dot(color, vec3(0.2126, 0.7152, 0.0722));
+
+	color = mix(vec3(luma), color, saturation);
+	color = (color - 0.5) * contrast + 0.5;
+	outColor = vec4(clamp(color * tint, 0.0, 1.0), 1.0);
+}
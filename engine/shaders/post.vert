@@ -0,0 +1,11 @@
+#version 450
+
+// full screen triangle from the vertex index, covers the viewport without a vertex buffer
+
+layout(location = 0) out vec2 outFragUV;
+
+void main()
+{
+	outFragUV = vec2((gl_VertexIndex << 1) & 2, gl_VertexIndex & 2);
+	gl_Position = vec4(outFragUV * 2.0 - 1.0, 0.0, 1.0);
+}
@@ -1,10 +1,37 @@
 #version 450
 
+// specialization constants, set per pipeline variant from ShaderFeatures
+layout(constant_id = 2) const bool ALPHA_TEST = false;
+layout(constant_id = 3) const uint LIGHT_COUNT = 0;
+layout(constant_id = 4) const float ALPHA_CUTOFF = 0.5;
+
 layout(location = 0) in vec3 fragColor;
+layout(location = 1) in vec2 fragPosition;
 
 layout(location = 0) out vec4 outColor;
 
 void main()
 {
-	outColor = vec4(fragColor, 1.0);
+	// coverage from the color's luminance, there is no texture to take alpha from
+	float alpha = dot(fragColor, vec3(0.2126, 0.7152, 0.0722));
+	if(ALPHA_TEST && alpha < ALPHA_CUTOFF)
+		discard;
+
+	vec3 color = fragColor;
+
+	// point lights on a circle around the center of the screen
+	if(LIGHT_COUNT > 0)
+	{
+		vec3 light = vec3(0.1);
+		for(uint i = 0; i < LIGHT_COUNT; i++)
+		{
+			float angle = 6.2831853 * float(i) / float(LIGHT_COUNT);
+			vec2 offset = fragPosition - 0.6 * vec2(cos(angle), sin(angle));
+			light += vec3(1.0) / (1.0 + 16.0 * dot(offset, offset));
+		}
+
+		color *= light;
+	}
+
+	outColor = vec4(color, 1.0);
 }
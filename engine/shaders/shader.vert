@@ -1,12 +1,48 @@
 #version 450
 
-layout(location = 0) in vec2 inPosition;
+// specialization constants, set per pipeline variant from ShaderFeatures
+layout(constant_id = 0) const bool VERTEX_COLOR = true;
+layout(constant_id = 1) const bool INSTANCING = false;
+layout(constant_id = 5) const bool OBJECT_BUFFER = false;
+
+// per frame, bound with dynamic offsets into the region of the frame's swapchain image
+layout(set = 0, binding = 0) uniform Camera
+{
+	mat4 viewProj;
+} camera;
+
+layout(std430, set = 0, binding = 1) readonly buffer Objects
+{
+	mat4 models[];
+} objects;
+
+// per draw, the matrix for a few objects or the index of the first one in the object buffer (TransformPush);
+// the material index is only read by the bindless shaders, an identical block keeps set 0 bound across both
+layout(push_constant) uniform Push
+{
+	mat4 model;
+	uint objectIndex;
+	uint materialIndex;
+} push;
+
+layout(location = 0) in vec3 inPosition;
 layout(location = 1) in vec3 inColor;
 
 layout(location = 0) out vec3 outFragColor;
+layout(location = 1) out vec2 outPosition;
 
 void main()
 {
-	gl_Position = vec4(inPosition, 0.0, 1.0);
-	outFragColor = inColor;
+	vec3 position = inPosition;
+
+	// instances spread on a 64 x 64 grid instead of drawing on top of each other
+	if(INSTANCING)
+		position.xy += (vec2(gl_InstanceIndex % 64, (gl_InstanceIndex / 64) % 64) - 32.0) / 32.0;
+
+	// instances of a draw are consecutive objects
+	mat4 model = OBJECT_BUFFER ? objects.models[push.objectIndex + gl_InstanceIndex] : push.model;
+
+	gl_Position = camera.viewProj * model * vec4(position, 1.0);
+	outFragColor = VERTEX_COLOR ? inColor : vec3(1.0);
+	outPosition = gl_Position.xy / gl_Position.w;
 }
@@ -0,0 +1,14 @@
+#version 450
+
+layout(input_attachment_index = 0, set = 0, binding = 0) uniform subpassInput inputColor;
+
+layout(location = 0) out vec4 outColor;
+
+// aces filmic curve fitted by krzysztof narkowicz
+
+void main()
+{
+	vec3 color = subpassLoad(inputColor).rgb;
+	color = clamp((color * (2.51 * color + 0.03)) / (color * (2.43 * color + 0.59) + 0.14), 0.0, 1.0);
+	outColor = vec4(color, 1.0);
+}
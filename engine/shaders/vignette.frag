@@ -0,0 +1,18 @@
+#version 450
+
+layout(input_attachment_index = 0, set = 0, binding = 0) uniform subpassInput inputColor;
+
+layout(location = 0) in vec2 fragUV;
+
+layout(location = 0) out vec4 outColor;
+
+const float radius = 0.75;
+const float softness = 0.45;
+
+void main()
+{
+	vec3 color = subpassLoad(inputColor).rgb;
+	float distance = length(fragUV - 0.5) * 1.4142;
+
+	outColor = vec4(color * smoothstep(radius, radius - softness, distance), 1.0);
+}
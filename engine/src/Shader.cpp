@@ -1,21 +1,32 @@
 #include "Shader.h"
 #include "dot_Exception.h"
+#include "dot_EmbeddedShaders.h"
+
+#include <filesystem>
+
+namespace
+{
+    // embedded shaders are keyed by file name, the directory a path points into does not matter; every shader the
+    // engine uses is built into it, there are no spir-v files to fall back to
+
+    std::span<const uint32_t> findEmbedded(const std::string& filename)
+    {
+        auto code = dot::findEmbeddedShader(std::filesystem::path(filename).filename().string());
+
+        if(code.empty())
+            throw std::runtime_error("Shader " + filename + " is not embedded!");
+
+        return code;
+    }
+}
 
 Shader::Shader(const vk::Device& device)
     : device(device){}
 
 Shader::Shader(const vk::Device& device, const std::string& filename)
-    : device(device), filename(filename)
+    : device(device)
 {
-    try
-    {
-        data = readFile();
-        shaderModule = createShaderModule();
-    }
-    catch(const std::runtime_error& e)
-    {
-        throw e;
-    }
+    read(filename);
 }
 
 Shader::~Shader()
@@ -32,10 +43,17 @@ void Shader::read(const std::string& filename)
 {
     this->filename = filename;
 
+    load(findEmbedded(filename));
+}
+
+void Shader::load(std::vector<char> bytes)
+{
+    data = std::move(bytes);
+    code = {reinterpret_cast<const uint32_t*>(data.data()), data.size() / sizeof(uint32_t)};
+
     try
     {
-        data = readFile();
-        shaderModule = createShaderModule();
+        shaderModule = createShaderModule(code);
     }
     catch(const std::runtime_error& e)
     {
@@ -43,7 +61,30 @@ void Shader::read(const std::string& filename)
     }
 }
 
-std::vector<char> Shader::readFile() const
+void Shader::load(std::span<const uint32_t> staticCode)
+{
+    // the code is static, referenced without a copy
+
+    data.clear();
+    code = staticCode;
+
+    try
+    {
+        shaderModule = createShaderModule(code);
+    }
+    catch(const std::runtime_error& e)
+    {
+        throw e;
+    }
+}
+
+std::vector<char> Shader::readCode(const std::string& filename)
+{
+    auto bytes = std::as_bytes(findEmbedded(filename));
+    return std::vector<char>(reinterpret_cast<const char*>(bytes.data()), reinterpret_cast<const char*>(bytes.data() + bytes.size()));
+}
+
+std::vector<char> Shader::readFile(const std::string& filename)
 {
     std::ifstream file(filename, std::ios::ate | std::ios::binary);
 
@@ -61,12 +102,12 @@ std::vector<char> Shader::readFile() const
     return buffer;
 }
 
-vk::ShaderModule Shader::createShaderModule() const
+vk::ShaderModule Shader::createShaderModule(std::span<const uint32_t> code) const
 {
     vk::ShaderModuleCreateInfo createInfo = {};
     createInfo.sType = vk::StructureType::eShaderModuleCreateInfo;
-    createInfo.codeSize = data.size();
-    createInfo.pCode = reinterpret_cast<const uint32_t*>(data.data());
+    createInfo.codeSize = code.size_bytes();
+    createInfo.pCode = code.data();
 
     try
     {
@@ -82,4 +123,9 @@ vk::ShaderModule Shader::createShaderModule() const
 const vk::ShaderModule& Shader::getModule() const noexcept
 {
     return shaderModule;
+}
+
+std::span<const uint32_t> Shader::getCode() const noexcept
+{
+    return code;
 }
\ No newline at end of file
@@ -1,9 +1,13 @@
 #include "Window.h"
 
 #include "dot_Exception.h"
+#include "dot_Profiler.h"
 
-Window::Window()
+Window::Window(bool visible)
+    : visible(visible)
 {
+    DOT_PROFILE_SCOPE("window");
+
     if(!glfwInit()) // intializing glfw library
         throw DOT_RUNTIME("Failed to initalize GLFW library!");
 
@@ -17,6 +21,7 @@ Window::Window()
 
     glfwSetWindowUserPointer(pWnd, this);
     glfwSetFramebufferSizeCallback(pWnd, framebufferResizeCallback);
+    glfwSetWindowRefreshCallback(pWnd, refreshCallback);
 }  
 
 Window::~Window()
@@ -35,6 +40,23 @@ void Window::Resized(bool state) noexcept
     _resized = state;
 }
 
+bool Window::Damaged() const noexcept
+{
+    return _damaged;
+}
+
+void Window::Damaged(bool state) noexcept
+{
+    _damaged = state;
+}
+
+bool Window::Minimized() const noexcept
+{
+    int width = 0, height = 0;
+    glfwGetFramebufferSize(pWnd, &width, &height);
+    return width == 0 || height == 0;
+}
+
 Window::operator GLFWwindow *() const noexcept
 {
     return pWnd;
@@ -44,13 +66,20 @@ void Window::initGLFWhints() const noexcept
 {
     glfwWindowHint(GLFW_CLIENT_API, GLFW_NO_API); // no OpenGL context
     glfwWindowHint(GLFW_RESIZABLE,  GLFW_TRUE);
+    glfwWindowHint(GLFW_VISIBLE,    visible ? GLFW_TRUE : GLFW_FALSE); // hidden windows are used for headless benchmark runs
 }
 
 void Window::framebufferResizeCallback(GLFWwindow* pWnd, int width, int height) noexcept
 {
-    glfwWaitEvents();
     auto wnd = reinterpret_cast<Window*>(glfwGetWindowUserPointer(pWnd));
     wnd->Resized(true);
+    wnd->Damaged(true);
     wnd->width = width;
     wnd->height = height;
+}
+
+void Window::refreshCallback(GLFWwindow* pWnd) noexcept
+{
+    auto wnd = reinterpret_cast<Window*>(glfwGetWindowUserPointer(pWnd));
+    wnd->Damaged(true);
 }
\ No newline at end of file
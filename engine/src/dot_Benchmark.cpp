@@ -0,0 +1,1114 @@
+#include "dot_Benchmark.h"
+#include "dot_Exception.h"
+#include "dot_Stats.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <sys/resource.h>
+#endif
+
+namespace dot
+{
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    Benchmark::Benchmark(Window& wnd, Device& device, Renderer& renderer)
+        : wnd(wnd), device(device), renderer(renderer), graph(device){}
+
+    BenchmarkResult Benchmark::run(const BenchmarkConfig& config)
+    {
+        metrics.clear();
+
+        // a scene the device cannot render is skipped rather than failed, so one scene list serves every device
+
+        if(config.scene == BenchmarkScene::BindlessMaterials && !renderer.getBindless())
+        {
+            std::cout << "Skipping " << sceneName(config.scene) << ", the device has no descriptor indexing\n";
+            return BenchmarkResult::Skipped;
+        }
+
+        device.resetPeakAllocatedMemory();
+        renderer.setCommandCaching(config.cacheCommands);
+        dynamicMask = config.dynamicState ? device.getDynamicStateCommands().supported : 0;
+        usePipelineLibrary = config.pipelineLibrary;
+        pushTransforms = config.pushTransforms;
+
+        const auto loadStart = Clock::now();
+        loadScene(config.scene);
+        metrics["load_ms"] = Milliseconds(Clock::now() - loadStart).count();
+
+        std::vector<double> frameTimes;
+        frameTimes.reserve(config.frames);
+
+        std::vector<double> sortTimes;
+        std::vector<double> transformTimes;
+
+        const vk::QueryPool statisticsQueries = createStatisticsQueries(config);
+
+        size_t frame = 0;
+        while(frame < config.warmupFrames + config.frames && !glfwWindowShouldClose(wnd))
+        {
+            glfwPollEvents();
+
+            const auto frameStart = Clock::now();
+
+            updateScene(config.scene, frame);
+
+            if(config.sortOpaque && sortedVersion != sceneVersion)
+                sortModels();
+
+            if(config.scene == BenchmarkScene::SortedDraws && frame >= config.warmupFrames)
+                sortTimes.push_back(drawQueue.getStats().sortMs);
+
+            DOT_CHECK(renderer.beginFrame());
+            if(!renderer.frameStarted())
+                continue;
+
+            // the frame's region of the object buffer is free once the frame began, all matrices go in with one copy;
+            // the scene is its only writer so the first object always lands at index 0
+
+            if(config.scene == BenchmarkScene::MovingObjects && !pushTransforms)
+            {
+                const auto uploadStart = Clock::now();
+                DOT_CHECK(renderer.getTransforms().add(objectTransforms));
+                transformMs += Milliseconds(Clock::now() - uploadStart).count();
+            }
+
+            if(config.scene == BenchmarkScene::MovingObjects && frame >= config.warmupFrames)
+                transformTimes.push_back(transformMs);
+
+            // one statistics query per measured frame, only used when commands are recorded every frame
+
+            if(config.scene == BenchmarkScene::RenderGraph)
+                DOT_CHECK(renderer.recordOffscreen([&](const vk::CommandBuffer& cmdBuffer){ graph.execute(cmdBuffer); }));
+
+            const bool measured = statisticsQueries && frame >= config.warmupFrames;
+            const auto query = static_cast<uint32_t>(frame - config.warmupFrames);
+
+            DOT_CHECK(renderer.recordScene(sceneVersion, [&](const vk::CommandBuffer& cmdBuffer)
+            {
+                if(measured)
+                    cmdBuffer.beginQuery(statisticsQueries, query, vk::QueryControlFlags());
+
+                renderScene(config.scene, cmdBuffer);
+
+                if(measured)
+                    cmdBuffer.endQuery(statisticsQueries, query);
+            }));
+            DOT_CHECK(renderer.endFrame());
+
+            if(frame >= config.warmupFrames)
+                frameTimes.push_back(Milliseconds(Clock::now() - frameStart).count());
+
+            frame++;
+        }
+
+        device.getVkDevice().waitIdle();
+
+        Statistics frameStats(frameTimes);
+        metrics["frame_ms_mean"] = frameStats.mean;
+        metrics["frame_ms_median"] = frameStats.median;
+        metrics["frame_ms_p95"] = frameStats.p95;
+        metrics["frame_ms_p99"] = frameStats.p99;
+        metrics["device_memory_peak_bytes"] = static_cast<double>(device.getPeakAllocatedMemory());
+        metrics["host_memory_peak_kb"] = hostMemoryPeakKb();
+
+        // estimated from the stored post targets, merged stages that stay in tile memory add nothing
+
+        if(renderer.getPostConfig().effects)
+            metrics["post_bytes"] = static_cast<double>(renderer.getPostTrafficBytes());
+
+        if(config.scene == BenchmarkScene::LiveResize)
+        {
+            metrics["frame_ms_max"] = frameStats.max;
+            metrics["hitch_count"] = hitchCount(frameTimes, frameStats.median);
+        }
+
+        if(config.scene == BenchmarkScene::SortedDraws)
+        {
+            const auto& queueStats = drawQueue.getStats();
+            metrics["sort_ms_median"] = Statistics(sortTimes).median;
+            metrics["binds_unsorted"] = static_cast<double>(queueStats.unsortedBinds);
+
+            // cached frames skip recording, so only a recorded frame has bind counts
+
+            if(!config.cacheCommands)
+                metrics["binds"] = static_cast<double>(queueStats.binds());
+        }
+
+        if(config.scene == BenchmarkScene::MovingObjects)
+        {
+            metrics["transform_ms_median"] = Statistics(transformTimes).median;
+            metrics["draws"] = static_cast<double>(drawQueue.getStats().draws);
+
+            if(!config.cacheCommands)
+                metrics["transform_pushes"] = static_cast<double>(drawQueue.getStats().transformPushes);
+        }
+
+        if(config.scene == BenchmarkScene::BindlessMaterials)
+        {
+            const BindlessStats bindlessStats = renderer.getBindless()->getStats();
+            metrics["bindless_descriptors"] = static_cast<double>(bindlessStats.registered[0] + bindlessStats.registered[1] + bindlessStats.registered[2]);
+
+            if(!config.cacheCommands)
+            {
+                metrics["binds"] = static_cast<double>(drawQueue.getStats().binds());
+                metrics["material_pushes"] = static_cast<double>(drawQueue.getStats().materialPushes);
+            }
+        }
+
+        if(config.scene == BenchmarkScene::RenderGraph)
+        {
+            const auto& graphStats = graph.getStats();
+            metrics["transient_bytes"] = static_cast<double>(graphStats.allocatedBytes);
+            metrics["transient_bytes_unaliased"] = static_cast<double>(graphStats.transientBytes);
+            metrics["barriers"] = static_cast<double>(graphStats.barriers);
+
+            graph.report(std::cout);
+        }
+
+        if(config.scene == BenchmarkScene::MaterialPermutations || config.scene == BenchmarkScene::ShaderVariants)
+        {
+            metrics["pipelines"] = static_cast<double>(pLibrary ? pLibrary->getStats().variants : pipelines.size());
+
+            // the worst link is the longest a first use of a variant stalls, the parts are compiled once up front
+
+            if(pLibrary)
+            {
+                const auto& libraryStats = pLibrary->getStats();
+                metrics["pipeline_parts"] = static_cast<double>(libraryStats.parts);
+                metrics["pipeline_link_ms_max"] = libraryStats.linkMsMax;
+            }
+
+            if(!config.cacheCommands)
+                metrics["binds"] = static_cast<double>(drawQueue.getStats().binds());
+        }
+
+        if(statisticsQueries)
+        {
+            readStatisticsQueries(statisticsQueries, frameStats.count, frameStats.mean * frameStats.count);
+            device.getVkDevice().destroyQueryPool(statisticsQueries);
+        }
+
+        models.clear();
+        pLibrary.reset();
+        pipelines.clear();
+        materials.clear();
+        variants.clear();
+        sceneDraws.clear();
+        drawVariants.clear();
+        objectTransforms.clear();
+        unloadBindlessMaterials();
+        drawQueue.clear();
+        graph.reset();
+        pGraphOutput.reset();
+
+        if(frameStats.count < config.frames)
+            throw DOT_RUNTIME("Benchmark interrupted before all frames were rendered!");
+
+        if(!config.resultsPath.empty())
+            writeMetrics(config.resultsPath, metrics);
+
+        return compareBaseline(config);
+    }
+
+    const BenchmarkMetrics& Benchmark::getMetrics() const noexcept
+    {
+        return metrics;
+    }
+
+    BenchmarkScene Benchmark::parseScene(const std::string& name)
+    {
+        for(auto scene : {BenchmarkScene::ManySmallModels, BenchmarkScene::LargeMesh, BenchmarkScene::HeavyInstancing, BenchmarkScene::BufferChurn, BenchmarkScene::LiveResize, BenchmarkScene::Overdraw, BenchmarkScene::SortedDraws, BenchmarkScene::RenderGraph, BenchmarkScene::MaterialPermutations, BenchmarkScene::ShaderVariants, BenchmarkScene::MovingObjects, BenchmarkScene::BindlessMaterials})
+            if(sceneName(scene) == name)
+                return scene;
+
+        throw DOT_RUNTIME("Unknown benchmark scene: " + name);
+    }
+
+    std::string Benchmark::sceneName(BenchmarkScene scene) noexcept
+    {
+        switch(scene)
+        {
+            case BenchmarkScene::ManySmallModels:       return "many_small_models";
+            case BenchmarkScene::LargeMesh:             return "large_mesh";
+            case BenchmarkScene::HeavyInstancing:       return "heavy_instancing";
+            case BenchmarkScene::BufferChurn:           return "buffer_churn";
+            case BenchmarkScene::LiveResize:            return "live_resize";
+            case BenchmarkScene::Overdraw:              return "overdraw";
+            case BenchmarkScene::SortedDraws:           return "sorted_draws";
+            case BenchmarkScene::RenderGraph:           return "render_graph";
+            case BenchmarkScene::MaterialPermutations:  return "material_permutations";
+            case BenchmarkScene::ShaderVariants:        return "shader_variants";
+            case BenchmarkScene::MovingObjects:         return "moving_objects";
+            case BenchmarkScene::BindlessMaterials:     return "bindless_materials";
+        }
+
+        return "unknown";
+    }
+
+    void Benchmark::loadScene(BenchmarkScene scene)
+    {
+        models.clear();
+        pLibrary.reset();
+        pipelines.clear();
+        materials.clear();
+        variants.clear();
+        sceneDraws.clear();
+        drawVariants.clear();
+        objectTransforms.clear();
+        instanceCount = 1;
+        sceneVersion++;
+
+        switch(scene)
+        {
+            case BenchmarkScene::ManySmallModels:
+            case BenchmarkScene::BufferChurn:
+            case BenchmarkScene::LiveResize:
+            case BenchmarkScene::RenderGraph:
+            {
+                const size_t gridSize = scene == BenchmarkScene::ManySmallModels ? 64 : 16;
+                const float cellSize = 2.0f / gridSize;
+
+                models.reserve(gridSize * gridSize);
+                for(size_t y = 0; y < gridSize; y++)
+                    for(size_t x = 0; x < gridSize; x++)
+                    {
+                        glm::vec3 color(float(x) / gridSize, float(y) / gridSize, 1.0f);
+                        models.emplace_back(std::make_unique<Model>(device, makeTriangle(-1.0f + x * cellSize, -1.0f + y * cellSize, cellSize, color)));
+                    }
+                break;
+            }
+            case BenchmarkScene::LargeMesh:
+            {
+                const size_t gridSize = 256;
+                const float cellSize = 2.0f / gridSize;
+
+                std::vector<Model::Vertex> verticies;
+                verticies.reserve(gridSize * gridSize * 6);
+
+                for(size_t y = 0; y < gridSize; y++)
+                    for(size_t x = 0; x < gridSize; x++)
+                    {
+                        glm::vec3 color(float(x) / gridSize, float(y) / gridSize, 0.5f);
+                        auto&& upper = makeTriangle(-1.0f + x * cellSize, -1.0f + y * cellSize, cellSize, color);
+                        auto&& lower = makeTriangle(-1.0f + x * cellSize, -1.0f + (y + 0.5f) * cellSize, cellSize, color);
+
+                        verticies.insert(verticies.end(), upper.begin(), upper.end());
+                        verticies.insert(verticies.end(), lower.begin(), lower.end());
+                    }
+
+                models.emplace_back(std::make_unique<Model>(device, verticies));
+                break;
+            }
+            case BenchmarkScene::HeavyInstancing:
+            {
+                models.emplace_back(std::make_unique<Model>(device, makeTriangle(-0.05f, -0.05f, 0.1f, {1.0f, 1.0f, 1.0f})));
+                instanceCount = 100000;
+                break;
+            }
+            case BenchmarkScene::Overdraw:
+            {
+                // each triangle covers the whole screen, the creation order is the worst case without sorting
+
+                const size_t layerCount = 32;
+
+                models.reserve(layerCount);
+                for(size_t i = 0; i < layerCount; i++)
+                {
+                    const float t = float(i) / (layerCount - 1);
+                    models.emplace_back(std::make_unique<Model>(device, makeTriangle(-2.5f, -3.5f, 5.0f, {t, 1.0f - t, 0.5f}, 0.9f - 0.8f * t)));
+                }
+                break;
+            }
+            case BenchmarkScene::SortedDraws:
+            {
+                // identical pipelines still count as separate binds, what matters is how often the handle changes
+
+                const size_t meshCount = 256;
+                const size_t pipelineCount = 4;
+                const size_t drawCount = 100000;
+                const float cellSize = 2.0f / 16;
+
+                std::mt19937 random(42);
+                std::uniform_real_distribution<float> depth(0.1f, 0.9f);
+
+                models.reserve(meshCount);
+                for(size_t i = 0; i < meshCount; i++)
+                {
+                    glm::vec3 color(float(i % 16) / 16, float(i / 16) / 16, 0.5f);
+                    models.emplace_back(std::make_unique<Model>(device, makeTriangle(-1.0f + (i % 16) * cellSize, -1.0f + (i / 16) * cellSize, cellSize, color, depth(random))));
+                }
+
+                PipelineConfig pipelineConfig;
+                renderer.defaultPipelineConfig(pipelineConfig);
+
+                for(size_t i = 0; i < pipelineCount; i++)
+                    pipelines.emplace_back(std::make_unique<Pipeline>(device, "engine/shaders/vert.spv", "engine/shaders/frag.spv", pipelineConfig, device.getPipelineCache()));
+
+                sceneDraws.reserve(drawCount);
+                drawQueue.reserve(drawCount);
+                for(size_t i = 0; i < drawCount; i++)
+                {
+                    const auto mesh = static_cast<uint32_t>(random() % meshCount);
+                    const auto pipeline = static_cast<uint32_t>(random() % pipelineCount);
+                    const Model* pModel = models[mesh].get();
+
+                    DrawQueue::Draw draw{pModel, 1, *pipelines[pipeline], pipelines[pipeline]->getLayout()};
+                    sceneDraws.emplace_back(DrawQueue::makeKey(0, pipeline, 0, mesh, pModel->getDepth()), draw);
+                }
+                break;
+            }
+            case BenchmarkScene::MaterialPermutations:
+            {
+                const size_t meshCount = 256;
+                const size_t drawCount = 4096;
+                const float cellSize = 2.0f / 16;
+
+                std::mt19937 random(42);
+                std::uniform_real_distribution<float> depth(0.1f, 0.9f);
+
+                models.reserve(meshCount);
+                for(size_t i = 0; i < meshCount; i++)
+                {
+                    glm::vec3 color(float(i % 16) / 16, float(i / 16) / 16, 0.5f);
+                    models.emplace_back(std::make_unique<Model>(device, makeTriangle(-1.0f + (i % 16) * cellSize, -1.0f + (i / 16) * cellSize, cellSize, color, depth(random))));
+                }
+
+                loadMaterials();
+
+                // materials whose only differences are dynamic share a pipeline, the registry maps baked state to it;
+                // with a pipeline library a new entry is a link of shared parts instead of a full compile
+
+                const auto compileStart = Clock::now();
+
+                if(usePipelineLibrary)
+                    pLibrary = std::make_unique<PipelineLibrary>(device, [this](PipelineConfig& pipelineConfig){ renderer.defaultPipelineConfig(pipelineConfig); }, dynamicMask, device.getPipelineCache());
+
+                std::map<uint64_t, uint32_t> registry;
+                std::vector<vk::Pipeline> handles;
+                std::vector<uint32_t> materialPipelines;
+                materialPipelines.reserve(materials.size());
+
+                for(const auto& material : materials)
+                {
+                    auto [it, inserted] = registry.try_emplace(material.key(dynamicMask), static_cast<uint32_t>(handles.size()));
+                    if(inserted && pLibrary)
+                    {
+                        variants.emplace_back(material, ShaderFeatures());
+                        handles.push_back(getVariant(variants.size() - 1));
+                    }
+                    else if(inserted)
+                    {
+                        PipelineConfig pipelineConfig;
+                        renderer.defaultPipelineConfig(pipelineConfig);
+                        Pipeline::drawStateConfig(pipelineConfig, material);
+                        Pipeline::dynamicStateConfig(pipelineConfig, dynamicMask);
+
+                        pipelines.emplace_back(std::make_unique<Pipeline>(device, "engine/shaders/vert.spv", "engine/shaders/frag.spv", pipelineConfig, device.getPipelineCache()));
+                        handles.push_back(*pipelines.back());
+                    }
+
+                    materialPipelines.push_back(it->second);
+                }
+
+                metrics["pipeline_compile_ms"] = Milliseconds(Clock::now() - compileStart).count();
+
+                const vk::PipelineLayout layout = pLibrary ? pLibrary->getLayout() : pipelines.front()->getLayout();
+
+                sceneDraws.reserve(drawCount);
+                drawQueue.reserve(drawCount);
+                for(size_t i = 0; i < drawCount; i++)
+                {
+                    const auto mesh = static_cast<uint32_t>(random() % meshCount);
+                    const auto material = static_cast<uint32_t>(random() % materials.size());
+                    const uint32_t pipeline = materialPipelines[material];
+                    const Model* pModel = models[mesh].get();
+
+                    DrawQueue::Draw draw{pModel, 1, handles[pipeline], layout, {}, dynamicMask, &materials[material]};
+                    sceneDraws.emplace_back(DrawQueue::makeKey(0, pipeline, material, mesh, pModel->getDepth()), draw);
+                    drawVariants.push_back(pipeline);
+                }
+                break;
+            }
+            case BenchmarkScene::ShaderVariants:
+            {
+                const size_t meshCount = 256;
+                const size_t drawCount = 4096;
+                const float cellSize = 2.0f / 16;
+
+                std::mt19937 random(42);
+                std::uniform_real_distribution<float> depth(0.1f, 0.9f);
+
+                models.reserve(meshCount);
+                for(size_t i = 0; i < meshCount; i++)
+                {
+                    glm::vec3 color(float(i % 16) / 16, float(i / 16) / 16, 0.5f);
+                    models.emplace_back(std::make_unique<Model>(device, makeTriangle(-1.0f + (i % 16) * cellSize, -1.0f + (i / 16) * cellSize, cellSize, color, depth(random))));
+                }
+
+                // one pair of shaders, every feature combination is a specialized variant compiled on first request
+
+                for(bool vertexColor : {true, false})
+                    for(bool alphaTest : {false, true})
+                        for(uint32_t lightCount : {0, 1, 4, 8})
+                        {
+                            ShaderFeatures features;
+                            features.vertexColor = vertexColor;
+                            features.alphaTest = alphaTest;
+                            features.lightCount = lightCount;
+
+                            variants.emplace_back(DrawState(), features);
+                        }
+
+                const auto compileStart = Clock::now();
+
+                pLibrary = std::make_unique<PipelineLibrary>(device, [this](PipelineConfig& pipelineConfig){ renderer.defaultPipelineConfig(pipelineConfig); }, 0, device.getPipelineCache(), usePipelineLibrary);
+
+                sceneDraws.reserve(drawCount);
+                drawQueue.reserve(drawCount);
+                for(size_t i = 0; i < drawCount; i++)
+                {
+                    const auto mesh = static_cast<uint32_t>(random() % meshCount);
+                    const auto variant = static_cast<uint32_t>(random() % variants.size());
+                    const Model* pModel = models[mesh].get();
+
+                    DrawQueue::Draw draw{pModel, 1, getVariant(variant), pLibrary->getLayout()};
+                    sceneDraws.emplace_back(DrawQueue::makeKey(0, variant, 0, mesh, pModel->getDepth()), draw);
+                    drawVariants.push_back(variant);
+                }
+
+                metrics["pipeline_compile_ms"] = Milliseconds(Clock::now() - compileStart).count();
+                break;
+            }
+            case BenchmarkScene::MovingObjects:
+            {
+                // objects are grouped by mesh, with the object buffer a mesh is one instanced draw over its consecutive
+                // matrices; pushed, every object is its own draw carrying its matrix in the command buffer
+
+                const size_t meshCount = 16;
+                const size_t objectsPerMesh = 6250;
+
+                models.reserve(meshCount);
+                for(size_t i = 0; i < meshCount; i++)
+                {
+                    glm::vec3 color(float(i % 4) / 4, float(i / 4) / 4, 1.0f);
+                    models.emplace_back(std::make_unique<Model>(device, makeTriangle(-0.004f, -0.004f, 0.008f, color)));
+                }
+
+                objectTransforms.assign(meshCount * objectsPerMesh, glm::mat4(1.0f));
+
+                ShaderFeatures features;
+                features.objectBuffer = !pushTransforms;
+
+                PipelineConfig pipelineConfig;
+                renderer.defaultPipelineConfig(pipelineConfig);
+                Pipeline::featureConfig(pipelineConfig, features);
+
+                pipelines.emplace_back(std::make_unique<Pipeline>(device, "engine/shaders/vert.spv", "engine/shaders/frag.spv", pipelineConfig, device.getPipelineCache()));
+
+                const Pipeline& pipeline = *pipelines.front();
+                const size_t drawCount = pushTransforms ? objectTransforms.size() : meshCount;
+
+                sceneDraws.reserve(drawCount);
+                drawQueue.reserve(drawCount);
+                for(size_t mesh = 0; mesh < meshCount; mesh++)
+                {
+                    const auto first = static_cast<uint32_t>(mesh * objectsPerMesh);
+
+                    if(!pushTransforms)
+                    {
+                        DrawQueue::Draw draw{models[mesh].get(), static_cast<uint32_t>(objectsPerMesh), pipeline, pipeline.getLayout()};
+                        draw.objectIndex = first;
+                        sceneDraws.emplace_back(DrawQueue::makeKey(0, 0, 0, static_cast<uint32_t>(mesh), 0.5f), draw);
+                        continue;
+                    }
+
+                    for(uint32_t object = first; object < first + objectsPerMesh; object++)
+                    {
+                        DrawQueue::Draw draw{models[mesh].get(), 1, pipeline, pipeline.getLayout()};
+                        draw.pTransform = &objectTransforms[object];
+                        sceneDraws.emplace_back(DrawQueue::makeKey(0, 0, 0, static_cast<uint32_t>(mesh), 0.5f), draw);
+                    }
+                }
+                break;
+            }
+            case BenchmarkScene::BindlessMaterials:
+            {
+                Bindless* pBindless = renderer.getBindless();
+                if(!pBindless)
+                    throw DOT_RUNTIME("The bindless_materials scene needs a device with descriptor indexing!");
+
+                const size_t meshCount = 256;
+                const size_t drawCount = 4096;
+                const float cellSize = 2.0f / 16;
+
+                std::mt19937 random(42);
+                std::uniform_real_distribution<float> depth(0.1f, 0.9f);
+
+                models.reserve(meshCount);
+                for(size_t i = 0; i < meshCount; i++)
+                {
+                    glm::vec3 color(1.0f, 1.0f, float(i % 16) / 16);
+                    models.emplace_back(std::make_unique<Model>(device, makeTriangle(-1.0f + (i % 16) * cellSize, -1.0f + (i / 16) * cellSize, cellSize, color, depth(random))));
+                }
+
+                loadBindlessMaterials(*pBindless, 64, 256);
+
+                PipelineConfig pipelineConfig;
+                renderer.defaultPipelineConfig(pipelineConfig);
+                Pipeline::bindlessConfig(pipelineConfig, Bindless::set, pBindless->getSetLayout());
+
+                pipelines.emplace_back(std::make_unique<Pipeline>(device, "engine/shaders/bindless_vert.spv", "engine/shaders/bindless_frag.spv", pipelineConfig, device.getPipelineCache()));
+
+                // materials differ only in the index the draw pushes, the key leaves them out and draws of any material
+                // stay batched by mesh
+
+                const Pipeline& pipeline = *pipelines.front();
+
+                sceneDraws.reserve(drawCount);
+                drawQueue.reserve(drawCount);
+                for(size_t i = 0; i < drawCount; i++)
+                {
+                    const auto mesh = static_cast<uint32_t>(random() % meshCount);
+                    const auto material = static_cast<uint32_t>(random() % bindlessMaterials.size());
+                    const Model* pModel = models[mesh].get();
+
+                    DrawQueue::Draw draw{pModel, 1, pipeline, pipeline.getLayout(), pBindless->getSet()};
+                    draw.materialIndex = bindlessMaterials[material];
+                    sceneDraws.emplace_back(DrawQueue::makeKey(0, 0, 0, mesh, pModel->getDepth()), draw);
+                }
+                break;
+            }
+        }
+
+        if(scene == BenchmarkScene::RenderGraph)
+            buildGraph();
+    }
+
+    vk::Pipeline Benchmark::getVariant(size_t variant)
+    {
+        const auto& [state, features] = variants[variant];
+        return pLibrary->get("engine/shaders/vert.spv", "engine/shaders/frag.spv", state, features);
+    }
+
+    void Benchmark::moveObjects(size_t frame) noexcept
+    {
+        // every object circles around its own spot on a grid covering the screen, spinning at its own rate
+
+        const size_t gridSize = 320;
+        const float cellSize = 2.0f / gridSize;
+        const float time = frame / 60.0f;
+
+        for(size_t i = 0; i < objectTransforms.size(); i++)
+        {
+            const float phase = time + float(i % 97) * 0.1f;
+            const float angle = phase * (1.0f + float(i % 7));
+            const float c = std::cos(angle);
+            const float s = std::sin(angle);
+
+            glm::mat4& model = objectTransforms[i];
+            model[0] = glm::vec4(c, s, 0.0f, 0.0f);
+            model[1] = glm::vec4(-s, c, 0.0f, 0.0f);
+            model[3] = glm::vec4
+            (
+                -1.0f + (i % gridSize + 0.5f) * cellSize + 0.3f * cellSize * std::cos(phase),
+                -1.0f + (i / gridSize + 0.5f) * cellSize + 0.3f * cellSize * std::sin(phase),
+                0.0f, 1.0f
+            );
+        }
+    }
+
+    void Benchmark::loadBindlessMaterials(Bindless& bindless, size_t textureCount, size_t materialCount)
+    {
+        // small checkered textures in distinct colors, uploaded once and registered at the next free image index
+
+        const vk::Extent2D extent(16, 16);
+        const vk::DeviceSize textureSize = vk::DeviceSize(extent.width) * extent.height * 4;
+
+        Buffer stagingBuffer(device, textureSize, 1, vk::BufferUsageFlagBits::eTransferSrc, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+        DOT_CHECK(stagingBuffer.map());
+
+        std::vector<uint8_t> texels(textureSize);
+        std::vector<uint32_t> textureIndices;
+
+        textures.reserve(textureCount);
+        for(size_t i = 0; i < textureCount; i++)
+        {
+            const uint8_t color[] = {uint8_t(i * 37), uint8_t(i * 91), uint8_t(i * 53), 255};
+
+            for(uint32_t y = 0; y < extent.height; y++)
+                for(uint32_t x = 0; x < extent.width; x++)
+                    for(size_t channel = 0; channel < 4; channel++)
+                        texels[(y * extent.width + x) * 4 + channel] = (x / 4 + y / 4) % 2 ? color[channel] : 255;
+
+            DOT_CHECK(stagingBuffer.write(texels.data(), textureSize));
+
+            textures.emplace_back(std::make_unique<Image>
+            (
+                device, extent, vk::Format::eR8G8B8A8Unorm,
+                vk::ImageUsageFlagBits::eSampled | vk::ImageUsageFlagBits::eTransferDst, vk::MemoryPropertyFlagBits::eDeviceLocal,
+                vk::ImageAspectFlagBits::eColor
+            ));
+            DOT_CHECK(device.copyBufferToImage(stagingBuffer, *textures.back(), extent));
+
+            auto index = bindless.addImage(textures.back()->getView());
+            DOT_CHECK(index);
+            bindlessIndices.emplace_back(BindlessType::SampledImage, index.value());
+            textureIndices.push_back(index.value());
+        }
+
+        // nearest and linear filtering, each repeating and mirrored
+
+        std::vector<uint32_t> samplerIndices;
+
+        for(auto filter : {vk::Filter::eNearest, vk::Filter::eLinear})
+            for(auto addressMode : {vk::SamplerAddressMode::eRepeat, vk::SamplerAddressMode::eMirroredRepeat})
+            {
+                vk::SamplerCreateInfo createInfo;
+                createInfo.magFilter = filter;
+                createInfo.minFilter = filter;
+                createInfo.addressModeU = addressMode;
+                createInfo.addressModeV = addressMode;
+                createInfo.addressModeW = addressMode;
+
+                try
+                {
+                    samplers.push_back(device.getVkDevice().createSampler(createInfo));
+                }
+                catch(const std::runtime_error& e)
+                {
+                    throw DOT_RUNTIME_WHAT(e);
+                }
+
+                auto index = bindless.addSampler(samplers.back());
+                DOT_CHECK(index);
+                bindlessIndices.emplace_back(BindlessType::Sampler, index.value());
+                samplerIndices.push_back(index.value());
+            }
+
+        // one buffer holds every material, each registered as its own range so the material index is the buffer index
+
+        struct MaterialData
+        {
+            glm::vec4 color;
+            uint32_t texture;
+            uint32_t sampler;
+            uint32_t padding[2];    // std430 rounds the struct up to the alignment of its vec4
+        };
+
+        const vk::DeviceSize alignment = device.getLimits().minStorageBufferOffsetAlignment;
+        const vk::DeviceSize stride = (sizeof(MaterialData) + alignment - 1) / alignment * alignment;
+
+        pMaterialBuffer = std::make_unique<Buffer>(device, stride, materialCount, vk::BufferUsageFlagBits::eStorageBuffer, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent);
+        DOT_CHECK(pMaterialBuffer->map());
+
+        bindlessMaterials.reserve(materialCount);
+        for(size_t i = 0; i < materialCount; i++)
+        {
+            MaterialData material{};
+            material.color = glm::vec4(1.0f - float(i % 4) * 0.2f, 1.0f, 1.0f - float(i % 8) * 0.1f, 1.0f);
+            material.texture = textureIndices[i % textureIndices.size()];
+            material.sampler = samplerIndices[i % samplerIndices.size()];
+
+            DOT_CHECK(pMaterialBuffer->write(&material, sizeof(material), i * stride));
+
+            auto index = bindless.addBuffer(*pMaterialBuffer, i * stride, stride);
+            DOT_CHECK(index);
+            bindlessIndices.emplace_back(BindlessType::StorageBuffer, index.value());
+            bindlessMaterials.push_back(index.value());
+        }
+    }
+
+    void Benchmark::unloadBindlessMaterials() noexcept
+    {
+        // the device is idle once a run finished, the indices are free for whoever registers next
+
+        if(Bindless* pBindless = renderer.getBindless())
+            for(const auto& [type, index] : bindlessIndices)
+                pBindless->remove(type, index);
+
+        for(const auto& sampler : samplers)
+            device.getVkDevice().destroySampler(sampler);
+
+        bindlessIndices.clear();
+        bindlessMaterials.clear();
+        samplers.clear();
+        textures.clear();
+        pMaterialBuffer.reset();
+    }
+
+    void Benchmark::loadMaterials()
+    {
+        // 3 cull modes, 2 windings, depth test on and off, 2 compare ops, blending on and off
+
+        const vk::CullModeFlagBits cullModes[] = {vk::CullModeFlagBits::eNone, vk::CullModeFlagBits::eBack, vk::CullModeFlagBits::eFront};
+        const vk::FrontFace frontFaces[] = {vk::FrontFace::eClockwise, vk::FrontFace::eCounterClockwise};
+        const vk::CompareOp compareOps[] = {vk::CompareOp::eLess, vk::CompareOp::eLessOrEqual};
+
+        materials.clear();
+        for(auto cullMode : cullModes)
+            for(auto frontFace : frontFaces)
+                for(bool depthTest : {true, false})
+                    for(auto compareOp : compareOps)
+                        for(bool blend : {false, true})
+                        {
+                            DrawState state;
+                            state.cullMode = cullMode;
+                            state.frontFace = frontFace;
+                            state.depthTest = depthTest;
+                            state.depthWrite = depthTest && !blend;
+                            state.depthCompare = compareOp;
+                            state.blend = blend;
+
+                            materials.push_back(state);
+                        }
+    }
+
+    void Benchmark::updateScene(BenchmarkScene scene, size_t frame)
+    {
+        // optimized links finishing in the background replace the fast linked handles the draws hold
+
+        if(pLibrary && pLibrary->update())
+        {
+            for(size_t i = 0; i < sceneDraws.size(); i++)
+                sceneDraws[i].second.pipeline = getVariant(drawVariants[i]);
+
+            sceneVersion++;
+        }
+
+        if(scene == BenchmarkScene::MovingObjects)
+        {
+            const auto moveStart = Clock::now();
+            moveObjects(frame);
+            transformMs = Milliseconds(Clock::now() - moveStart).count();
+
+            // pushed matrices are part of the recorded commands, cached commands would keep drawing the old ones
+
+            if(pushTransforms)
+                sceneVersion++;
+        }
+
+        if(usesDrawQueue(scene))
+        {
+            // the draw list is rebuilt and sorted every frame like an engine collecting visible objects
+
+            drawQueue.clear();
+            for(const auto& [key, draw] : sceneDraws)
+                drawQueue.push(key, draw);
+
+            drawQueue.sort();
+            return;
+        }
+
+        if(scene == BenchmarkScene::LiveResize)
+        {
+            // sweeps the size back and forth, every frame sees a new extent like during a window drag
+
+            const int step = static_cast<int>(frame % 128);
+            const int offset = step < 64 ? step : 128 - step;
+            glfwSetWindowSize(wnd, 640 + offset * 4, 480 + offset * 3);
+            return;
+        }
+
+        if(scene != BenchmarkScene::BufferChurn)
+            return;
+
+        // replaces a rotating slice of the models, every model gets recreated once per 16 frames
+
+        sceneVersion++;
+
+        const size_t sliceSize = models.size() / 16;
+        const size_t first = (frame % 16) * sliceSize;
+
+        for(size_t i = first; i < first + sliceSize; i++)
+        {
+            const float offset = (frame % 2) * 0.01f;
+            models[i] = std::make_unique<Model>(device, makeTriangle(-1.0f + offset, -1.0f + offset, 0.1f, {0.0f, 1.0f, 0.0f}));
+        }
+    }
+
+    void Benchmark::renderScene(BenchmarkScene scene, const vk::CommandBuffer& cmdBuffer) noexcept
+    {
+        if(usesDrawQueue(scene))
+        {
+            drawQueue.record(cmdBuffer, &device.getDynamicStateCommands());
+            return;
+        }
+
+        for(const auto& model : models)
+        {
+            model->bind(cmdBuffer);
+            model->draw(cmdBuffer, instanceCount);
+        }
+    }
+
+    void Benchmark::sortModels() noexcept
+    {
+        // front to back, stable so models at equal depth keep their draw order
+
+        std::stable_sort(models.begin(), models.end(), [](const auto& a, const auto& b){ return a->getDepth() < b->getDepth(); });
+        sortedVersion = sceneVersion;
+    }
+
+    void Benchmark::buildGraph()
+    {
+        // the passes only clear, the graph's own work is what is measured: barriers, layout transitions,
+        // attachment load and store, and the memory of the transient targets
+
+        graph.reset();
+
+        const vk::Extent2D extent(1280, 720);
+        const vk::Extent2D halfExtent(640, 360);
+        const vk::Format colorFormat = vk::Format::eR8G8B8A8Unorm;
+        const vk::Format hdrFormat = vk::Format::eR16G16B16A16Sfloat;
+        const vk::Format depthFormat = device.getDepthFormat();
+
+        pGraphOutput = std::make_unique<Image>
+        (
+            device, extent, colorFormat,
+            vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eSampled, vk::MemoryPropertyFlagBits::eDeviceLocal,
+            vk::ImageAspectFlagBits::eColor
+        );
+
+        const auto output = graph.importImage
+        (
+            "output", *pGraphOutput, pGraphOutput->getView(), {colorFormat, extent},
+            vk::ImageLayout::eUndefined, vk::ImageLayout::eShaderReadOnlyOptimal
+        );
+
+        dot::RenderGraph::ResourceId albedo, normal, depth, lit, bloom;
+
+        graph.addPass("gbuffer", [&](auto& pass)
+        {
+            albedo = pass.create("albedo", {colorFormat, extent});
+            normal = pass.create("normal", {hdrFormat, extent});
+            depth = pass.create("depth", {depthFormat, extent});
+            pass.write(albedo);
+            pass.write(normal);
+            pass.write(depth, RenderGraphAccess::DepthAttachment);
+        }, nullptr);
+
+        graph.addPass("lighting", [&](auto& pass)
+        {
+            pass.read(albedo);
+            pass.read(normal);
+            pass.read(depth);
+            lit = pass.create("lit", {hdrFormat, extent});
+            pass.write(lit);
+        }, nullptr);
+
+        graph.addPass("bloom", [&](auto& pass)
+        {
+            pass.read(lit);
+            bloom = pass.create("bloom", {hdrFormat, halfExtent});
+            pass.write(bloom);
+        }, nullptr);
+
+        // nothing reads its output, culled
+
+        graph.addPass("debug_normals", [&](auto& pass)
+        {
+            pass.read(normal);
+            pass.write(pass.create("debug", {colorFormat, extent}));
+        }, nullptr);
+
+        graph.addPass("tonemap", [&](auto& pass)
+        {
+            pass.read(lit);
+            pass.read(bloom);
+            pass.write(output);
+        }, nullptr);
+
+        graph.compile();
+    }
+
+    vk::QueryPool Benchmark::createStatisticsQueries(const BenchmarkConfig& config) const
+    {
+        // fragment shader invocations measure overdraw, needs the feature and host reset for the whole pool
+
+        if(config.cacheCommands || !device.getEnabledFeatures().pipelineStatisticsQuery || !device.getEnabledFeatures12().hostQueryReset)
+            return nullptr;
+
+        vk::QueryPoolCreateInfo createInfo
+        (
+            vk::QueryPoolCreateFlags(0U),                                       // flags
+            vk::QueryType::ePipelineStatistics,                                 // queryType
+            static_cast<uint32_t>(config.frames),                               // queryCount
+            vk::QueryPipelineStatisticFlagBits::eFragmentShaderInvocations      // pipelineStatistics
+        );
+
+        try
+        {
+            vk::QueryPool queryPool = device.getVkDevice().createQueryPool(createInfo);
+            device.getVkDevice().resetQueryPool(queryPool, 0, createInfo.queryCount);
+            return queryPool;
+        }
+        catch(const std::runtime_error& e)
+        {
+            throw DOT_RUNTIME_WHAT(e);
+        }
+    }
+
+    void Benchmark::readStatisticsQueries(const vk::QueryPool& queryPool, size_t queryCount, double frameMsTotal)
+    {
+        if(!queryCount)
+            return;
+
+        std::vector<uint64_t> invocations(queryCount);
+
+        const VkResult result = vkGetQueryPoolResults(device.getVkDevice(), queryPool, 0, static_cast<uint32_t>(queryCount),
+            invocations.size() * sizeof(uint64_t), invocations.data(), sizeof(uint64_t), VK_QUERY_RESULT_64_BIT | VK_QUERY_RESULT_WAIT_BIT);
+
+        if(result != VK_SUCCESS)
+            throw DOT_RUNTIME("Failed to read pipeline statistics!");
+
+        double fragments = 0.0;
+        for(uint64_t count : invocations)
+            fragments += static_cast<double>(count);
+
+        int width = 0, height = 0;
+        glfwGetFramebufferSize(wnd, &width, &height);
+
+        // both are costs, overdraw is shaded fragments per pixel, the other the inverse of fill rate
+
+        if(width && height)
+            metrics["overdraw"] = fragments / queryCount / (double(width) * height);
+
+        if(fragments > 0.0)
+            metrics["ns_per_fragment"] = frameMsTotal * 1e6 / fragments;
+    }
+
+    BenchmarkResult Benchmark::compareBaseline(const BenchmarkConfig& config) const
+    {
+        if(config.baselinePath.empty())
+            return BenchmarkResult::Passed;
+
+        if(config.recordBaseline)
+        {
+            std::cout << "Recording baseline " << config.baselinePath << '\n';
+            writeMetrics(config.baselinePath, metrics);
+            return BenchmarkResult::Passed;
+        }
+
+        // baselines belong to the machine and driver they were recorded with, a checkout without one has nothing to
+        // compare against and reports the run as skipped instead of passed
+
+        if(!std::ifstream(config.baselinePath))
+        {
+            std::cout << "Skipping the comparison, no baseline at " << config.baselinePath << ", record one with --record-baseline\n";
+            return BenchmarkResult::Skipped;
+        }
+
+        bool passed = true;
+        for(const auto& [name, baseline] : readMetrics(config.baselinePath))
+        {
+            auto metric = metrics.find(name);
+            if(metric == metrics.end())
+                continue;
+
+            // a zero baseline has no tolerance to scale, it only says the scene did not measure the metric
+
+            if(baseline == 0.0)
+                continue;
+
+            // every metric is a cost, so only an increase counts as a regression
+
+            const double limit = baseline * (1.0 + config.tolerance);
+            if(metric->second > limit)
+            {
+                std::cerr << "Regression in " << sceneName(config.scene) << ": " << name << " = " << metric->second
+                          << " (baseline " << baseline << ", limit " << limit << ")\n";
+                passed = false;
+            }
+        }
+
+        return passed ? BenchmarkResult::Passed : BenchmarkResult::Regressed;
+    }
+
+    double Benchmark::hitchCount(const std::vector<double>& frameTimes, double median) noexcept
+    {
+        // a hitch is a frame taking more than twice the median, what a stall on resize shows up as
+
+        double count = 0.0;
+        for(double frameTime : frameTimes)
+            if(frameTime > 2.0 * median)
+                count++;
+
+        return count;
+    }
+
+    bool Benchmark::usesDrawQueue(BenchmarkScene scene) noexcept
+    {
+        return scene == BenchmarkScene::SortedDraws || scene == BenchmarkScene::MaterialPermutations || scene == BenchmarkScene::ShaderVariants ||
+               scene == BenchmarkScene::MovingObjects || scene == BenchmarkScene::BindlessMaterials;
+    }
+
+    std::vector<Model::Vertex> Benchmark::makeTriangle(float x, float y, float size, const glm::vec3& color, float depth) noexcept
+    {
+        return
+        {
+            {{x + size * 0.5f, y, depth}, color},
+            {{x + size, y + size, depth}, color},
+            {{x, y + size, depth}, color}
+        };
+    }
+
+    BenchmarkMetrics Benchmark::readMetrics(const std::string& path)
+    {
+        std::ifstream file(path);
+
+        if(!file)
+            throw DOT_RUNTIME("Failed to open the file: " + path);
+
+        BenchmarkMetrics metrics;
+        std::string line;
+        while(std::getline(file, line))
+        {
+            std::istringstream iss(line);
+            std::string name;
+            double value;
+
+            if(line.empty() || line.front() == '#')
+                continue;
+
+            if(iss >> name >> value)
+                metrics[name] = value;
+        }
+
+        return metrics;
+    }
+
+    void Benchmark::writeMetrics(const std::string& path, const BenchmarkMetrics& metrics)
+    {
+        std::ofstream file(path, std::ios::trunc);
+
+        if(!file)
+            throw DOT_RUNTIME("Failed to open the file: " + path);
+
+        for(const auto& [name, value] : metrics)
+            file << name << ' ' << value << '\n';
+    }
+
+    double Benchmark::hostMemoryPeakKb() noexcept
+    {
+        #if defined(__unix__) || defined(__APPLE__)
+            rusage usage = {};
+            getrusage(RUSAGE_SELF, &usage);
+            #ifdef __APPLE__
+                return usage.ru_maxrss / 1024.0; // reported in bytes on macOS
+            #else
+                return static_cast<double>(usage.ru_maxrss);
+            #endif
+        #else
+            return 0.0;
+        #endif
+    }
+}
\ No newline at end of file
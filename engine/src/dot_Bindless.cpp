@@ -0,0 +1,206 @@
+#include "dot_Bindless.h"
+#include "dot_Exception.h"
+
+#include <algorithm>
+
+namespace dot
+{
+    static constexpr vk::DescriptorType bindlessTypes[] = {vk::DescriptorType::eSampledImage, vk::DescriptorType::eSampler, vk::DescriptorType::eStorageBuffer};
+
+    Bindless::Bindless(Device& device, uint32_t maxImages, uint32_t maxSamplers, uint32_t maxBuffers)
+        : device(device)
+    {
+        if(!device.descriptorIndexingEnabled())
+            throw DOT_RUNTIME("Bindless resources need descriptor indexing, the device does not support it!");
+
+        // the arrays are sized once, within what the device allows for sets written after binding
+
+        const vk::PhysicalDeviceVulkan12Properties properties = device.getProperties12();
+
+        slots[uint32_t(BindlessType::SampledImage)].capacity = std::min
+        ({
+            maxImages, properties.maxDescriptorSetUpdateAfterBindSampledImages, properties.maxPerStageDescriptorUpdateAfterBindSampledImages
+        });
+        slots[uint32_t(BindlessType::Sampler)].capacity = std::min
+        ({
+            maxSamplers, properties.maxDescriptorSetUpdateAfterBindSamplers, properties.maxPerStageDescriptorUpdateAfterBindSamplers
+        });
+        slots[uint32_t(BindlessType::StorageBuffer)].capacity = std::min
+        ({
+            maxBuffers, properties.maxDescriptorSetUpdateAfterBindStorageBuffers, properties.maxPerStageDescriptorUpdateAfterBindStorageBuffers
+        });
+
+        createSet();
+    }
+
+    Bindless::~Bindless()
+    {
+        device.getVkDevice().destroyDescriptorPool(pool);
+    }
+
+    Result<uint32_t> Bindless::addImage(const vk::ImageView& view, vk::ImageLayout layout) noexcept
+    {
+        auto index = acquire(BindlessType::SampledImage);
+        DOT_TRY(index);
+
+        write(BindlessType::SampledImage, index.value(), DescriptorInfo::fromImage({}, view, layout));
+        return index;
+    }
+
+    Result<uint32_t> Bindless::addSampler(const vk::Sampler& sampler) noexcept
+    {
+        auto index = acquire(BindlessType::Sampler);
+        DOT_TRY(index);
+
+        write(BindlessType::Sampler, index.value(), DescriptorInfo::fromImage(sampler, {}, vk::ImageLayout::eUndefined));
+        return index;
+    }
+
+    Result<uint32_t> Bindless::addBuffer(const vk::Buffer& buffer, vk::DeviceSize offset, vk::DeviceSize range) noexcept
+    {
+        auto index = acquire(BindlessType::StorageBuffer);
+        DOT_TRY(index);
+
+        write(BindlessType::StorageBuffer, index.value(), DescriptorInfo::fromBuffer(buffer, offset, range));
+        return index;
+    }
+
+    void Bindless::remove(BindlessType type, uint32_t index) noexcept
+    {
+        // the descriptor is left as it is, partially bound arrays only have to be valid where shaders read them.
+        // The frame being recorded may still read the index, so it is free only after the next frame submission
+
+        slots[uint32_t(type)].released.emplace_back(index, pendingFrame);
+        removals++;
+    }
+
+    void Bindless::frameSubmitted(uint64_t timelineValue) noexcept
+    {
+        for(Slots& typeSlots : slots)
+            for(auto& [index, value] : typeSlots.released)
+                if(value == pendingFrame)
+                    value = timelineValue;
+    }
+
+    void Bindless::bind(const vk::CommandBuffer& cmdBuffer, const vk::PipelineLayout& layout) const noexcept
+    {
+        cmdBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, layout, set, descriptorSet, {});
+    }
+
+    const vk::DescriptorSetLayout& Bindless::getSetLayout() const noexcept
+    {
+        return setLayout;
+    }
+
+    const vk::DescriptorSet& Bindless::getSet() const noexcept
+    {
+        return descriptorSet;
+    }
+
+    BindlessStats Bindless::getStats() const noexcept
+    {
+        BindlessStats stats;
+        stats.writes = writes;
+
+        for(size_t i = 0; i < slots.size(); i++)
+        {
+            stats.registered[i] = slots[i].next - static_cast<uint32_t>(slots[i].free.size() + slots[i].released.size());
+            stats.capacity[i] = slots[i].capacity;
+            stats.pendingReleases += slots[i].released.size();
+        }
+
+        return stats;
+    }
+
+    uint64_t Bindless::getRemovals() const noexcept
+    {
+        return removals;
+    }
+
+    void Bindless::createSet()
+    {
+        // every index may be written while the set is bound in commands still executing, as long as they do not read it
+
+        std::vector<vk::DescriptorSetLayoutBinding> bindings;
+        std::vector<vk::DescriptorBindingFlags> bindingFlags;
+        std::vector<vk::DescriptorPoolSize> poolSizes;
+
+        for(uint32_t i = 0; i < slots.size(); i++)
+        {
+            bindings.emplace_back(i, bindlessTypes[i], slots[i].capacity, vk::ShaderStageFlagBits::eAll);
+            bindingFlags.push_back
+            (
+                vk::DescriptorBindingFlagBits::ePartiallyBound |
+                vk::DescriptorBindingFlagBits::eUpdateAfterBind |
+                vk::DescriptorBindingFlagBits::eUpdateUnusedWhilePending
+            );
+            poolSizes.emplace_back(bindlessTypes[i], slots[i].capacity);
+        }
+
+        setLayout = device.getLayoutCache().getSetLayout(bindings, vk::DescriptorSetLayoutCreateFlagBits::eUpdateAfterBindPool, bindingFlags);
+
+        try
+        {
+            pool = device.getVkDevice().createDescriptorPool({vk::DescriptorPoolCreateFlagBits::eUpdateAfterBind, 1, poolSizes});
+            descriptorSet = device.getVkDevice().allocateDescriptorSets({pool, setLayout}).front();
+        }
+        catch(const std::runtime_error& e)
+        {
+            throw DOT_RUNTIME_WHAT(e);
+        }
+    }
+
+    Result<uint32_t> Bindless::acquire(BindlessType type) noexcept
+    {
+        // removed indices come back once the gpu is past every frame that could still read them
+
+        Slots& typeSlots = slots[uint32_t(type)];
+
+        if(!typeSlots.released.empty())
+        {
+            const uint64_t completed = device.getCompletedTimelineValue();
+
+            auto pending = std::partition(typeSlots.released.begin(), typeSlots.released.end(), [completed](const auto& released)
+            {
+                return released.second > completed;
+            });
+
+            for(auto it = pending; it != typeSlots.released.end(); it++)
+                typeSlots.free.push_back(it->first);
+
+            typeSlots.released.erase(pending, typeSlots.released.end());
+        }
+
+        if(!typeSlots.free.empty())
+        {
+            const uint32_t index = typeSlots.free.back();
+            typeSlots.free.pop_back();
+            return index;
+        }
+
+        if(typeSlots.next == typeSlots.capacity)
+            return Error{vk::Result::eErrorOutOfPoolMemory, "Bindless array is full!"};
+
+        return typeSlots.next++;
+    }
+
+    void Bindless::write(BindlessType type, uint32_t index, const DescriptorInfo& info) noexcept
+    {
+        // using vulkan c api to prevent from throwing an exception
+
+        VkWriteDescriptorSet descriptorWrite
+        {
+            .sType = VK_STRUCTURE_TYPE_WRITE_DESCRIPTOR_SET,
+            .dstSet = descriptorSet,
+            .dstBinding = uint32_t(type),
+            .dstArrayElement = index,
+            .descriptorCount = 1,
+            .descriptorType = static_cast<VkDescriptorType>(bindlessTypes[uint32_t(type)]),
+            .pImageInfo = type == BindlessType::StorageBuffer ? nullptr : &info.image,
+            .pBufferInfo = type == BindlessType::StorageBuffer ? &info.buffer : nullptr
+        };
+
+        vkUpdateDescriptorSets(device.getVkDevice(), 1, &descriptorWrite, 0, nullptr);
+        writes++;
+    }
+}
\ No newline at end of file
@@ -26,10 +26,18 @@ namespace dot
         return buffer;
     }
 
-    void Buffer::map(const vk::DeviceSize& size, const vk::DeviceSize& offset) noexcept
+    Result<> Buffer::map(const vk::DeviceSize& size, const vk::DeviceSize& offset) noexcept
     {
+        // using vulkan c api to prevent from throwing an exception
+
         if(!data)
-            data = device.getVkDevice().mapMemory(memory, offset, size);
+            if(VkResult result = vkMapMemory(device.getVkDevice(), memory, offset, size, 0, &data); result != VK_SUCCESS)
+            {
+                data = nullptr;
+                return Error{vk::Result(result), "Failed to map buffer memory!"};
+            }
+
+        return {};
     }
 
     void Buffer::unmap() noexcept
@@ -41,20 +49,22 @@ namespace dot
         }
     }
 
-    void Buffer::write(void* data, const vk::DeviceSize& size, const vk::DeviceSize& offset) noexcept
+    Result<> Buffer::write(void* data, const vk::DeviceSize& size, const vk::DeviceSize& offset) noexcept
     {
-        map(size, offset);
+        // maps the whole buffer so offset is applied once, a buffer that was mapped before stays mapped
+
+        const bool mapped = this->data != nullptr;
+        DOT_TRY(map());
 
         if(size == VK_WHOLE_SIZE)
-            memcpy(this->data, data, this->size);
+            memcpy(static_cast<char*>(this->data) + offset, data, this->size - offset);
         else
-        {
-            char* memOffset = static_cast<char*>(this->data);
-            memOffset += offset;
-            memcpy(memOffset, data, size);
-        }
+            memcpy(static_cast<char*>(this->data) + offset, data, size);
 
-        unmap();
+        if(!mapped)
+            unmap();
+
+        return {};
     }
 
     const vk::Buffer& Buffer::getVkBuffer() const noexcept
@@ -81,6 +91,7 @@ namespace dot
             vk::MemoryAllocateInfo allocateInfo(memRequirements.size, memTypeIndex);
 
             memory = device.getVkDevice().allocateMemory(allocateInfo);
+            allocationSize = memRequirements.size;
         }
         catch(const std::runtime_error& e)
         {
@@ -88,12 +99,20 @@ namespace dot
         }
 
         device.getVkDevice().bindBufferMemory(buffer, memory, 0);
+        device.memoryAllocated(allocationSize);
     }
 
     void Buffer::destroyBuffer() noexcept
     {
-        device.getVkDevice().waitIdle();
-        device.getVkDevice().destroyBuffer(buffer);
-        device.getVkDevice().freeMemory(memory); 
+        auto destroy = [&device = device, buffer = buffer, memory = memory, allocationSize = allocationSize]
+        {
+            device.getVkDevice().destroyBuffer(buffer);
+            device.getVkDevice().freeMemory(memory); 
+            device.memoryFreed(allocationSize);
+        };
+
+        // frames still in flight may read the buffer, destruction is deferred until the gpu is past them
+
+        device.retire(destroy);
     }
 }
\ No newline at end of file
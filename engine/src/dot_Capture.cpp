@@ -0,0 +1,142 @@
+#include "dot_Capture.h"
+#include "dot_Exception.h"
+
+namespace dot
+{
+    CaptureWriter::CaptureWriter(const std::string& path)
+        : file(path, std::ios::binary | std::ios::trunc)
+    {
+        if(!file)
+            throw DOT_RUNTIME("Failed to open the file: " + path);
+
+        put(captureMagic);
+        put(captureVersion);
+    }
+
+    void CaptureWriter::frameBegin(double deltaTime)
+    {
+        put(CaptureOp::FrameBegin);
+        put(deltaTime);
+    }
+
+    void CaptureWriter::frameEnd()
+    {
+        put(CaptureOp::FrameEnd);
+    }
+
+    void CaptureWriter::modelCreate(uint32_t modelId, const std::vector<Model::Vertex>& verticies)
+    {
+        put(CaptureOp::ModelCreate);
+        put(modelId);
+        putVerticies(verticies);
+    }
+
+    void CaptureWriter::modelWrite(uint32_t modelId, const std::vector<Model::Vertex>& verticies)
+    {
+        put(CaptureOp::ModelWrite);
+        put(modelId);
+        putVerticies(verticies);
+    }
+
+    void CaptureWriter::pipelineBind(uint32_t pipelineId)
+    {
+        put(CaptureOp::PipelineBind);
+        put(pipelineId);
+    }
+
+    void CaptureWriter::draw(uint32_t modelId, uint32_t instanceCount)
+    {
+        put(CaptureOp::Draw);
+        put(modelId);
+        put(instanceCount);
+    }
+
+    void CaptureWriter::resize(int32_t width, int32_t height)
+    {
+        put(CaptureOp::Resize);
+        put(width);
+        put(height);
+    }
+
+    template<typename T>
+    void CaptureWriter::put(const T& value)
+    {
+        file.write(reinterpret_cast<const char*>(&value), sizeof(T));
+    }
+
+    void CaptureWriter::putVerticies(const std::vector<Model::Vertex>& verticies)
+    {
+        put(static_cast<uint32_t>(verticies.size()));
+        file.write(reinterpret_cast<const char*>(verticies.data()), verticies.size() * sizeof(Model::Vertex));
+    }
+
+    CaptureReader::CaptureReader(const std::string& path)
+        : file(path, std::ios::binary)
+    {
+        if(!file)
+            throw DOT_RUNTIME("Failed to open the file: " + path);
+
+        if(get<uint32_t>() != captureMagic)
+            throw DOT_RUNTIME("Not a capture file or captured on a machine with different byte order: " + path);
+
+        if(get<uint32_t>() != captureVersion)
+            throw DOT_RUNTIME("Unsupported capture version: " + path);
+    }
+
+    bool CaptureReader::next(CaptureRecord& record)
+    {
+        uint8_t op;
+        if(!file.read(reinterpret_cast<char*>(&op), sizeof(op)))
+            return false;
+
+        record.op = CaptureOp(op);
+
+        switch(record.op)
+        {
+            case CaptureOp::FrameBegin:
+                record.deltaTime = get<double>();
+                break;
+            case CaptureOp::FrameEnd:
+                break;
+            case CaptureOp::ModelCreate:
+            case CaptureOp::ModelWrite:
+                record.id = get<uint32_t>();
+                getVerticies(record);
+                break;
+            case CaptureOp::PipelineBind:
+                record.id = get<uint32_t>();
+                break;
+            case CaptureOp::Draw:
+                record.id = get<uint32_t>();
+                record.count = get<uint32_t>();
+                break;
+            case CaptureOp::Resize:
+                record.width = get<int32_t>();
+                record.height = get<int32_t>();
+                break;
+            default:
+                throw DOT_RUNTIME("Corrupted capture file!");
+        }
+
+        return true;
+    }
+
+    template<typename T>
+    T CaptureReader::get()
+    {
+        T value;
+        if(!file.read(reinterpret_cast<char*>(&value), sizeof(T)))
+            throw DOT_RUNTIME("Unexpected end of capture file!");
+
+        return value;
+    }
+
+    void CaptureReader::getVerticies(CaptureRecord& record)
+    {
+        record.count = get<uint32_t>();
+        record.verticies.resize(record.count);
+
+        if(!file.read(reinterpret_cast<char*>(record.verticies.data()), record.count * sizeof(Model::Vertex)))
+            throw DOT_RUNTIME("Unexpected end of capture file!");
+    }
+}
\ No newline at end of file
@@ -0,0 +1,298 @@
+#include "dot_Descriptors.h"
+#include "dot_Exception.h"
+
+#include <algorithm>
+#include <bit>
+#include <string_view>
+
+namespace dot
+{
+    static_assert(sizeof(DescriptorInfo) == 3 * sizeof(uint64_t), "cache keys assume three words per descriptor");
+
+    DescriptorInfo DescriptorInfo::fromImage(const vk::Sampler& sampler, const vk::ImageView& view, vk::ImageLayout layout) noexcept
+    {
+        DescriptorInfo info;
+        info.image = {sampler, view, static_cast<VkImageLayout>(layout)};
+        return info;
+    }
+
+    DescriptorInfo DescriptorInfo::fromBuffer(const vk::Buffer& buffer, vk::DeviceSize offset, vk::DeviceSize range) noexcept
+    {
+        DescriptorInfo info;
+        info.buffer = {buffer, offset, range};
+        return info;
+    }
+
+    DescriptorInfo DescriptorInfo::fromTexelBuffer(const vk::BufferView& view) noexcept
+    {
+        DescriptorInfo info;
+        info.texelBuffer = view;
+        return info;
+    }
+
+    DescriptorAllocator::DescriptorAllocator(const vk::Device& device, uint32_t setsPerPool)
+        : setsPerPool(std::clamp(setsPerPool, 1U, maxSetsPerPool)), device(device){}
+
+    DescriptorAllocator::~DescriptorAllocator()
+    {
+        for(const auto& pool : pools)
+            device.destroyDescriptorPool(pool);
+    }
+
+    Result<vk::DescriptorSet> DescriptorAllocator::allocate(const vk::DescriptorSetLayout& layout) noexcept
+    {
+        // using vulkan c api to prevent from throwing an exception, a full pool moves on to the next one
+
+        const VkDescriptorSetLayout setLayout = layout;
+
+        for(;; current++)
+        {
+            bool emptyLargest = false;  // pool created just now at the largest size
+
+            if(current == pools.size())
+            {
+                emptyLargest = setsPerPool == maxSetsPerPool;
+
+                auto pool = createPool();
+                DOT_TRY(pool);
+                pools.push_back(pool.value());
+            }
+
+            VkDescriptorSetAllocateInfo allocInfo
+            {
+                .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_SET_ALLOCATE_INFO,
+                .descriptorPool = pools[current],
+                .descriptorSetCount = 1,
+                .pSetLayouts = &setLayout
+            };
+
+            VkDescriptorSet set;
+            const VkResult result = vkAllocateDescriptorSets(device, &allocInfo, &set);
+
+            if(result == VK_SUCCESS)
+                return vk::DescriptorSet(set);
+
+            if(result != VK_ERROR_OUT_OF_POOL_MEMORY && result != VK_ERROR_FRAGMENTED_POOL)
+                return Error{vk::Result(result), "Failed to allocate descriptor set!"};
+
+            // a set that does not fit an empty pool of the largest size never will, a used one only is full
+
+            if(emptyLargest)
+                return Error{vk::Result(result), "Descriptor set does not fit a descriptor pool!"};
+        }
+    }
+
+    void DescriptorAllocator::reset() noexcept
+    {
+        for(size_t i = 0; i < pools.size() && i <= current; i++)
+            vkResetDescriptorPool(device, pools[i], 0);
+
+        current = 0;
+    }
+
+    size_t DescriptorAllocator::getPoolCount() const noexcept
+    {
+        return pools.size();
+    }
+
+    Result<vk::DescriptorPool> DescriptorAllocator::createPool() noexcept
+    {
+        // descriptors per set of each type, a guess that wastes little for typical material and frame sets
+
+        static const std::pair<VkDescriptorType, float> ratios[] =
+        {
+            {VK_DESCRIPTOR_TYPE_SAMPLER, 0.5f},
+            {VK_DESCRIPTOR_TYPE_COMBINED_IMAGE_SAMPLER, 4.0f},
+            {VK_DESCRIPTOR_TYPE_SAMPLED_IMAGE, 4.0f},
+            {VK_DESCRIPTOR_TYPE_STORAGE_IMAGE, 1.0f},
+            {VK_DESCRIPTOR_TYPE_UNIFORM_TEXEL_BUFFER, 1.0f},
+            {VK_DESCRIPTOR_TYPE_STORAGE_TEXEL_BUFFER, 1.0f},
+            {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER, 2.0f},
+            {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER, 2.0f},
+            {VK_DESCRIPTOR_TYPE_UNIFORM_BUFFER_DYNAMIC, 1.0f},
+            {VK_DESCRIPTOR_TYPE_STORAGE_BUFFER_DYNAMIC, 1.0f},
+            {VK_DESCRIPTOR_TYPE_INPUT_ATTACHMENT, 0.5f}
+        };
+
+        VkDescriptorPoolSize sizes[std::size(ratios)];
+        for(size_t i = 0; i < std::size(ratios); i++)
+            sizes[i] = {ratios[i].first, std::max(1U, static_cast<uint32_t>(ratios[i].second * setsPerPool))};
+
+        const VkDescriptorPoolCreateInfo createInfo
+        {
+            .sType = VK_STRUCTURE_TYPE_DESCRIPTOR_POOL_CREATE_INFO,
+            .maxSets = setsPerPool,
+            .poolSizeCount = static_cast<uint32_t>(std::size(sizes)),
+            .pPoolSizes = sizes
+        };
+
+        VkDescriptorPool pool;
+        if(VkResult result = vkCreateDescriptorPool(device, &createInfo, nullptr, &pool); result != VK_SUCCESS)
+            return Error{vk::Result(result), "Failed to create descriptor pool!"};
+
+        setsPerPool = std::min(setsPerPool * 2, maxSetsPerPool);
+
+        return vk::DescriptorPool(pool);
+    }
+
+    Descriptors::Descriptors(Device& device, size_t framesInFlight)
+        : device(device)
+    {
+        for(size_t i = 0; i < framesInFlight; i++)
+            frameAllocators.push_back(std::make_unique<DescriptorAllocator>(device.getVkDevice()));
+
+        cacheAllocator = std::make_unique<DescriptorAllocator>(device.getVkDevice());
+    }
+
+    Descriptors::~Descriptors()
+    {
+        for(const auto& [setLayout, layout] : layouts)
+            device.getVkDevice().destroyDescriptorUpdateTemplate(layout.updateTemplate);
+    }
+
+    size_t Descriptors::KeyHash::operator()(const Key& key) const noexcept
+    {
+        return std::hash<std::string_view>()({reinterpret_cast<const char*>(key.data()), key.size() * sizeof(uint64_t)});
+    }
+
+    const DescriptorLayout& Descriptors::getLayout(std::span<const vk::DescriptorSetLayoutBinding> bindings)
+    {
+        // the layout cache makes the set layout handle unique per description, it keys the templates as well
+
+        const vk::DescriptorSetLayout setLayout = device.getLayoutCache().getSetLayout(bindings);
+
+        if(auto found = layouts.find(setLayout); found != layouts.end())
+            return found->second;
+
+        std::vector<vk::DescriptorSetLayoutBinding> sorted(bindings.begin(), bindings.end());
+        std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b){ return a.binding < b.binding; });
+
+        DescriptorLayout layout;
+        layout.setLayout = setLayout;
+
+        std::vector<vk::DescriptorUpdateTemplateEntry> entries;
+        for(const auto& binding : sorted)
+        {
+            if(!binding.descriptorCount)
+                continue;
+
+            entries.emplace_back
+            (
+                binding.binding,                                // dstBinding
+                0,                                              // dstArrayElement
+                binding.descriptorCount,                        // descriptorCount
+                binding.descriptorType,                         // descriptorType
+                layout.descriptorCount * sizeof(DescriptorInfo),// offset
+                sizeof(DescriptorInfo)                          // stride
+            );
+
+            layout.descriptorCount += binding.descriptorCount;
+        }
+
+        vk::DescriptorUpdateTemplateCreateInfo createInfo
+        (
+            vk::DescriptorUpdateTemplateCreateFlags(0U),        // flags
+            entries,                                            // descriptorUpdateEntries
+            vk::DescriptorUpdateTemplateType::eDescriptorSet,   // templateType
+            setLayout                                           // descriptorSetLayout
+        );
+
+        try
+        {
+            layout.updateTemplate = device.getVkDevice().createDescriptorUpdateTemplate(createInfo);
+        }
+        catch(const std::runtime_error& e)
+        {
+            throw DOT_RUNTIME_WHAT(e);
+        }
+
+        return layouts.emplace(setLayout, layout).first->second;
+    }
+
+    void Descriptors::beginFrame(size_t frameInFlight) noexcept
+    {
+        currentFrame = frameInFlight % frameAllocators.size();
+        frameAllocators[currentFrame]->reset();
+        stats.frameSets = 0;
+    }
+
+    Result<vk::DescriptorSet> Descriptors::allocateFrame(const DescriptorLayout& layout, std::span<const DescriptorInfo> infos) noexcept
+    {
+        auto set = frameAllocators[currentFrame]->allocate(layout.setLayout);
+        DOT_TRY(set);
+
+        DOT_TRY(update(set.value(), layout, infos));
+        stats.frameSets++;
+
+        return set;
+    }
+
+    Result<vk::DescriptorSet> Descriptors::getCached(const DescriptorLayout& layout, std::span<const DescriptorInfo> infos) noexcept
+    {
+        // the key is the layout handle and the descriptors' raw words, equal contents share one set
+
+        Key key;
+        key.reserve(1 + infos.size() * sizeof(DescriptorInfo) / sizeof(uint64_t));
+        key.push_back(std::bit_cast<uint64_t>(static_cast<VkDescriptorSetLayout>(layout.setLayout)));
+        for(const DescriptorInfo& info : infos)
+            key.insert(key.end(), std::begin(info.words), std::end(info.words));
+
+        if(auto found = cachedSets.find(key); found != cachedSets.end())
+        {
+            stats.cacheHits++;
+            return found->second;
+        }
+
+        auto set = cacheAllocator->allocate(layout.setLayout);
+        DOT_TRY(set);
+        DOT_TRY(update(set.value(), layout, infos));
+
+        try
+        {
+            cachedSets.emplace(std::move(key), set.value());
+        }
+        catch(...)
+        {
+            return Error{vk::Result::eErrorOutOfHostMemory, "Failed to cache descriptor set!"};
+        }
+
+        stats.cachedSets++;
+
+        return set;
+    }
+
+    Result<> Descriptors::update(const vk::DescriptorSet& set, const DescriptorLayout& layout, std::span<const DescriptorInfo> infos) noexcept
+    {
+        // a template write reads the infos straight from memory, one call regardless of the binding count
+
+        if(infos.size() < layout.descriptorCount)
+            return Error{vk::Result::eErrorUnknown, "Fewer descriptors than the set layout holds!"};
+
+        vkUpdateDescriptorSetWithTemplate(device.getVkDevice(), set, layout.updateTemplate, infos.data());
+        stats.updates++;
+
+        return {};
+    }
+
+    void Descriptors::clearCache()
+    {
+        cachedSets.clear();
+        stats.cachedSets = 0;
+
+        std::shared_ptr<DescriptorAllocator> pRetired = std::move(cacheAllocator);
+        cacheAllocator = std::make_unique<DescriptorAllocator>(device.getVkDevice());
+
+        device.retire([pRetired]{});
+    }
+
+    DescriptorStats Descriptors::getStats() const noexcept
+    {
+        DescriptorStats current = stats;
+
+        current.pools = cacheAllocator->getPoolCount();
+        for(const auto& pAllocator : frameAllocators)
+            current.pools += pAllocator->getPoolCount();
+
+        return current;
+    }
+}
\ No newline at end of file
@@ -1,6 +1,11 @@
 #include "dot_Device.h"
 #include "dot_Exception.h"
+#include "dot_Profiler.h"
 
+#include <algorithm>
+#include <bit>
+#include <iterator>
+#include <limits>
 #include <set>
 #include <string>
 
@@ -9,15 +14,37 @@ namespace dot
     Device::Device(Window& wnd)
         : wnd(wnd)
     {
-        createSurface();
-        selectPhysicalDevice();
-        createLogicalDevice();
-        createCmdPoolGfx();
-        createCmdPoolTransfer();
+        {
+            DOT_PROFILE_SCOPE("surface");
+            createSurface();
+        }
+        {
+            DOT_PROFILE_SCOPE("physical_device");
+            selectPhysicalDevice();
+        }
+        {
+            DOT_PROFILE_SCOPE("logical_device");
+            createLogicalDevice();
+        }
+        {
+            DOT_PROFILE_SCOPE("command_pools");
+            createCmdPoolGfx();
+            createCmdPoolTransfer();
+            createPipelineCache();
+            createTimeline();
+        }
+
+        layoutCache = std::make_unique<LayoutCache>(device);
     }
 
     Device::~Device()
     {
+        device.waitIdle();
+        collectGarbage(true);
+
+        device.destroySemaphore(timeline);
+        layoutCache.reset();
+        device.destroyPipelineCache(pipelineCache);
         device.destroyCommandPool(cmdPoolTransfer);
         device.destroyCommandPool(cmdPoolGfx);
         device.destroy();
@@ -29,36 +56,252 @@ namespace dot
         return device;
     }
 
-    vk::CommandBuffer Device::beginTransferCmd() const noexcept
+    Result<vk::CommandBuffer> Device::beginTransferCmd() const noexcept
     {
-        vk::CommandBufferAllocateInfo allocInfo(cmdPoolTransfer, vk::CommandBufferLevel::ePrimary, 1);
-        vk::CommandBuffer cmdBuffer = device.allocateCommandBuffers(allocInfo).front(); 
+        // using vulkan c api to prevent from throwing an exception
+
+        VkCommandBufferAllocateInfo allocInfo
+        {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_ALLOCATE_INFO,
+            .commandPool = cmdPoolTransfer,
+            .level = VK_COMMAND_BUFFER_LEVEL_PRIMARY,
+            .commandBufferCount = 1
+        };
+
+        VkCommandBuffer cmdBuffer;
+        if(VkResult result = vkAllocateCommandBuffers(device, &allocInfo, &cmdBuffer); result != VK_SUCCESS)
+            return Error{vk::Result(result), "Failed to allocate transfer command buffer!"};
 
-        vk::CommandBufferBeginInfo beginInfo(vk::CommandBufferUsageFlagBits::eOneTimeSubmit);
-        cmdBuffer.begin(beginInfo);
+        VkCommandBufferBeginInfo beginInfo
+        {
+            .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+            .flags = VK_COMMAND_BUFFER_USAGE_ONE_TIME_SUBMIT_BIT
+        };
+
+        if(VkResult result = vkBeginCommandBuffer(cmdBuffer, &beginInfo); result != VK_SUCCESS)
+        {
+            vkFreeCommandBuffers(device, cmdPoolTransfer, 1, &cmdBuffer);
+            return Error{vk::Result(result), "Failed to begin transfer command buffer!"};
+        }
 
-        return std::move(cmdBuffer);
+        return vk::CommandBuffer(cmdBuffer);
     }
 
-    void Device::endTransferCmd(const vk::CommandBuffer& cmdBuffer) const noexcept
+    Result<> Device::endTransferCmd(const vk::CommandBuffer& cmdBuffer) const noexcept
     {
-        cmdBuffer.end();
+        // using vulkan c api to prevent from throwing an exception
 
-        vk::SubmitInfo submitInfo({}, {}, cmdBuffer);
-        graphicQueue.submit(submitInfo);
-        graphicQueue.waitIdle();
+        VkCommandBuffer vkCmdBuffer = cmdBuffer;
+        Result<> result = {};
 
-        device.freeCommandBuffers(cmdPoolTransfer, cmdBuffer);
+        if(VkResult endResult = vkEndCommandBuffer(vkCmdBuffer); endResult != VK_SUCCESS)
+            result = Error{vk::Result(endResult), "Failed to end transfer command buffer!"};
+
+        // waits for this transfer only instead of the whole queue, frames submitted before it keep running
+
+        if(result)
+        {
+            auto submitted = submitGfx(cmdBuffer);
+            result = submitted ? waitTimeline(submitted.value()) : Result<>(submitted.error());
+        }
+
+        vkFreeCommandBuffers(device, cmdPoolTransfer, 1, &vkCmdBuffer);
+
+        return result;
     }
 
-    void Device::copyBuffer(const vk::Buffer& src, const vk::Buffer& dst, const vk::DeviceSize& size) const noexcept
+    Result<> Device::copyBuffer(const vk::Buffer& src, const vk::Buffer& dst, const vk::DeviceSize& size) const noexcept
     {
-        auto&& cmdBuffer = beginTransferCmd();
+        auto cmdBuffer = beginTransferCmd();
+        DOT_TRY(cmdBuffer);
 
         vk::BufferCopy copy(0, 0, size);
-        cmdBuffer.copyBuffer(src, dst, copy);
+        cmdBuffer.value().copyBuffer(src, dst, copy);
+
+        return endTransferCmd(cmdBuffer.value());
+    }
+
+    Result<> Device::copyBufferToImage(const vk::Buffer& src, const vk::Image& dst, const vk::Extent2D& extent) const noexcept
+    {
+        auto cmdBuffer = beginTransferCmd();
+        DOT_TRY(cmdBuffer);
+
+        const vk::ImageSubresourceRange range(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1);
+
+        vk::ImageMemoryBarrier toTransfer
+        (
+            vk::AccessFlags(0U),                        // srcAccessMask
+            vk::AccessFlagBits::eTransferWrite,         // dstAccessMask
+            vk::ImageLayout::eUndefined,                // oldLayout
+            vk::ImageLayout::eTransferDstOptimal,       // newLayout
+            VK_QUEUE_FAMILY_IGNORED,                    // srcQueueFamilyIndex
+            VK_QUEUE_FAMILY_IGNORED,                    // dstQueueFamilyIndex
+            dst,                                        // image
+            range                                       // subresourceRange
+        );
+        cmdBuffer.value().pipelineBarrier(vk::PipelineStageFlagBits::eTopOfPipe, vk::PipelineStageFlagBits::eTransfer, {}, {}, {}, toTransfer);
+
+        vk::BufferImageCopy copy
+        (
+            0, 0, 0,                                                                // bufferOffset, bufferRowLength, bufferImageHeight
+            vk::ImageSubresourceLayers(vk::ImageAspectFlagBits::eColor, 0, 0, 1),   // imageSubresource
+            vk::Offset3D(0, 0, 0),                                                  // imageOffset
+            vk::Extent3D(extent.width, extent.height, 1)                            // imageExtent
+        );
+        cmdBuffer.value().copyBufferToImage(src, dst, vk::ImageLayout::eTransferDstOptimal, copy);
 
-        endTransferCmd(cmdBuffer);
+        vk::ImageMemoryBarrier toShader
+        (
+            vk::AccessFlagBits::eTransferWrite,         // srcAccessMask
+            vk::AccessFlagBits::eShaderRead,            // dstAccessMask
+            vk::ImageLayout::eTransferDstOptimal,       // oldLayout
+            vk::ImageLayout::eShaderReadOnlyOptimal,    // newLayout
+            VK_QUEUE_FAMILY_IGNORED,                    // srcQueueFamilyIndex
+            VK_QUEUE_FAMILY_IGNORED,                    // dstQueueFamilyIndex
+            dst,                                        // image
+            range                                       // subresourceRange
+        );
+        cmdBuffer.value().pipelineBarrier(vk::PipelineStageFlagBits::eTransfer, vk::PipelineStageFlagBits::eFragmentShader, {}, {}, {}, toShader);
+
+        return endTransferCmd(cmdBuffer.value());
+    }
+
+    Result<uint64_t> Device::submitGfx
+    (
+        const vk::CommandBuffer& cmdBuffer,
+        std::span<const VkSemaphore> waitSemaphores, std::span<const VkPipelineStageFlags> waitStages,
+        std::span<const VkSemaphore> signalSemaphores
+    ) const noexcept
+    {
+        // timeline values have to be signaled in increasing order, allocating the value and submitting happen under one lock
+
+        constexpr size_t maxSignalSemaphores = 4;
+        if(signalSemaphores.size() >= maxSignalSemaphores)
+            return Error{vk::Result::eErrorUnknown, "Too many signal semaphores!"};
+
+        std::lock_guard<std::mutex> lock(gfxQueueMutex);
+
+        const uint64_t value = submittedValue + 1;
+
+        VkSemaphore signals[maxSignalSemaphores];
+        uint64_t signalValues[maxSignalSemaphores] = {}; // ignored for binary semaphores
+        std::copy(signalSemaphores.begin(), signalSemaphores.end(), signals);
+        signals[signalSemaphores.size()] = timeline;
+        signalValues[signalSemaphores.size()] = value;
+
+        const uint32_t signalCount = static_cast<uint32_t>(signalSemaphores.size() + 1);
+
+        VkTimelineSemaphoreSubmitInfo timelineInfo
+        {
+            .sType = VK_STRUCTURE_TYPE_TIMELINE_SEMAPHORE_SUBMIT_INFO,
+            .signalSemaphoreValueCount = signalCount,
+            .pSignalSemaphoreValues = signalValues
+        };
+
+        VkCommandBuffer vkCmdBuffer = cmdBuffer;
+
+        VkSubmitInfo submitInfo
+        {
+            .sType = VK_STRUCTURE_TYPE_SUBMIT_INFO,
+            .pNext = &timelineInfo,
+            .waitSemaphoreCount = static_cast<uint32_t>(waitSemaphores.size()),
+            .pWaitSemaphores = waitSemaphores.data(),
+            .pWaitDstStageMask = waitStages.data(),
+            .commandBufferCount = vkCmdBuffer ? 1U : 0U,
+            .pCommandBuffers = &vkCmdBuffer,
+            .signalSemaphoreCount = signalCount,
+            .pSignalSemaphores = signals
+        };
+
+        if(VkResult result = vkQueueSubmit(graphicQueue, 1, &submitInfo, VK_NULL_HANDLE); result != VK_SUCCESS)
+            return Error{vk::Result(result), "Failed to submit command buffer!"};
+
+        submittedValue = value;
+
+        return value;
+    }
+
+    Result<> Device::waitTimeline(uint64_t value) const noexcept
+    {
+        VkSemaphore semaphore = timeline;
+
+        VkSemaphoreWaitInfo waitInfo
+        {
+            .sType = VK_STRUCTURE_TYPE_SEMAPHORE_WAIT_INFO,
+            .semaphoreCount = 1,
+            .pSemaphores = &semaphore,
+            .pValues = &value
+        };
+
+        if(VkResult result = vkWaitSemaphores(device, &waitInfo, std::numeric_limits<uint64_t>::max()); result != VK_SUCCESS)
+            return Error{vk::Result(result), "Failed to wait for timeline semaphore!"};
+
+        return {};
+    }
+
+    uint64_t Device::getCompletedTimelineValue() const noexcept
+    {
+        uint64_t value = 0;
+        vkGetSemaphoreCounterValue(device, timeline, &value);
+        return value;
+    }
+
+    uint64_t Device::getSubmittedTimelineValue() const noexcept
+    {
+        return submittedValue;
+    }
+
+    void Device::destroyAfterUse(std::function<void()> destroy)
+    {
+        // runs right away when the gpu has finished everything submitted so far, otherwise once it has
+
+        const uint64_t value = submittedValue;
+
+        if(getCompletedTimelineValue() >= value)
+        {
+            destroy();
+            return;
+        }
+
+        std::lock_guard<std::mutex> lock(garbageMutex);
+        garbage.push_back({value, std::move(destroy)});
+    }
+
+    void Device::retire(const std::function<void()>& destroy) noexcept
+    {
+        // deferring only fails to allocate, the fallback waits for the device through the c api so that a lost device
+        // cannot throw out of the destructors and noexcept functions calling this
+
+        try
+        {
+            destroyAfterUse(destroy);
+        }
+        catch(...)
+        {
+            vkDeviceWaitIdle(device);
+            destroy();
+        }
+    }
+
+    void Device::collectGarbage(bool all) noexcept
+    {
+        const uint64_t completed = getCompletedTimelineValue();
+
+        std::vector<Garbage> expired;
+        {
+            std::lock_guard<std::mutex> lock(garbageMutex);
+
+            auto pending = std::partition(garbage.begin(), garbage.end(), [&](const Garbage& object)
+            {
+                return all || object.timelineValue <= completed;
+            });
+
+            std::move(garbage.begin(), pending, std::back_inserter(expired));
+            garbage.erase(garbage.begin(), pending);
+        }
+
+        for(auto& object : expired)
+            object.destroy();
     }
 
     const Device::SwapchainSupportDetails& Device::getSwapchainDetails() const noexcept
@@ -102,11 +345,151 @@ namespace dot
         throw std::runtime_error("Failed to find suitable memory type!");
     }
 
+    bool Device::hasMemoryType(uint32_t typeFilter, const vk::MemoryPropertyFlags& flags) const noexcept
+    {
+        vk::PhysicalDeviceMemoryProperties memProperties = physicalDevice.getMemoryProperties();
+
+        for(uint32_t i = 0; i < memProperties.memoryTypeCount; i++)
+            if(typeFilter & (1 << i) && (memProperties.memoryTypes[i].propertyFlags & flags) == flags)
+                return true;
+
+        return false;
+    }
+
+    vk::Format Device::findSupportedFormat(const std::vector<vk::Format>& candidates, vk::ImageTiling tiling, const vk::FormatFeatureFlags& features) const
+    {
+        for(auto format : candidates)
+        {
+            const vk::FormatProperties properties = physicalDevice.getFormatProperties(format);
+            const auto& supported = tiling == vk::ImageTiling::eLinear ? properties.linearTilingFeatures : properties.optimalTilingFeatures;
+
+            if((supported & features) == features)
+                return format;
+        }
+
+        throw DOT_RUNTIME("Failed to find supported format!");
+    }
+
+    vk::Format Device::getDepthFormat() const
+    {
+        // in order of preference, pure depth formats first as no pass uses stencil
+
+        return findSupportedFormat
+        (
+            {vk::Format::eD32Sfloat, vk::Format::eD32SfloatS8Uint, vk::Format::eD24UnormS8Uint},
+            vk::ImageTiling::eOptimal,
+            vk::FormatFeatureFlagBits::eDepthStencilAttachment
+        );
+    }
+
+    vk::PhysicalDeviceLimits Device::getLimits() const noexcept
+    {
+        return physicalDevice.getProperties().limits;
+    }
+
+    vk::PhysicalDeviceVulkan12Properties Device::getProperties12() const noexcept
+    {
+        return physicalDevice.getProperties2<vk::PhysicalDeviceProperties2, vk::PhysicalDeviceVulkan12Properties>()
+               .get<vk::PhysicalDeviceVulkan12Properties>();
+    }
+
+    vk::SampleCountFlagBits Device::getSampleCount(uint32_t requested) const noexcept
+    {
+        // the highest count up to the requested one that color and depth attachments both support, at most 8
+
+        const vk::PhysicalDeviceLimits limits = physicalDevice.getProperties().limits;
+        const vk::SampleCountFlags supported = limits.framebufferColorSampleCounts & limits.framebufferDepthSampleCounts;
+
+        for(uint32_t count = std::bit_floor(std::clamp(requested, 1U, 8U)); count > 1; count >>= 1)
+            if(supported & vk::SampleCountFlagBits(count))
+                return vk::SampleCountFlagBits(count);
+
+        return vk::SampleCountFlagBits::e1;
+    }
+
+    const vk::PhysicalDeviceFeatures& Device::getEnabledFeatures() const noexcept
+    {
+        return enabledFeatures;
+    }
+
+    const vk::PhysicalDeviceVulkan12Features& Device::getEnabledFeatures12() const noexcept
+    {
+        return enabledFeatures12;
+    }
+
+    bool Device::dynamicRenderingEnabled() const noexcept
+    {
+        return enabledDynamicRendering.dynamicRendering;
+    }
+
+    void Device::cmdBeginRendering(const vk::CommandBuffer& cmdBuffer, const vk::RenderingInfoKHR& renderingInfo) const noexcept
+    {
+        pfnCmdBeginRendering(cmdBuffer, reinterpret_cast<const VkRenderingInfoKHR*>(&renderingInfo));
+    }
+
+    void Device::cmdEndRendering(const vk::CommandBuffer& cmdBuffer) const noexcept
+    {
+        pfnCmdEndRendering(cmdBuffer);
+    }
+
+    bool Device::pipelineLibraryEnabled() const noexcept
+    {
+        return enabledPipelineLibrary.graphicsPipelineLibrary;
+    }
+
+    bool Device::descriptorIndexingEnabled() const noexcept
+    {
+        return enabledFeatures12.descriptorIndexing;
+    }
+
+    const DynamicStateCommands& Device::getDynamicStateCommands() const noexcept
+    {
+        return dynamicStateCommands;
+    }
+
+    void Device::memoryAllocated(const vk::DeviceSize& size) noexcept
+    {
+        vk::DeviceSize current = allocatedMemory += size;
+        vk::DeviceSize peak = peakAllocatedMemory;
+
+        while(current > peak && !peakAllocatedMemory.compare_exchange_weak(peak, current));
+    }
+
+    void Device::memoryFreed(const vk::DeviceSize& size) noexcept
+    {
+        allocatedMemory -= size;
+    }
+
+    vk::DeviceSize Device::getAllocatedMemory() const noexcept
+    {
+        return allocatedMemory;
+    }
+
+    vk::DeviceSize Device::getPeakAllocatedMemory() const noexcept
+    {
+        return peakAllocatedMemory;
+    }
+
+    void Device::resetPeakAllocatedMemory() noexcept
+    {
+        peakAllocatedMemory = allocatedMemory.load();
+    }
+
     const vk::CommandPool& Device::getCmdPoolGfx() const noexcept
     {
         return cmdPoolGfx;
     }
 
+    const vk::PipelineCache& Device::getPipelineCache() const noexcept
+    {
+        return pipelineCache;
+    }
+
+    LayoutCache& Device::getLayoutCache() const noexcept
+    {
+        return *layoutCache;
+    }
+
     void Device::createSurface()
     {
         VkSurfaceKHR vkSurface;
@@ -153,7 +536,13 @@ namespace dot
             swapChainCompatible = !swapchainDetails.formats.empty() && !swapchainDetails.modes.empty();
         }
 
-        return queueIndices.found() && extensionsSupported && swapChainCompatible;
+        // frame pacing and resource lifetimes are tracked with a timeline semaphore, core since vulkan 1.2
+
+        auto features = device.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>();
+        bool timelineSupported = device.getProperties().apiVersion >= VK_API_VERSION_1_2 &&
+                                 features.get<vk::PhysicalDeviceVulkan12Features>().timelineSemaphore;
+
+        return queueIndices.found() && extensionsSupported && swapChainCompatible && timelineSupported;
     }
 
     void Device::setQueueFamilies(const vk::PhysicalDevice& device) noexcept
@@ -196,6 +585,22 @@ namespace dot
         }
     }
 
+    bool Device::deviceExtensionSupported(const char* name) const
+    {
+        try
+        {
+            for(const auto& extension : physicalDevice.enumerateDeviceExtensionProperties())
+                if(std::string(extension.extensionName) == name)
+                    return true;
+
+            return false;
+        }
+        catch(const std::runtime_error& e)
+        {
+            throw DOT_RUNTIME_WHAT(e);
+        }
+    }
+
     void Device::setSwapchainDetails(const vk::PhysicalDevice& device) noexcept
     {
 
@@ -224,7 +629,115 @@ namespace dot
             queueCreateInfos.emplace_back(queueCreateInfo);
         }
 
-        vk::PhysicalDeviceFeatures deviceFeatures = {};
+        // optional features are enabled when present, users check getEnabledFeatures
+
+        const vk::PhysicalDeviceFeatures supportedFeatures = physicalDevice.getFeatures();
+        enabledFeatures.pipelineStatisticsQuery = supportedFeatures.pipelineStatisticsQuery;
+
+        const auto supportedFeatures12 = physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceVulkan12Features>()
+                                         .get<vk::PhysicalDeviceVulkan12Features>();
+        enabledFeatures12.timelineSemaphore = VK_TRUE;
+        enabledFeatures12.hostQueryReset = supportedFeatures12.hostQueryReset;
+
+        // bindless resources need runtime sized arrays that are partially bound, indexed per fragment and written while
+        // the set is bound; without all of them materials keep binding sets of their own
+
+        if(supportedFeatures12.descriptorIndexing &&
+           supportedFeatures12.runtimeDescriptorArray &&
+           supportedFeatures12.descriptorBindingPartiallyBound &&
+           supportedFeatures12.descriptorBindingUpdateUnusedWhilePending &&
+           supportedFeatures12.descriptorBindingSampledImageUpdateAfterBind &&
+           supportedFeatures12.descriptorBindingStorageBufferUpdateAfterBind &&
+           supportedFeatures12.shaderSampledImageArrayNonUniformIndexing &&
+           supportedFeatures12.shaderStorageBufferArrayNonUniformIndexing)
+        {
+            enabledFeatures12.descriptorIndexing = VK_TRUE;
+            enabledFeatures12.runtimeDescriptorArray = VK_TRUE;
+            enabledFeatures12.descriptorBindingPartiallyBound = VK_TRUE;
+            enabledFeatures12.descriptorBindingUpdateUnusedWhilePending = VK_TRUE;
+            enabledFeatures12.descriptorBindingSampledImageUpdateAfterBind = VK_TRUE;
+            enabledFeatures12.descriptorBindingStorageBufferUpdateAfterBind = VK_TRUE;
+            enabledFeatures12.shaderSampledImageArrayNonUniformIndexing = VK_TRUE;
+            enabledFeatures12.shaderStorageBufferArrayNonUniformIndexing = VK_TRUE;
+        }
+
+        // optional extension features are chained behind the vulkan 1.2 ones
+
+        enabledExtensions = deviceExtensions;
+        auto enableExtension = [&](const char* name, auto& features)
+        {
+            enabledExtensions.push_back(name);
+            features.pNext = enabledFeatures12.pNext;
+            enabledFeatures12.pNext = &features;
+        };
+
+        // without dynamic rendering the renderer keeps using render pass and framebuffer objects
+
+        if(deviceExtensionSupported(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME))
+        {
+            const auto supportedDynamicRendering = physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceDynamicRenderingFeaturesKHR>()
+                                                   .get<vk::PhysicalDeviceDynamicRenderingFeaturesKHR>();
+
+            if(supportedDynamicRendering.dynamicRendering)
+            {
+                enabledDynamicRendering.dynamicRendering = VK_TRUE;
+                enableExtension(VK_KHR_DYNAMIC_RENDERING_EXTENSION_NAME, enabledDynamicRendering);
+            }
+        }
+
+        // without extended dynamic state every fixed function combination needs a pipeline of its own
+
+        if(deviceExtensionSupported(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME))
+        {
+            const auto supportedDynamicState = physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceExtendedDynamicStateFeaturesEXT>()
+                                               .get<vk::PhysicalDeviceExtendedDynamicStateFeaturesEXT>();
+
+            if(supportedDynamicState.extendedDynamicState)
+            {
+                enabledDynamicState.extendedDynamicState = VK_TRUE;
+                enableExtension(VK_EXT_EXTENDED_DYNAMIC_STATE_EXTENSION_NAME, enabledDynamicState);
+            }
+        }
+
+        if(deviceExtensionSupported(VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME))
+        {
+            const auto supportedDynamicState2 = physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceExtendedDynamicState2FeaturesEXT>()
+                                                .get<vk::PhysicalDeviceExtendedDynamicState2FeaturesEXT>();
+
+            if(supportedDynamicState2.extendedDynamicState2)
+            {
+                enabledDynamicState2.extendedDynamicState2 = VK_TRUE;
+                enableExtension(VK_EXT_EXTENDED_DYNAMIC_STATE_2_EXTENSION_NAME, enabledDynamicState2);
+            }
+        }
+
+        if(deviceExtensionSupported(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME))
+        {
+            const auto supportedDynamicState3 = physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceExtendedDynamicState3FeaturesEXT>()
+                                                .get<vk::PhysicalDeviceExtendedDynamicState3FeaturesEXT>();
+
+            if(supportedDynamicState3.extendedDynamicState3ColorBlendEnable && supportedDynamicState3.extendedDynamicState3ColorBlendEquation)
+            {
+                enabledDynamicState3.extendedDynamicState3ColorBlendEnable = VK_TRUE;
+                enabledDynamicState3.extendedDynamicState3ColorBlendEquation = VK_TRUE;
+                enableExtension(VK_EXT_EXTENDED_DYNAMIC_STATE_3_EXTENSION_NAME, enabledDynamicState3);
+            }
+        }
+
+        // without pipeline libraries every new state combination is a full pipeline compile
+
+        if(deviceExtensionSupported(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME) && deviceExtensionSupported(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME))
+        {
+            const auto supportedPipelineLibrary = physicalDevice.getFeatures2<vk::PhysicalDeviceFeatures2, vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT>()
+                                                  .get<vk::PhysicalDeviceGraphicsPipelineLibraryFeaturesEXT>();
+
+            if(supportedPipelineLibrary.graphicsPipelineLibrary)
+            {
+                enabledPipelineLibrary.graphicsPipelineLibrary = VK_TRUE;
+                enabledExtensions.push_back(VK_KHR_PIPELINE_LIBRARY_EXTENSION_NAME);
+                enableExtension(VK_EXT_GRAPHICS_PIPELINE_LIBRARY_EXTENSION_NAME, enabledPipelineLibrary);
+            }
+        }
 
         auto validationLayers = inst.getValidationLayers();
 
@@ -233,9 +746,10 @@ namespace dot
             vk::DeviceCreateFlags(0U),  // flags
             queueCreateInfos            // pQueueCreateInfos
         );
-        deviceCreateInfo.ppEnabledExtensionNames = deviceExtensions.data();
-        deviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(deviceExtensions.size());
-        deviceCreateInfo.pEnabledFeatures = &deviceFeatures;
+        deviceCreateInfo.ppEnabledExtensionNames = enabledExtensions.data();
+        deviceCreateInfo.enabledExtensionCount = static_cast<uint32_t>(enabledExtensions.size());
+        deviceCreateInfo.pEnabledFeatures = &enabledFeatures;
+        deviceCreateInfo.pNext = &enabledFeatures12;
 
         if(inst.validationLayersEnabled())
         {
@@ -256,6 +770,64 @@ namespace dot
         
         graphicQueue = device.getQueue(0, queueIndices.graphicFamily.value());
         presentQueue = device.getQueue(0, queueIndices.presentFamily.value());
+
+        loadExtensionFunctions();
+    }
+
+    void Device::loadExtensionFunctions() noexcept
+    {
+        auto load = [&]<typename T>(T& pfn, const char* name)
+        {
+            pfn = reinterpret_cast<T>(device.getProcAddr(name));
+            return pfn != nullptr;
+        };
+
+        if(enabledDynamicRendering.dynamicRendering)
+        {
+            const bool loaded =
+                load(pfnCmdBeginRendering, "vkCmdBeginRenderingKHR") &
+                load(pfnCmdEndRendering, "vkCmdEndRenderingKHR");
+
+            if(!loaded)
+                enabledDynamicRendering.dynamicRendering = VK_FALSE;
+        }
+
+        // a group of states is reported as supported only when all of its commands were found
+
+        DynamicStateCommands& cmds = dynamicStateCommands;
+
+        if(enabledDynamicState.extendedDynamicState)
+        {
+            if(load(cmds.cmdSetCullMode, "vkCmdSetCullModeEXT"))
+                cmds.supported |= DynamicCullMode;
+
+            if(load(cmds.cmdSetFrontFace, "vkCmdSetFrontFaceEXT"))
+                cmds.supported |= DynamicFrontFace;
+
+            if(load(cmds.cmdSetPrimitiveTopology, "vkCmdSetPrimitiveTopologyEXT"))
+                cmds.supported |= DynamicTopology;
+
+            const bool depthLoaded =
+                load(cmds.cmdSetDepthTestEnable, "vkCmdSetDepthTestEnableEXT") &
+                load(cmds.cmdSetDepthWriteEnable, "vkCmdSetDepthWriteEnableEXT") &
+                load(cmds.cmdSetDepthCompareOp, "vkCmdSetDepthCompareOpEXT");
+
+            if(depthLoaded)
+                cmds.supported |= DynamicDepth;
+        }
+
+        if(enabledDynamicState2.extendedDynamicState2 && load(cmds.cmdSetDepthBiasEnable, "vkCmdSetDepthBiasEnableEXT"))
+            cmds.supported |= DynamicDepthBias;
+
+        if(enabledDynamicState3.extendedDynamicState3ColorBlendEnable)
+        {
+            const bool blendLoaded =
+                load(cmds.cmdSetColorBlendEnable, "vkCmdSetColorBlendEnableEXT") &
+                load(cmds.cmdSetColorBlendEquation, "vkCmdSetColorBlendEquationEXT");
+
+            if(blendLoaded)
+                cmds.supported |= DynamicBlend;
+        }
     }
 
     void Device::createCmdPoolGfx()
@@ -289,4 +861,35 @@ namespace dot
             throw DOT_RUNTIME_WHAT(e);
         }
     }
+    void Device::createPipelineCache()
+    {
+        vk::PipelineCacheCreateInfo createInfo(vk::PipelineCacheCreateFlags(0U));
+
+        try
+        {
+            pipelineCache = device.createPipelineCache(createInfo);
+        }
+        catch(const std::runtime_error& e)
+        {
+            throw DOT_RUNTIME_WHAT(e);
+        }
+    }
+
+    void Device::createTimeline()
+    {
+        vk::StructureChain<vk::SemaphoreCreateInfo, vk::SemaphoreTypeCreateInfo> createInfo
+        (
+            vk::SemaphoreCreateInfo(vk::SemaphoreCreateFlags(0U)),      // flags
+            vk::SemaphoreTypeCreateInfo(vk::SemaphoreType::eTimeline, 0) // semaphoreType, initialValue
+        );
+
+        try
+        {
+            timeline = device.createSemaphore(createInfo.get<vk::SemaphoreCreateInfo>());
+        }
+        catch(const std::runtime_error& e)
+        {
+            throw DOT_RUNTIME_WHAT(e);
+        }
+    }
 }
\ No newline at end of file
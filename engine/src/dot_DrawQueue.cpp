@@ -0,0 +1,321 @@
+#include "dot_DrawQueue.h"
+#include "dot_Transforms.h"
+
+#include <algorithm>
+#include <array>
+#include <barrier>
+#include <chrono>
+
+namespace dot
+{
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    uint64_t DrawQueue::makeKey(uint32_t pass, uint32_t pipeline, uint32_t material, uint32_t mesh, float depth) noexcept
+    {
+        // state ids above depth, draws sharing a state end up next to each other and front to back within it
+
+        const auto depthBits = static_cast<uint64_t>(std::clamp(depth, 0.0f, 1.0f) * 0xFFFF);
+
+        return uint64_t(pass & 0xF) << 60
+             | uint64_t(pipeline & 0x3FF) << 50
+             | uint64_t(material & 0x3FFF) << 36
+             | uint64_t(mesh & 0xFFFFF) << 16
+             | depthBits;
+    }
+
+    DrawQueue::DrawQueue(size_t workerCount)
+        : workerCount(workerCount ? workerCount : std::clamp<size_t>(std::thread::hardware_concurrency(), 1, 8)){}
+
+    DrawQueue::~DrawQueue()
+    {
+        // jthreads request a stop and join, the workers wait on a stop aware condition
+
+        workers.clear();
+    }
+
+    void DrawQueue::clear() noexcept
+    {
+        draws.clear();
+        entries.clear();
+    }
+
+    void DrawQueue::reserve(size_t drawCount)
+    {
+        draws.reserve(drawCount);
+        entries.reserve(drawCount);
+        scratch.reserve(drawCount);
+    }
+
+    void DrawQueue::push(uint64_t key, const Draw& draw)
+    {
+        entries.push_back({key, static_cast<uint32_t>(draws.size())});
+        draws.push_back(draw);
+    }
+
+    void DrawQueue::sort()
+    {
+        stats = {};
+        stats.draws = draws.size();
+        stats.unsortedBinds = countUnsortedBinds();
+
+        const auto start = Clock::now();
+        radixSort();
+        stats.sortMs = Milliseconds(Clock::now() - start).count();
+    }
+
+    void DrawQueue::record(const vk::CommandBuffer& cmdBuffer, const DynamicStateCommands* pDynamicState) noexcept
+    {
+        vk::Pipeline boundPipeline;
+        vk::DescriptorSet boundSet;
+        const Model* pBoundModel = nullptr;
+        const DrawState* pBoundState = nullptr;
+
+        for(const auto& entry : entries)
+        {
+            const Draw& draw = draws[entry.draw];
+
+            if(draw.pipeline && draw.pipeline != boundPipeline)
+            {
+                cmdBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, draw.pipeline);
+                boundPipeline = draw.pipeline;
+                boundSet = nullptr; // the new pipeline's layout may not be compatible with the bound set
+                pBoundState = nullptr; // static state of the new pipeline may have overwritten the dynamic values
+                stats.pipelineBinds++;
+            }
+
+            if(pDynamicState && draw.dynamicMask && draw.pState != pBoundState)
+            {
+                pDynamicState->set(cmdBuffer, draw.dynamicMask, *draw.pState);
+                pBoundState = draw.pState;
+                stats.stateSets++;
+            }
+
+            if(draw.descriptorSet && draw.descriptorSet != boundSet)
+            {
+                cmdBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, draw.layout, 1, draw.descriptorSet, {});
+                boundSet = draw.descriptorSet;
+                stats.descriptorBinds++;
+            }
+
+            if(draw.pModel != pBoundModel)
+            {
+                draw.pModel->bind(cmdBuffer);
+                pBoundModel = draw.pModel;
+                stats.vertexBufferBinds++;
+            }
+
+            // transforms go through the draw's layout, scene pipelines all share its push constant range;
+            // without a matrix only the indices that are set are pushed, the rest keeps what was pushed before
+
+            if(draw.pTransform)
+            {
+                const uint32_t objectIndex = draw.objectIndex == noIndex ? 0 : draw.objectIndex;
+                const uint32_t materialIndex = draw.materialIndex == noIndex ? 0 : draw.materialIndex;
+
+                Transforms::push(cmdBuffer, draw.layout, {*draw.pTransform, objectIndex, materialIndex});
+                stats.transformPushes++;
+            }
+            else
+            {
+                if(draw.objectIndex != noIndex)
+                {
+                    Transforms::pushObject(cmdBuffer, draw.layout, draw.objectIndex);
+                    stats.transformPushes++;
+                }
+
+                if(draw.materialIndex != noIndex)
+                {
+                    Transforms::pushMaterial(cmdBuffer, draw.layout, draw.materialIndex);
+                    stats.materialPushes++;
+                }
+            }
+
+            draw.pModel->draw(cmdBuffer, draw.instanceCount);
+        }
+    }
+
+    const DrawQueueStats& DrawQueue::getStats() const noexcept
+    {
+        return stats;
+    }
+
+    const DrawQueue::Draw& DrawQueue::getDraw(size_t position) const noexcept
+    {
+        return draws[entries[position].draw];
+    }
+
+    size_t DrawQueue::size() const noexcept
+    {
+        return draws.size();
+    }
+
+    void DrawQueue::radixSort()
+    {
+        // lsd radix sort over the key bytes, stable so equal keys keep their submission order
+
+        const size_t count = entries.size();
+        if(count < 2)
+            return;
+
+        // a byte every key shares does not reorder anything, most of the high bytes in practice
+
+        uint64_t differingBits = 0;
+        for(const auto& entry : entries)
+            differingBits |= entry.key ^ entries.front().key;
+
+        std::vector<uint32_t> shifts;
+        for(uint32_t shift = 0; shift < 64; shift += 8)
+            if((differingBits >> shift) & 0xFF)
+                shifts.push_back(shift);
+
+        if(shifts.empty())
+            return;
+
+        scratch.resize(count);
+
+        // every thread counts and scatters its own slice, slices are in order so the scatter stays stable
+
+        const size_t threadCount = count < parallelThreshold ? 1 : workerCount;
+
+        std::vector<std::array<size_t, 256>> bucketCounts(threadCount);
+        std::vector<std::array<size_t, 256>> bucketOffsets(threadCount);
+
+        Entry* src = entries.data();
+        Entry* dst = scratch.data();
+        bool counted = false;
+
+        auto onPhaseDone = [&]() noexcept
+        {
+            // after counting turns the counts into scatter offsets, after scattering swaps the buffers
+
+            if(!counted)
+            {
+                size_t offset = 0;
+                for(size_t bucket = 0; bucket < 256; bucket++)
+                    for(size_t thread = 0; thread < threadCount; thread++)
+                    {
+                        bucketOffsets[thread][bucket] = offset;
+                        offset += bucketCounts[thread][bucket];
+                    }
+            }
+            else
+                std::swap(src, dst);
+
+            counted = !counted;
+        };
+
+        std::barrier sync(static_cast<std::ptrdiff_t>(threadCount), onPhaseDone);
+
+        auto worker = [&](size_t thread)
+        {
+            const size_t begin = count * thread / threadCount;
+            const size_t end = count * (thread + 1) / threadCount;
+
+            for(uint32_t shift : shifts)
+            {
+                auto& counts = bucketCounts[thread];
+                counts.fill(0);
+
+                for(size_t i = begin; i < end; i++)
+                    counts[(src[i].key >> shift) & 0xFF]++;
+
+                sync.arrive_and_wait();
+
+                auto& offsets = bucketOffsets[thread];
+                for(size_t i = begin; i < end; i++)
+                    dst[offsets[(src[i].key >> shift) & 0xFF]++] = src[i];
+
+                sync.arrive_and_wait();
+            }
+        };
+
+        if(threadCount == 1)
+            worker(0);
+        else
+            runWorkers(worker);
+
+        // an odd number of passes leaves the result in the scratch buffer
+
+        if(src != entries.data())
+            entries.swap(scratch);
+    }
+
+    void DrawQueue::runWorkers(const std::function<void(size_t)>& job)
+    {
+        if(workers.empty())
+        {
+            workers.reserve(workerCount - 1);
+
+            for(size_t thread = 1; thread < workerCount; thread++)
+                workers.emplace_back([this, thread](std::stop_token stopToken){ work(stopToken, thread); });
+        }
+
+        {
+            std::lock_guard lock(workMutex);
+            pJob = &job;
+            busyWorkers = workers.size();
+            jobGeneration++;
+        }
+
+        workReady.notify_all();
+        job(0);
+
+        // the job references the caller's stack, it has to be done everywhere before returning
+
+        std::unique_lock lock(workMutex);
+        workDone.wait(lock, [&]{ return busyWorkers == 0; });
+        pJob = nullptr;
+    }
+
+    void DrawQueue::work(std::stop_token stopToken, size_t thread)
+    {
+        uint64_t doneGeneration = 0;
+
+        std::unique_lock lock(workMutex);
+        while(workReady.wait(lock, stopToken, [&]{ return jobGeneration != doneGeneration; }))
+        {
+            doneGeneration = jobGeneration;
+            const auto* pCurrentJob = pJob;
+
+            lock.unlock();
+            (*pCurrentJob)(thread);
+            lock.lock();
+
+            if(--busyWorkers == 0)
+                workDone.notify_one();
+        }
+    }
+
+    size_t DrawQueue::countUnsortedBinds() const noexcept
+    {
+        size_t binds = 0;
+        vk::Pipeline boundPipeline;
+        vk::DescriptorSet boundSet;
+        const Model* pBoundModel = nullptr;
+
+        for(const auto& draw : draws)
+        {
+            if(draw.pipeline && draw.pipeline != boundPipeline)
+            {
+                boundPipeline = draw.pipeline;
+                boundSet = nullptr;
+                binds++;
+            }
+
+            if(draw.descriptorSet && draw.descriptorSet != boundSet)
+            {
+                boundSet = draw.descriptorSet;
+                binds++;
+            }
+
+            if(draw.pModel != pBoundModel)
+            {
+                pBoundModel = draw.pModel;
+                binds++;
+            }
+        }
+
+        return binds;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,72 @@
+#include "dot_DynamicState.h"
+
+namespace dot
+{
+    uint64_t DrawState::key(uint32_t dynamicMask) const noexcept
+    {
+        // dynamic values do not change the pipeline, they are left out so draws differing only in them share one
+
+        uint64_t key = 0;
+        auto pack = [&](uint32_t bit, uint64_t value, uint32_t bits)
+        {
+            key = key << bits | (dynamicMask & bit ? 0 : value);
+        };
+
+        pack(DynamicCullMode, static_cast<uint64_t>(cullMode), 2);
+        pack(DynamicFrontFace, static_cast<uint64_t>(frontFace), 1);
+        pack(DynamicTopology, static_cast<uint64_t>(topology), 4);
+        pack(DynamicDepth, depthTest, 1);
+        pack(DynamicDepth, depthWrite, 1);
+        pack(DynamicDepth, static_cast<uint64_t>(depthCompare), 3);
+        pack(DynamicDepthBias, depthBias, 1);
+        pack(DynamicBlend, blend, 1);
+
+        return key;
+    }
+
+    void DynamicStateCommands::set(const vk::CommandBuffer& cmdBuffer, uint32_t mask, const DrawState& state) const noexcept
+    {
+        VkCommandBuffer cmd = cmdBuffer;
+
+        if(mask & DynamicCullMode)
+            cmdSetCullMode(cmd, static_cast<VkCullModeFlags>(state.cullMode));
+
+        if(mask & DynamicFrontFace)
+            cmdSetFrontFace(cmd, static_cast<VkFrontFace>(state.frontFace));
+
+        if(mask & DynamicTopology)
+            cmdSetPrimitiveTopology(cmd, static_cast<VkPrimitiveTopology>(state.topology));
+
+        if(mask & DynamicDepth)
+        {
+            cmdSetDepthTestEnable(cmd, state.depthTest);
+            cmdSetDepthWriteEnable(cmd, state.depthWrite);
+            cmdSetDepthCompareOp(cmd, static_cast<VkCompareOp>(state.depthCompare));
+        }
+
+        // the factors are dynamic with the enable, a pipeline baked without bias would otherwise keep zero factors
+
+        if(mask & DynamicDepthBias)
+        {
+            cmdSetDepthBiasEnable(cmd, state.depthBias);
+            vkCmdSetDepthBias(cmd, DrawState::depthBiasConstant, 0.0f, DrawState::depthBiasSlope);
+        }
+
+        if(mask & DynamicBlend)
+        {
+            const VkBool32 blendEnable = state.blend;
+            const VkColorBlendEquationEXT equation =
+            {
+                .srcColorBlendFactor = state.blend ? VK_BLEND_FACTOR_SRC_ALPHA : VK_BLEND_FACTOR_ONE,
+                .dstColorBlendFactor = state.blend ? VK_BLEND_FACTOR_ONE_MINUS_SRC_ALPHA : VK_BLEND_FACTOR_ZERO,
+                .colorBlendOp = VK_BLEND_OP_ADD,
+                .srcAlphaBlendFactor = VK_BLEND_FACTOR_ONE,
+                .dstAlphaBlendFactor = VK_BLEND_FACTOR_ZERO,
+                .alphaBlendOp = VK_BLEND_OP_ADD
+            };
+
+            cmdSetColorBlendEnable(cmd, 0, 1, &blendEnable);
+            cmdSetColorBlendEquation(cmd, 0, 1, &equation);
+        }
+    }
+}
\ No newline at end of file
@@ -1,47 +1,238 @@
 #include "dot_Engine.h"
+#include "dot_Profiler.h"
+
+#include <chrono>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
 
 namespace dot
 {
-    Engine::Engine(Window& wnd)
-        : wnd(wnd), device(wnd), renderer(wnd, device)
+    Engine::Engine(Window& wnd, const std::string& capturePath, const RendererConfig& rendererConfig)
+        : wnd(wnd), device(wnd), renderer(wnd, device, rendererConfig)
     {
+        if(!capturePath.empty())
+            pCapture = std::make_unique<CaptureWriter>(capturePath);
+
         loadModels();
     }
 
+    using Clock = std::chrono::steady_clock;
+
+    // upper bound for a single wait of the idle loop, keeps the loop responsive to flags set without an event
+
+    static constexpr double idleWaitTimeout = 0.5;
+
     void Engine::run()
     {
         while(!glfwWindowShouldClose(wnd))
+            tick();
+    }
+
+    void Engine::setRenderMode(RenderMode mode) noexcept
+    {
+        renderMode = mode;
+        invalidate();
+    }
+
+    void Engine::setCommandCaching(bool enabled) noexcept
+    {
+        // a capture has to see every draw, cached frames do not issue them
+
+        renderer.setCommandCaching(enabled && !pCapture);
+    }
+
+    Result<> Engine::setSampleCount(uint32_t count) noexcept
+    {
+        DOT_TRY(renderer.setSampleCount(count));
+        invalidate(DirtyScene);
+
+        return {};
+    }
+
+    void Engine::invalidate(uint32_t dirtyFlags) noexcept
+    {
+        dirty |= dirtyFlags;
+        glfwPostEmptyEvent(); // wakes the loop when it is waiting for events
+    }
+
+    double Engine::idleCpuUsage(double seconds)
+    {
+        // runs the on demand loop over a static scene, returns process cpu time relative to wall time
+
+        setRenderMode(RenderMode::OnDemand);
+
+        while(dirty && !glfwWindowShouldClose(wnd))
+            tick();
+
+        const auto wallStart = Clock::now();
+        const std::clock_t cpuStart = std::clock();
+
+        while(std::chrono::duration<double>(Clock::now() - wallStart).count() < seconds && !glfwWindowShouldClose(wnd))
+            tick();
+
+        const double cpuTime = double(std::clock() - cpuStart) / CLOCKS_PER_SEC;
+        const double wallTime = std::chrono::duration<double>(Clock::now() - wallStart).count();
+
+        return cpuTime / wallTime;
+    }
+
+    void Engine::tick()
+    {
+        if(wnd.Minimized())
         {
+            // nothing can be presented, sleeps until the window is restored or closed
+            glfwWaitEvents();
+            return;
+        }
+
+        // a shader reload in flight keeps frames coming until the new pipeline is swapped in
+
+        const bool reloading = renderer.shaderReloadPending();
+
+        if(renderMode == RenderMode::OnDemand && !dirty && !reloading && !wnd.Damaged())
+            glfwWaitEventsTimeout(idleWaitTimeout);
+        else
             glfwPollEvents();
 
-            renderer.beginFrame();
-            updateFrame();
-            renderFrame();
-            renderer.endFrame();
+        if(wnd.Damaged())
+        {
+            wnd.Damaged(false);
+            dirty |= DirtyResize;
+        }
+
+        // the last presented image stays on screen, acquire and submit are skipped until it is outdated
+
+        if(renderMode == RenderMode::OnDemand && !dirty && !reloading)
+            return;
+
+        DOT_CHECK(renderer.beginFrame());
+        if(!renderer.frameStarted())
+            return;
+
+        const auto now = Clock::now();
+        const double deltaTime = std::chrono::duration<double>(now - lastFrame).count();
+        lastFrame = now;
+
+        dirty = 0; // changes made while updating the frame are part of it
+
+        if(pCapture)
+        {
+            captureResize();
+            pCapture->frameBegin(deltaTime);
+            pCapture->pipelineBind(0); // the renderer binds its single pipeline at the start of every frame
+        }
+
+        updateFrame(deltaTime);
+        renderFrame();
+        DOT_CHECK(renderer.endFrame());
+
+        if(pCapture)
+            pCapture->frameEnd();
+
+        // the startup profile is printed on request like the extension list, interactive runs stay quiet
+
+        if(firstFrame)
+        {
+            if(std::getenv("DOT_VERBOSE"))
+            {
+                std::cout << "Time to first frame: " << Profiler::sinceStart() << " ms\n";
+                Profiler::report(std::cout);
+            }
+
+            firstFrame = false;
         }
     }
 
-    void Engine::updateFrame()
+    BenchmarkResult Engine::benchmark(const BenchmarkConfig& config)
+    {
+        Benchmark benchmark(wnd, device, renderer);
+        return benchmark.run(config);
+    }
+
+    void Engine::microbench(size_t iterations)
+    {
+        Microbench microbench(device, renderer, iterations);
+        microbench.run();
+        microbench.report(std::cout);
+    }
+
+    void Engine::replay(const ReplayConfig& config)
+    {
+        Replay replay(wnd, device, renderer);
+        replay.run(config);
+    }
+
+    void Engine::updateFrame(double deltaTime)
     {
 
     }
 
     void Engine::renderFrame()
     {
-        const auto& cmdBufferGfx = renderer.getCurrentCmdBufferGfx();
+        drawQueue.clear();
+        drawModel(triangle);
+        drawQueue.sort();
+
+        DOT_CHECK(renderer.recordScene(drawListVersion, [this](const vk::CommandBuffer& cmdBuffer){ drawQueue.record(cmdBuffer); }));
+    }
+
+    void Engine::captureResize()
+    {
+        int width, height;
+        glfwGetWindowSize(wnd, &width, &height);
+
+        if(width != capturedWidth || height != capturedHeight)
+        {
+            pCapture->resize(width, height);
+            capturedWidth = width;
+            capturedHeight = height;
+        }
+    }
+
+    uint32_t Engine::createModel(const std::vector<Model::Vertex>& verticies)
+    {
+        const auto id = static_cast<uint32_t>(models.size());
+        models.emplace_back(std::make_unique<Model>(device, verticies));
+        dirty |= DirtyScene;
+        drawListVersion++;
+
+        if(pCapture)
+            pCapture->modelCreate(id, verticies);
+
+        return id;
+    }
+
+    void Engine::writeModel(uint32_t id, const std::vector<Model::Vertex>& verticies)
+    {
+        models[id]->write(verticies);
+        dirty |= DirtyScene;
+        drawListVersion++;
+
+        if(pCapture)
+            pCapture->modelWrite(id, verticies);
+    }
+
+    void Engine::drawModel(uint32_t id, uint32_t instanceCount)
+    {
+        // the capture keeps submission order, the queue reorders by state when the frame is recorded
 
-        triangle->bind(cmdBufferGfx);
-        triangle->draw(cmdBufferGfx);
+        drawQueue.push(DrawQueue::makeKey(0, 0, 0, id, models[id]->getDepth()), {models[id].get(), instanceCount});
+
+        if(pCapture)
+            pCapture->draw(id, instanceCount);
     }
 
     void Engine::loadModels()
     {
+        DOT_PROFILE_SCOPE("model_upload");
+
         std::vector<Model::Vertex> verticies =
         {
-            {{0.0f, -0.5f}, {1.0f, 0.0f, 0.0f}},
-            {{0.5f, 0.5f}, {0.0f, 1.0f, 0.0f}},
-            {{-0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}}
+            {{0.0f, -0.5f, 0.5f}, {1.0f, 0.0f, 0.0f}},
+            {{0.5f, 0.5f, 0.5f}, {0.0f, 1.0f, 0.0f}},
+            {{-0.5f, 0.5f, 0.5f}, {0.0f, 0.0f, 1.0f}}
         };
-        triangle = std::make_unique<Model>(device, verticies);
+        triangle = createModel(verticies);
     }
 }
\ No newline at end of file
@@ -0,0 +1,135 @@
+#include "dot_Image.h"
+#include "dot_Exception.h"
+
+namespace dot
+{
+    Image::Image
+    (
+        Device& device,
+        const vk::Extent2D& extent, const vk::Format& format,
+        const vk::ImageUsageFlags& usage, const vk::MemoryPropertyFlags& memoryProperty,
+        const vk::ImageAspectFlags& aspect, vk::SampleCountFlagBits samples
+    )
+        : extent(extent), format(format), device(device)
+    {
+        createImage(usage, memoryProperty, samples);
+        createView(aspect);
+    }
+
+    Image::~Image()
+    {
+        destroyImage();
+    }
+
+    Image::operator const vk::Image&() const noexcept
+    {
+        return image;
+    }
+
+    const vk::ImageView& Image::getView() const noexcept
+    {
+        return view;
+    }
+
+    const vk::Format& Image::getFormat() const noexcept
+    {
+        return format;
+    }
+
+    void Image::createImage(const vk::ImageUsageFlags& usage, const vk::MemoryPropertyFlags& memoryProperty, vk::SampleCountFlagBits samples)
+    {
+        vk::ImageCreateInfo createInfo
+        (
+            vk::ImageCreateFlags(0U),                     // flags
+            vk::ImageType::e2D,                           // imageType
+            format,                                       // format
+            vk::Extent3D(extent.width, extent.height, 1), // extent
+            1,                                            // mipLevels
+            1,                                            // arrayLayers
+            samples,                                      // samples
+            vk::ImageTiling::eOptimal,                    // tiling
+            usage,                                        // usage
+            vk::SharingMode::eExclusive,                  // sharingMode
+            {},                                           // queueFamilyIndices
+            vk::ImageLayout::eUndefined                   // initialLayout
+        );
+
+        try
+        {
+            image = device.getVkDevice().createImage(createInfo);
+        }
+        catch(const std::runtime_error& e)
+        {
+            throw DOT_RUNTIME_WHAT(e);
+        }
+
+        vk::MemoryRequirements memRequirements = device.getVkDevice().getImageMemoryRequirements(image);
+        try
+        {
+            // lazily allocated memory only exists on tiled gpus, elsewhere transient attachments get regular memory
+
+            vk::MemoryPropertyFlags properties = memoryProperty;
+            if(!device.hasMemoryType(memRequirements.memoryTypeBits, properties))
+                properties &= ~vk::MemoryPropertyFlags(vk::MemoryPropertyFlagBits::eLazilyAllocated);
+
+            uint32_t memTypeIndex = device.getMemoryType(memRequirements.memoryTypeBits, properties);
+            vk::MemoryAllocateInfo allocateInfo(memRequirements.size, memTypeIndex);
+
+            memory = device.getVkDevice().allocateMemory(allocateInfo);
+            allocationSize = memRequirements.size;
+        }
+        catch(const std::runtime_error& e)
+        {
+            throw DOT_RUNTIME_WHAT(e);
+        }
+
+        device.getVkDevice().bindImageMemory(image, memory, 0);
+        device.memoryAllocated(allocationSize);
+    }
+
+    void Image::createView(const vk::ImageAspectFlags& aspect)
+    {
+        vk::ImageSubresourceRange subresourceRange
+        (
+            aspect, // aspectMask
+            0,      // baseMipLevel
+            1,      // levelCount
+            0,      // baseArrayLayer
+            1       // layerCount
+        );
+
+        vk::ImageViewCreateInfo createInfo
+        (
+            vk::ImageViewCreateFlags(0U),   // flags
+            image,                          // image
+            vk::ImageViewType::e2D,         // viewType
+            format,                         // format
+            vk::ComponentMapping(),         // components
+            subresourceRange                // subresourceRange
+        );
+
+        try
+        {
+            view = device.getVkDevice().createImageView(createInfo);
+        }
+        catch(const std::runtime_error& e)
+        {
+            throw DOT_RUNTIME_WHAT(e);
+        }
+    }
+
+    void Image::destroyImage() noexcept
+    {
+        auto destroy = [&device = device, image = image, memory = memory, view = view, allocationSize = allocationSize]
+        {
+            device.getVkDevice().destroyImageView(view);
+            device.getVkDevice().destroyImage(image);
+            device.getVkDevice().freeMemory(memory);
+            device.memoryFreed(allocationSize);
+        };
+
+        // attachments are destroyed with a retired swapchain, frames still in flight may use them
+
+        device.retire(destroy);
+    }
+}
\ No newline at end of file
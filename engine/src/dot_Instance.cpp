@@ -1,21 +1,26 @@
 #include "dot_Instance.h"
 #include "dot_Exception.h"
+#include "dot_Profiler.h"
+#include "dot_Logger.h"
 
 #include "GLFW/glfw3.h"
 
 #include <set>
+#include <cstdlib>
 #include <iostream>
 
 namespace dot
 {
     Instance::Instance()
     {
+        DOT_PROFILE_SCOPE("instance");
+
         vk::ApplicationInfo appInfo(
             appName.c_str(),            // pApplicationName
             1,                          // applicationVersion
             nullptr,                    // pEngineName
             1,                          // engineVersion
-            VK_API_VERSION_1_1          // apiVersion
+            VK_API_VERSION_1_2          // apiVersion
         );
 
         vk::InstanceCreateInfo createInfo
@@ -34,7 +39,11 @@ namespace dot
 
             createInfo.enabledLayerCount = static_cast<uint32_t>(validationLayers.size());
             createInfo.ppEnabledLayerNames = validationLayers.data();
-            createInfo.pNext = reinterpret_cast<vk::DebugUtilsMessengerCreateInfoEXT*>(&debugMessengerInfo); 
+
+            // with every category or severity filtered out there is nothing to report, an empty mask is invalid
+
+            if(debugMessengerInfo.messageSeverity && debugMessengerInfo.messageType)
+                createInfo.pNext = reinterpret_cast<vk::DebugUtilsMessengerCreateInfoEXT*>(&debugMessengerInfo);
         }
         else
         {
@@ -55,7 +64,11 @@ namespace dot
         if(_validationLayersEnabled)
         {
             createDebugMessenger();
-            displayExtensionsInfo(requiredExtensions);
+
+            // enumerating and printing every extension is slow, only done on request
+
+            if(std::getenv("DOT_VERBOSE"))
+                displayExtensionsInfo(requiredExtensions);
         }
     }
 
@@ -140,6 +153,11 @@ namespace dot
 
     void Instance::createDebugMessenger()
     {
+        // the messenger stays null and destroying a null one is a no-op
+
+        if(!debugMessengerInfo.messageSeverity || !debugMessengerInfo.messageType)
+            return;
+
         try
         {
             debugMessenger = inst.createDebugUtilsMessengerEXT(debugMessengerInfo, nullptr, dldi);
@@ -158,21 +176,59 @@ namespace dot
         void* pUserData
     )
     {
-        std::cerr << "Validation layer: " << pCallbackData->pMessage << '\n';
+        // called on whichever thread the driver uses, only queues the message for the logger thread
+
+        LogCategory category = LogCategory::General;
+        if(messageType & VK_DEBUG_UTILS_MESSAGE_TYPE_VALIDATION_BIT_EXT)
+            category = LogCategory::Validation;
+        else if(messageType & VK_DEBUG_UTILS_MESSAGE_TYPE_PERFORMANCE_BIT_EXT)
+            category = LogCategory::Performance;
+
+        LogSeverity severity = LogSeverity::Verbose;
+        if(messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_ERROR_BIT_EXT)
+            severity = LogSeverity::Error;
+        else if(messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_WARNING_BIT_EXT)
+            severity = LogSeverity::Warning;
+        else if(messageSeverity & VK_DEBUG_UTILS_MESSAGE_SEVERITY_INFO_BIT_EXT)
+            severity = LogSeverity::Info;
+
+        static_cast<Logger*>(pUserData)->log(severity, category, pCallbackData->messageIdNumber, pCallbackData->pMessage);
 
         return VK_FALSE;
     }
 
     void Instance::createDebugMessengerCreateInfo() noexcept
     {
+        // filtered at registration so the driver never calls back for messages the logger would discard
+
+        Logger& logger = Logger::get();
+        const auto& config = logger.getConfig();
+
+        vk::DebugUtilsMessageSeverityFlagsEXT severities;
+        if(config.severities & uint32_t(LogSeverity::Verbose))
+            severities |= vk::DebugUtilsMessageSeverityFlagBitsEXT::eVerbose;
+        if(config.severities & uint32_t(LogSeverity::Info))
+            severities |= vk::DebugUtilsMessageSeverityFlagBitsEXT::eInfo;
+        if(config.severities & uint32_t(LogSeverity::Warning))
+            severities |= vk::DebugUtilsMessageSeverityFlagBitsEXT::eWarning;
+        if(config.severities & uint32_t(LogSeverity::Error))
+            severities |= vk::DebugUtilsMessageSeverityFlagBitsEXT::eError;
+
+        vk::DebugUtilsMessageTypeFlagsEXT types;
+        if(config.categories & uint32_t(LogCategory::General))
+            types |= vk::DebugUtilsMessageTypeFlagBitsEXT::eGeneral;
+        if(config.categories & uint32_t(LogCategory::Validation))
+            types |= vk::DebugUtilsMessageTypeFlagBitsEXT::eValidation;
+        if(config.categories & uint32_t(LogCategory::Performance))
+            types |= vk::DebugUtilsMessageTypeFlagBitsEXT::ePerformance;
+
         debugMessengerInfo = vk::DebugUtilsMessengerCreateInfoEXT
         (
-            vk::DebugUtilsMessengerCreateFlagsEXT(0U),                                                                  // flags
-            vk::DebugUtilsMessageSeverityFlagBitsEXT::eVerbose | vk::DebugUtilsMessageSeverityFlagBitsEXT::eWarning |   // messageSeverity
-            vk::DebugUtilsMessageSeverityFlagBitsEXT::eError | vk::DebugUtilsMessageSeverityFlagBitsEXT::eInfo,
-            vk::DebugUtilsMessageTypeFlagBitsEXT::eGeneral | vk::DebugUtilsMessageTypeFlagBitsEXT::eValidation |        // messageType 
-            vk::DebugUtilsMessageTypeFlagBitsEXT::ePerformance,
-            debugCallback                                                                                               // pFnUserCallback
+            vk::DebugUtilsMessengerCreateFlagsEXT(0U),  // flags
+            severities,                                 // messageSeverity
+            types,                                      // messageType 
+            debugCallback,                              // pFnUserCallback
+            &logger                                     // pUserData
         );
     }
 }
\ No newline at end of file
@@ -0,0 +1,171 @@
+#include "dot_LayoutCache.h"
+#include "dot_Exception.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace dot
+{
+    LayoutCache::LayoutCache(const vk::Device& device)
+        : device(device)
+    {
+    }
+
+    LayoutCache::~LayoutCache()
+    {
+        for(const auto& [key, layout] : pipelineLayouts)
+            device.destroyPipelineLayout(layout);
+
+        for(const auto& [key, layout] : setLayouts)
+            device.destroyDescriptorSetLayout(layout);
+    }
+
+    size_t LayoutCache::KeyHash::operator()(const Key& key) const noexcept
+    {
+        // fnv-1a over the words
+
+        uint64_t hash = 14695981039346656037ULL;
+        for(uint32_t word : key)
+            hash = (hash ^ word) * 1099511628211ULL;
+
+        return static_cast<size_t>(hash);
+    }
+
+    vk::DescriptorSetLayout LayoutCache::getSetLayout
+    (
+        std::span<const vk::DescriptorSetLayoutBinding> bindings, vk::DescriptorSetLayoutCreateFlags flags,
+        std::span<const vk::DescriptorBindingFlags> bindingFlags
+    )
+    {
+        // bindings in any order describe the same layout, immutable samplers are not supported by the key
+
+        std::vector<std::pair<vk::DescriptorSetLayoutBinding, vk::DescriptorBindingFlags>> sorted;
+        sorted.reserve(bindings.size());
+        for(size_t i = 0; i < bindings.size(); i++)
+            sorted.emplace_back(bindings[i], i < bindingFlags.size() ? bindingFlags[i] : vk::DescriptorBindingFlags());
+
+        std::sort(sorted.begin(), sorted.end(), [](const auto& a, const auto& b){ return a.first.binding < b.first.binding; });
+
+        Key key = {static_cast<uint32_t>(flags)};
+        for(const auto& [binding, bindingFlag] : sorted)
+        {
+            key.insert
+            (
+                key.end(),
+                {
+                    binding.binding, static_cast<uint32_t>(binding.descriptorType), binding.descriptorCount, static_cast<uint32_t>(binding.stageFlags),
+                    static_cast<uint32_t>(bindingFlag)
+                }
+            );
+        }
+
+        std::lock_guard lock(mutex);
+
+        if(auto found = setLayouts.find(key); found != setLayouts.end())
+        {
+            stats.hits++;
+            return found->second;
+        }
+
+        std::vector<vk::DescriptorSetLayoutBinding> sortedBindings;
+        std::vector<vk::DescriptorBindingFlags> sortedFlags;
+        for(const auto& [binding, bindingFlag] : sorted)
+        {
+            sortedBindings.push_back(binding);
+            sortedFlags.push_back(bindingFlag);
+        }
+
+        // binding flags are only chained when given, they need descriptor indexing
+
+        vk::DescriptorSetLayoutBindingFlagsCreateInfo flagsInfo(sortedFlags);
+        vk::DescriptorSetLayoutCreateInfo createInfo(flags, sortedBindings, bindingFlags.empty() ? nullptr : &flagsInfo);
+
+        vk::DescriptorSetLayout layout;
+
+        try
+        {
+            layout = device.createDescriptorSetLayout(createInfo);
+        }
+        catch(const std::runtime_error& e)
+        {
+            throw DOT_RUNTIME_WHAT(e);
+        }
+
+        setLayouts.emplace(std::move(key), layout);
+        stats.setLayouts++;
+
+        return layout;
+    }
+
+    vk::PipelineLayout LayoutCache::getPipelineLayout(const vk::PipelineLayoutCreateInfo& createInfo)
+    {
+        // set layouts are compared by handle, the ones from this cache are already unique per description
+
+        Key key = {static_cast<uint32_t>(createInfo.flags), createInfo.setLayoutCount};
+        for(uint32_t i = 0; i < createInfo.setLayoutCount; i++)
+        {
+            const uint64_t handle = std::bit_cast<uint64_t>(static_cast<VkDescriptorSetLayout>(createInfo.pSetLayouts[i]));
+            key.insert(key.end(), {static_cast<uint32_t>(handle), static_cast<uint32_t>(handle >> 32)});
+        }
+
+        for(uint32_t i = 0; i < createInfo.pushConstantRangeCount; i++)
+        {
+            const vk::PushConstantRange& range = createInfo.pPushConstantRanges[i];
+            key.insert(key.end(), {static_cast<uint32_t>(range.stageFlags), range.offset, range.size});
+        }
+
+        std::lock_guard lock(mutex);
+
+        if(auto found = pipelineLayouts.find(key); found != pipelineLayouts.end())
+        {
+            stats.hits++;
+            return found->second;
+        }
+
+        vk::PipelineLayout layout;
+
+        try
+        {
+            layout = device.createPipelineLayout(createInfo);
+        }
+        catch(const std::runtime_error& e)
+        {
+            throw DOT_RUNTIME_WHAT(e);
+        }
+
+        pipelineLayouts.emplace(std::move(key), layout);
+        stats.pipelineLayouts++;
+
+        return layout;
+    }
+
+    vk::PipelineLayout LayoutCache::getPipelineLayout(const ShaderLayout& shaderLayout, std::span<const std::pair<uint32_t, vk::DescriptorSetLayout>> fixedSets)
+    {
+        // sets the shaders skip get an empty layout, set numbers stay the indices the shaders use; fixed sets are
+        // shared with other pipelines as they are, like the bindless set whose runtime arrays have no size to reflect
+
+        uint32_t setCount = shaderLayout.setCount();
+        for(const auto& [set, setLayout] : fixedSets)
+            setCount = std::max(setCount, set + 1);
+
+        std::vector<vk::DescriptorSetLayout> layouts;
+        for(uint32_t set = 0; set < setCount; set++)
+        {
+            auto fixed = std::find_if(fixedSets.begin(), fixedSets.end(), [set](const auto& fixedSet){ return fixedSet.first == set; });
+            layouts.push_back(fixed != fixedSets.end() ? fixed->second : getSetLayout(shaderLayout.setBindings(set)));
+        }
+
+        return getPipelineLayout(vk::PipelineLayoutCreateInfo
+        (
+            vk::PipelineLayoutCreateFlags(0U),  // flags
+            layouts,                            // setLayouts
+            shaderLayout.pushConstants          // pushConstantRanges
+        ));
+    }
+
+    LayoutCacheStats LayoutCache::getStats() const noexcept
+    {
+        std::lock_guard lock(mutex);
+        return stats;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,362 @@
+#include "dot_Logger.h"
+
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+
+#if defined(__unix__) || defined(__APPLE__)
+    #include <fcntl.h>
+    #include <unistd.h>
+#endif
+
+namespace dot
+{
+    using Clock = std::chrono::steady_clock;
+
+    static uint64_t nowUs() noexcept
+    {
+        return std::chrono::duration_cast<std::chrono::microseconds>(Clock::now().time_since_epoch()).count();
+    }
+
+    static const uint64_t startUs = nowUs();
+
+    Logger& Logger::get()
+    {
+        static Logger logger;
+        return logger;
+    }
+
+    Logger::Logger()
+        : severities(config.severities), categories(config.categories)
+    {
+        flusher = std::thread(&Logger::flushLoop, this);
+    }
+
+    Logger::~Logger()
+    {
+        {
+            std::lock_guard<std::mutex> lock(flushMutex);
+            running = false;
+        }
+
+        flushCondition.notify_one();
+        flusher.join();
+    }
+
+    void Logger::configure(const LoggerConfig& config)
+    {
+        this->config = config;
+        severities = config.severities;
+        categories = config.categories;
+
+        std::strncpy(crashDumpPath, config.crashDumpPath.c_str(), sizeof(crashDumpPath) - 1);
+
+        #if defined(__unix__) || defined(__APPLE__)
+            if(!config.crashDumpPath.empty())
+                for(int signal : {SIGSEGV, SIGABRT, SIGFPE, SIGILL, SIGBUS})
+                    std::signal(signal, crashHandler);
+        #endif
+    }
+
+    const LoggerConfig& Logger::getConfig() const noexcept
+    {
+        return config;
+    }
+
+    bool Logger::enabled(LogSeverity severity, LogCategory category) const noexcept
+    {
+        return (severities.load(std::memory_order_relaxed) & uint32_t(severity)) &&
+               (categories.load(std::memory_order_relaxed) & uint32_t(category));
+    }
+
+    void Logger::log(LogSeverity severity, LogCategory category, int32_t messageId, const char* message) noexcept
+    {
+        if(!enabled(severity, category))
+            return;
+
+        Queue* queue = localQueue();
+
+        Entry entry;
+        entry.timeUs = nowUs() - startUs;
+        entry.severity = severity;
+        entry.category = category;
+        entry.messageId = messageId;
+
+        // a message longer than the entry is cut at a character boundary and marked with an ellipsis
+
+        static constexpr char ellipsis[] = "\xE2\x80\xA6";   // utf-8 …
+        const size_t length = std::strlen(message);
+
+        if(length < sizeof(entry.message))
+        {
+            entry.length = static_cast<uint32_t>(length);
+            std::memcpy(entry.message, message, length);
+        }
+        else
+        {
+            size_t cut = sizeof(entry.message) - sizeof(ellipsis);
+            while(cut > 0 && (static_cast<unsigned char>(message[cut]) & 0xC0) == 0x80)
+                cut--;
+
+            std::memcpy(entry.message, message, cut);
+            std::memcpy(entry.message + cut, ellipsis, sizeof(ellipsis) - 1);
+            entry.length = static_cast<uint32_t>(cut + sizeof(ellipsis) - 1);
+        }
+
+        entry.message[entry.length] = '\0';
+
+        if(!queue || !queue->push(entry))
+            dropped.fetch_add(1, std::memory_order_relaxed);
+
+        // only the first entry since the last drain wakes the flusher
+
+        if(!pending.exchange(true, std::memory_order_acq_rel))
+            flushCondition.notify_one();
+    }
+
+    void Logger::flush()
+    {
+        std::lock_guard<std::mutex> lock(flushMutex);
+
+        drain();
+
+        std::string out;
+        writeRepeats(out);
+        std::cerr << out << std::flush;
+    }
+
+    void Logger::dumpCrashBuffer(std::ostream& os) const
+    {
+        const size_t next = crashBufferNext;
+        const size_t count = std::min(next, crashBufferSize);
+
+        std::string out;
+        for(size_t i = next - count; i < next; i++)
+            format(crashBuffer[i % crashBufferSize], out);
+
+        os << out;
+    }
+
+    bool Logger::Queue::push(const Entry& entry) noexcept
+    {
+        const size_t t = tail.load(std::memory_order_relaxed);
+
+        if(t - head.load(std::memory_order_acquire) == capacity)
+            return false;
+
+        entries[t % capacity] = entry;
+        tail.store(t + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    bool Logger::Queue::pop(Entry& entry) noexcept
+    {
+        const size_t h = head.load(std::memory_order_relaxed);
+
+        if(h == tail.load(std::memory_order_acquire))
+            return false;
+
+        entry = entries[h % capacity];
+        head.store(h + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    const Logger::Entry* Logger::Queue::pending(size_t index) const noexcept
+    {
+        const size_t h = head.load(std::memory_order_acquire);
+
+        if(h + index >= tail.load(std::memory_order_acquire))
+            return nullptr;
+
+        return &entries[(h + index) % capacity];
+    }
+
+    Logger::Queue* Logger::localQueue() noexcept
+    {
+        // a queue is registered once per thread, the only time a producer takes a lock
+
+        thread_local Queue* queue = nullptr;
+
+        if(!queue)
+        {
+            try
+            {
+                auto newQueue = std::make_unique<Queue>();
+
+                std::lock_guard<std::mutex> lock(queuesMutex);
+                queues.push_back(std::move(newQueue));
+                queue = queues.back().get();
+            }
+            catch(...)
+            {
+                return nullptr;
+            }
+        }
+
+        return queue;
+    }
+
+    void Logger::flushLoop()
+    {
+        auto lastRepeatReport = Clock::now();
+
+        // woken by the first entry logged since the last drain, the timeout only paces the repeat report and covers a
+        // wake that lands between checking the flag and going to sleep, producers never take the lock
+
+        std::unique_lock<std::mutex> lock(flushMutex);
+        while(running)
+        {
+            flushCondition.wait_for(lock, std::chrono::seconds(1), [this]{ return !running || pending.load(std::memory_order_acquire); });
+            pending.store(false, std::memory_order_release);
+
+            drain();
+
+            if(Clock::now() - lastRepeatReport > std::chrono::seconds(1))
+            {
+                std::string out;
+                writeRepeats(out);
+                std::cerr << out;
+                lastRepeatReport = Clock::now();
+            }
+        }
+
+        drain();
+
+        std::string out;
+        writeRepeats(out);
+        std::cerr << out << std::flush;
+    }
+
+    void Logger::drain()
+    {
+        std::vector<Queue*> snapshot;
+        {
+            std::lock_guard<std::mutex> lock(queuesMutex);
+            for(const auto& queue : queues)
+                snapshot.push_back(queue.get());
+        }
+
+        std::vector<Entry> batch;
+        Entry entry;
+        for(auto* queue : snapshot)
+            while(queue->pop(entry))
+                batch.push_back(entry);
+
+        const uint64_t droppedCount = dropped.exchange(0, std::memory_order_relaxed);
+        if(batch.empty() && !droppedCount)
+            return;
+
+        // queues are per thread, sorting restores the global order of the batch
+
+        std::stable_sort(batch.begin(), batch.end(), [](const Entry& a, const Entry& b){ return a.timeUs < b.timeUs; });
+
+        std::string out;
+        for(const auto& entry : batch)
+            write(entry, out);
+
+        if(droppedCount)
+            out += "[logger] " + std::to_string(droppedCount) + " messages dropped, queue full\n";
+
+        std::cerr << out;
+    }
+
+    void Logger::write(const Entry& entry, std::string& out)
+    {
+        crashBuffer[crashBufferNext % crashBufferSize] = entry;
+        crashBufferNext++;
+
+        // repeated validation messages are printed once and then only counted
+
+        if(entry.category == LogCategory::Validation && entry.messageId != 0 && seen[entry.messageId]++ > 0)
+        {
+            repeats[entry.messageId]++;
+            return;
+        }
+
+        format(entry, out);
+    }
+
+    void Logger::writeRepeats(std::string& out)
+    {
+        for(const auto& [messageId, count] : repeats)
+        {
+            char line[96];
+            std::snprintf(line, sizeof(line), "[validation] message 0x%08x repeated %llu more times\n", uint32_t(messageId), (unsigned long long)count);
+            out += line;
+        }
+
+        repeats.clear();
+    }
+
+    void Logger::format(const Entry& entry, std::string& out)
+    {
+        auto severityName = [](LogSeverity severity)
+        {
+            switch(severity)
+            {
+                case LogSeverity::Verbose:  return "verbose";
+                case LogSeverity::Info:     return "info";
+                case LogSeverity::Warning:  return "warning";
+                case LogSeverity::Error:    return "error";
+            }
+            return "unknown";
+        };
+
+        auto categoryName = [](LogCategory category)
+        {
+            switch(category)
+            {
+                case LogCategory::General:      return "general";
+                case LogCategory::Validation:   return "validation";
+                case LogCategory::Performance:  return "performance";
+                case LogCategory::Engine:       return "engine";
+            }
+            return "unknown";
+        };
+
+        char prefix[64];
+        std::snprintf(prefix, sizeof(prefix), "[%10.3f ms][%s][%s] ", entry.timeUs / 1000.0, severityName(entry.severity), categoryName(entry.category));
+
+        out += prefix;
+        out.append(entry.message, entry.length);
+        out += '\n';
+    }
+
+    void Logger::crashHandler(int signal)
+    {
+        // binary layout: {uint32 magic "DOTL", uint32 entry size}, then raw entries oldest first
+        // only async signal safe calls from here on
+
+        #if defined(__unix__) || defined(__APPLE__)
+            Logger& logger = get();
+
+            int fd = ::open(logger.crashDumpPath, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+            if(fd >= 0)
+            {
+                const uint32_t header[] = {0x4C544F44, uint32_t(sizeof(Entry))};
+                [[maybe_unused]] auto written = ::write(fd, header, sizeof(header));
+
+                const size_t next = logger.crashBufferNext;
+                const size_t count = std::min(next, crashBufferSize);
+                for(size_t i = next - count; i < next; i++)
+                    written = ::write(fd, &logger.crashBuffer[i % crashBufferSize], sizeof(Entry));
+
+                // entries not drained yet are the newest ones
+
+                for(const auto& queue : logger.queues)
+                    for(size_t i = 0; const Entry* entry = queue->pending(i); i++)
+                        written = ::write(fd, entry, sizeof(Entry));
+
+                ::close(fd);
+            }
+        #endif
+
+        std::signal(signal, SIG_DFL);
+        std::raise(signal);
+    }
+}
\ No newline at end of file
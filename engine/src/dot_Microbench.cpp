@@ -0,0 +1,270 @@
+#include "dot_Microbench.h"
+#include "dot_Buffer.h"
+#include "dot_Pipeline.h"
+#include "dot_Descriptors.h"
+#include "dot_Exception.h"
+
+#include "Shader.h"
+
+#include <chrono>
+#include <iomanip>
+
+namespace dot
+{
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    Microbench::Microbench(Device& device, Renderer& renderer, size_t iterations)
+        : device(device), renderer(renderer), iterations(iterations), warmupIterations(iterations / 10 + 1){}
+
+    const std::vector<MicrobenchResult>& Microbench::run()
+    {
+        results.clear();
+
+        benchBufferCreateDestroy();
+        benchBufferWrite();
+        benchCopyBuffer();
+        benchShaderModule();
+        benchPipeline();
+        benchCmdBufferAlloc();
+        benchDescriptors();
+
+        return results;
+    }
+
+    void Microbench::report(std::ostream& os) const
+    {
+        os << std::left << std::setw(32) << "benchmark"
+           << std::right << std::setw(8) << "iters"
+           << std::setw(12) << "mean ms" << std::setw(12) << "median ms" << std::setw(12) << "stddev ms"
+           << std::setw(12) << "min ms" << std::setw(12) << "p95 ms" << std::setw(12) << "GB/s" << '\n';
+
+        for(const auto& result : results)
+        {
+            const auto& stats = result.stats;
+
+            os << std::left << std::setw(32) << result.name
+               << std::right << std::setw(8) << stats.count << std::fixed << std::setprecision(4)
+               << std::setw(12) << stats.mean << std::setw(12) << stats.median << std::setw(12) << stats.stddev
+               << std::setw(12) << stats.min << std::setw(12) << stats.p95;
+
+            if(result.bytes && stats.median > 0.0)
+                os << std::setw(12) << std::setprecision(2) << result.bytes / (stats.median * 1.0e6);
+            else
+                os << std::setw(12) << '-';
+
+            os << '\n' << std::defaultfloat;
+        }
+    }
+
+    void Microbench::measure(const std::string& name, const std::function<void()>& fn, vk::DeviceSize bytes)
+    {
+        for(size_t i = 0; i < warmupIterations; i++)
+            fn();
+
+        std::vector<double> samples;
+        samples.reserve(iterations);
+
+        for(size_t i = 0; i < iterations; i++)
+        {
+            const auto start = Clock::now();
+            fn();
+            samples.push_back(Milliseconds(Clock::now() - start).count());
+        }
+
+        results.push_back({name, Statistics(std::move(samples)), bytes});
+    }
+
+    void Microbench::benchBufferCreateDestroy()
+    {
+        for(vk::DeviceSize size : {vk::DeviceSize(4096), vk::DeviceSize(16 << 20)})
+        {
+            measure("buffer_create_destroy/" + std::to_string(size), [&]
+            {
+                Buffer buffer
+                (
+                    device, size, 1,
+                    vk::BufferUsageFlagBits::eVertexBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal
+                );
+            });
+        }
+    }
+
+    void Microbench::benchBufferWrite()
+    {
+        const vk::DeviceSize maxSize = 16 << 20;
+        std::vector<char> source(maxSize, 1);
+
+        Buffer buffer
+        (
+            device, maxSize, 1,
+            vk::BufferUsageFlagBits::eTransferSrc, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+        );
+
+        for(vk::DeviceSize size : {vk::DeviceSize(256), vk::DeviceSize(4 << 10), vk::DeviceSize(64 << 10), vk::DeviceSize(1 << 20), maxSize})
+            measure("buffer_write/" + std::to_string(size), [&]{ DOT_CHECK(buffer.write(source.data(), size)); }, size);
+    }
+
+    void Microbench::benchCopyBuffer()
+    {
+        const vk::DeviceSize maxSize = 64 << 20;
+
+        Buffer src
+        (
+            device, maxSize, 1,
+            vk::BufferUsageFlagBits::eTransferSrc, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+        );
+        Buffer dst
+        (
+            device, maxSize, 1,
+            vk::BufferUsageFlagBits::eTransferDst, vk::MemoryPropertyFlagBits::eDeviceLocal
+        );
+
+        // the smallest copy measures submission latency, the largest one transfer bandwidth
+
+        for(vk::DeviceSize size : {vk::DeviceSize(256), vk::DeviceSize(1 << 20), maxSize})
+            measure("copy_buffer/" + std::to_string(size), [&]{ DOT_CHECK(device.copyBuffer(src, dst, size)); }, size);
+    }
+
+    void Microbench::benchShaderModule()
+    {
+        const std::string path = "engine/shaders/vert.spv";
+        const std::vector<char> code = Shader::readCode(path);
+
+        vk::ShaderModuleCreateInfo createInfo
+        (
+            vk::ShaderModuleCreateFlags(0U),                // flags
+            code.size(),                                    // codeSize
+            reinterpret_cast<const uint32_t*>(code.data())  // pCode
+        );
+
+        measure("shader_module_create", [&]
+        {
+            device.getVkDevice().destroyShaderModule(device.getVkDevice().createShaderModule(createInfo));
+        });
+
+        // the embedded copy looked up by name, a reloaded shader's code is loaded from memory the same way
+
+        measure("shader_module_create_from_path", [&]{ Shader shader(device, path); });
+        measure("shader_module_create_from_code", [&]{ Shader shader(device); shader.load(code); });
+    }
+
+    void Microbench::benchPipeline()
+    {
+        PipelineConfig pipelineConfig;
+        renderer.defaultPipelineConfig(pipelineConfig);
+
+        // modules and layout are made once, only the pipeline compile is timed
+
+        const Shader vertShader(device, "engine/shaders/vert.spv");
+        const Shader fragShader(device, "engine/shaders/frag.spv");
+        const vk::PipelineLayout layout = Pipeline::layoutFor(device, pipelineConfig, vertShader.getCode(), fragShader.getCode());
+
+        const vk::Device& vkDevice = device.getVkDevice();
+
+        measure("pipeline_create/no_cache", [&]
+        {
+            vkDevice.destroyPipeline(Pipeline::create(device, vertShader, fragShader, layout, pipelineConfig));
+        });
+
+        measure("pipeline_create/cache", [&]
+        {
+            vkDevice.destroyPipeline(Pipeline::create(device, vertShader, fragShader, layout, pipelineConfig, device.getPipelineCache()));
+        });
+    }
+
+    void Microbench::benchCmdBufferAlloc()
+    {
+        const vk::Device& vkDevice = device.getVkDevice();
+
+        vk::CommandBufferAllocateInfo allocInfo
+        (
+            device.getCmdPoolGfx(),             // commandPool
+            vk::CommandBufferLevel::ePrimary,   // level
+            1                                   // commandBufferCount
+        );
+
+        measure("cmd_buffer_alloc_free", [&]
+        {
+            auto cmdBuffers = vkDevice.allocateCommandBuffers(allocInfo);
+            vkDevice.freeCommandBuffers(device.getCmdPoolGfx(), cmdBuffers);
+        });
+
+        measure("transfer_cmd_begin_end", [&]
+        {
+            auto cmdBuffer = device.beginTransferCmd();
+            DOT_CHECK(cmdBuffer);
+            DOT_CHECK(device.endTransferCmd(cmdBuffer.value()));
+        });
+    }
+
+    void Microbench::benchDescriptors()
+    {
+        // a thousand sets of four uniform buffers per iteration, like the per draw sets of a frame
+
+        const size_t setCount = 1000;
+        const uint32_t bindingCount = 4;
+
+        Buffer buffer
+        (
+            device, 256 * bindingCount, 1,
+            vk::BufferUsageFlagBits::eUniformBuffer, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
+        );
+
+        std::vector<vk::DescriptorSetLayoutBinding> bindings;
+        std::vector<DescriptorInfo> infos;
+        std::vector<vk::DescriptorBufferInfo> bufferInfos;
+        for(uint32_t i = 0; i < bindingCount; i++)
+        {
+            bindings.emplace_back(i, vk::DescriptorType::eUniformBuffer, 1, vk::ShaderStageFlagBits::eVertex | vk::ShaderStageFlagBits::eFragment);
+            infos.push_back(DescriptorInfo::fromBuffer(buffer, 256 * i, 256));
+            bufferInfos.emplace_back(buffer, 256 * i, 256);
+        }
+
+        Descriptors descriptors(device, 1);
+        const DescriptorLayout& layout = descriptors.getLayout(bindings);
+
+        // one pool sized for the iteration and a write per binding, what the engine would do without the allocator
+
+        const vk::Device& vkDevice = device.getVkDevice();
+        const vk::DescriptorPoolSize poolSize(vk::DescriptorType::eUniformBuffer, static_cast<uint32_t>(setCount * bindingCount));
+        const vk::DescriptorPool pool = vkDevice.createDescriptorPool({vk::DescriptorPoolCreateFlags(0U), static_cast<uint32_t>(setCount), poolSize});
+
+        measure("descriptor_sets/writes", [&]
+        {
+            vkDevice.resetDescriptorPool(pool);
+
+            for(size_t i = 0; i < setCount; i++)
+            {
+                const vk::DescriptorSet set = vkDevice.allocateDescriptorSets({pool, layout.setLayout}).front();
+
+                std::vector<vk::WriteDescriptorSet> writes;
+                for(uint32_t binding = 0; binding < bindingCount; binding++)
+                    writes.emplace_back(set, binding, 0, vk::DescriptorType::eUniformBuffer, nullptr, bufferInfos[binding]);
+
+                vkDevice.updateDescriptorSets(writes, {});
+            }
+        });
+
+        vkDevice.destroyDescriptorPool(pool);
+
+        measure("descriptor_sets/frame_template", [&]
+        {
+            descriptors.beginFrame(0);
+
+            for(size_t i = 0; i < setCount; i++)
+                DOT_CHECK(descriptors.allocateFrame(layout, infos));
+        });
+
+        // sixteen distinct contents, every lookup after the first iteration is a hit
+
+        measure("descriptor_sets/cached", [&]
+        {
+            for(size_t i = 0; i < setCount; i++)
+            {
+                infos[0] = DescriptorInfo::fromBuffer(buffer, 0, 16 + 16 * (i % 16));
+                DOT_CHECK(descriptors.getCached(layout, infos));
+            }
+        });
+    }
+}
\ No newline at end of file
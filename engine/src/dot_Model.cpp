@@ -18,7 +18,7 @@ namespace dot
         std::vector<vk::VertexInputAttributeDescription> attributeDescriptions;
         attributeDescriptions.reserve(2);
 
-        attributeDescriptions.emplace_back(vk::VertexInputAttributeDescription(0, 0, vk::Format::eR32G32Sfloat, offsetof(Vertex, pos)));
+        attributeDescriptions.emplace_back(vk::VertexInputAttributeDescription(0, 0, vk::Format::eR32G32B32Sfloat, offsetof(Vertex, pos)));
         attributeDescriptions.emplace_back(vk::VertexInputAttributeDescription(1, 0, vk::Format::eR32G32B32Sfloat, offsetof(Vertex, color)));
 
         return attributeDescriptions;
@@ -30,10 +30,21 @@ namespace dot
         createVertexBuffer(verticies);
     }
 
-    void Model::createVertexBuffer(const std::vector<Vertex>& verticies) noexcept
+    void Model::write(const std::vector<Vertex>& verticies)
+    {
+        createVertexBuffer(verticies);
+    }
+
+    void Model::createVertexBuffer(const std::vector<Vertex>& verticies)
     {
         uint32_t vertexSize = sizeof(Vertex);
         vertexCount = static_cast<uint32_t>(verticies.size());
+
+        depth = 0.0f;
+        for(const auto& vertex : verticies)
+            depth += vertex.pos.z;
+        depth = vertexCount ? depth / vertexCount : 0.0f;
+
         vk::DeviceSize bufferSize = vertexSize * vertexCount;
         auto usageFlags = vk::BufferUsageFlagBits::eTransferSrc;
         auto memoryFlags = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
@@ -43,7 +54,7 @@ namespace dot
             device, vertexSize, vertexCount,
             vk::BufferUsageFlagBits::eTransferSrc, vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent
         );
-        stagingBuffer.write((void*) verticies.data());
+        DOT_CHECK(stagingBuffer.write((void*) verticies.data()));
 
         vertexBuffer = std::make_unique<Buffer>
         (
@@ -51,7 +62,7 @@ namespace dot
             vk::BufferUsageFlagBits::eTransferDst | vk::BufferUsageFlagBits::eVertexBuffer, vk::MemoryPropertyFlagBits::eDeviceLocal
         );
 
-        device.copyBuffer(stagingBuffer, vertexBuffer->getVkBuffer(), bufferSize);
+        DOT_CHECK(device.copyBuffer(stagingBuffer, vertexBuffer->getVkBuffer(), bufferSize));
     }
 
     void Model::bind(const vk::CommandBuffer& cmdBuffer) const noexcept
@@ -59,8 +70,13 @@ namespace dot
         cmdBuffer.bindVertexBuffers(0, vertexBuffer->getVkBuffer(), {0});
     }
 
-    void Model::draw(const vk::CommandBuffer& cmdBuffer) const noexcept
+    void Model::draw(const vk::CommandBuffer& cmdBuffer, uint32_t instanceCount) const noexcept
+    {
+        cmdBuffer.draw(vertexCount, instanceCount, 0, 0);
+    }
+
+    float Model::getDepth() const noexcept
     {
-        cmdBuffer.draw(vertexCount, 1, 0, 0);
+        return depth;
     }
 }
\ No newline at end of file
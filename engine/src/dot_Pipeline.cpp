@@ -1,23 +1,61 @@
 #include "dot_Pipeline.h"
 #include "dot_Model.h"
 #include "dot_Exception.h"
+#include "dot_Logger.h"
+#include "dot_ShaderReflection.h"
 
 #include "Shader.h"
 
+#include <algorithm>
+#include <bit>
+#include <string>
+
 namespace dot
 {
+    uint64_t ShaderFeatures::key() const noexcept
+    {
+        return uint64_t(vertexColor)
+             | uint64_t(instancing) << 1
+             | uint64_t(alphaTest) << 2
+             | uint64_t(std::min(lightCount, maxLightCount)) << 3
+             | uint64_t(std::bit_cast<uint32_t>(alphaCutoff)) << 11
+             | uint64_t(objectBuffer) << 43;
+    }
+
     Pipeline::Pipeline
     (
         Device& device, 
         const std::string& vertPath, const std::string& fragPath, 
-        const PipelineConfig& pipelineConfig
+        const PipelineConfig& pipelineConfig, const vk::PipelineCache& cache
+    )
+    : device(device), vertShader(device), fragShader(device)
+    {
+        try
+        {
+            vertShader.read(vertPath);
+            fragShader.read(fragPath);
+        }
+        catch(const std::runtime_error& e)
+        {
+            throw DOT_RUNTIME_WHAT(e);
+        }
+
+        createLayout(pipelineConfig);
+        createPipeline(pipelineConfig, cache);
+    }
+
+    Pipeline::Pipeline
+    (
+        Device& device, 
+        std::vector<char> vertCode, std::vector<char> fragCode, 
+        const PipelineConfig& pipelineConfig, const vk::PipelineCache& cache
     )
     : device(device), vertShader(device), fragShader(device)
     {
         try
         {
-            vertShader.read("engine/shaders/vert.spv");
-            fragShader.read("engine/shaders/frag.spv");
+            vertShader.load(std::move(vertCode));
+            fragShader.load(std::move(fragCode));
         }
         catch(const std::runtime_error& e)
         {
@@ -25,13 +63,12 @@ namespace dot
         }
 
         createLayout(pipelineConfig);
-        createPipeline(pipelineConfig);
+        createPipeline(pipelineConfig, cache);
     }
 
     Pipeline::~Pipeline()
     {
         device.getVkDevice().destroyPipeline(pipeline);
-        device.getVkDevice().destroyPipelineLayout(layout);
     }
 
     Pipeline::operator const vk::Pipeline&() const noexcept
@@ -39,26 +76,59 @@ namespace dot
         return pipeline;
     }
 
+    const vk::PipelineLayout& Pipeline::getLayout() const noexcept
+    {
+        return layout;
+    }
+
     void Pipeline::createLayout(const PipelineConfig& pipelineConfig)
     {
-        try
-        {
-            layout = device.getVkDevice().createPipelineLayout(pipelineConfig.layoutInfo);
-        }
-        catch(const std::runtime_error& e)
+        layout = layoutFor(device, pipelineConfig, vertShader.getCode(), fragShader.getCode());
+    }
+
+    vk::PipelineLayout Pipeline::layoutFor(Device& device, const PipelineConfig& pipelineConfig, std::span<const uint32_t> vertCode, std::span<const uint32_t> fragCode)
+    {
+        // mismatches surface here with the shader named instead of as undefined behaviour at draw time
+
+        ShaderLayout shaderLayout = ShaderLayout::reflect(vertCode);
+        shaderLayout.merge(ShaderLayout::reflect(fragCode));
+
+        for(const auto& [set, binding] : pipelineConfig.dynamicBuffers)
+            shaderLayout.makeDynamic(set, binding);
+
+        shaderLayout.validateVertexInput(pipelineConfig.attributeDescriptions);
+
+        // a constant without a map entry keeps its default, fine unless the feature was meant to reach it
+
+        for(uint32_t id : shaderLayout.specConstants)
         {
-            throw DOT_RUNTIME_WHAT(e);
+            const auto& entries = pipelineConfig.specializationEntries;
+            if(std::none_of(entries.begin(), entries.end(), [&](const auto& entry){ return entry.constantID == id; }))
+                DOT_LOG(Warning, Engine, "Specialization constant " + std::to_string(id) + " is not set by the pipeline config")
         }
+
+        LayoutCache& cache = device.getLayoutCache();
+        return pipelineConfig.reflectLayout ? cache.getPipelineLayout(shaderLayout, pipelineConfig.fixedSetLayouts) : cache.getPipelineLayout(pipelineConfig.layoutInfo);
     }
 
-    void Pipeline::createPipeline(const PipelineConfig& pipelineConfig)
+    void Pipeline::createPipeline(const PipelineConfig& pipelineConfig, const vk::PipelineCache& cache)
+    {
+        pipeline = create(device, vertShader, fragShader, layout, pipelineConfig, cache);
+    }
+
+    vk::Pipeline Pipeline::create
+    (
+        Device& device, const vk::ShaderModule& vertShader, const vk::ShaderModule& fragShader,
+        const vk::PipelineLayout& layout, const PipelineConfig& pipelineConfig, const vk::PipelineCache& cache
+    )
     {
         vk::PipelineShaderStageCreateInfo vertShaderStageInfo
         (
             vk::PipelineShaderStageCreateFlags(0U), // flags
             vk::ShaderStageFlagBits::eVertex,       // stage
             vertShader,                             // module
-            "main"                                  // pName
+            "main",                                 // pName
+            &pipelineConfig.specializationInfo      // pSpecializationInfo
         );
 
         vk::PipelineShaderStageCreateInfo fragShaderStageInfo
@@ -66,7 +136,8 @@ namespace dot
             vk::PipelineShaderStageCreateFlags(0U), // flags
             vk::ShaderStageFlagBits::eFragment,     // stage
             fragShader,                             // module
-            "main"                                  // pName
+            "main",                                 // pName
+            &pipelineConfig.specializationInfo      // pSpecializationInfo
         );
 
         std::vector<vk::PipelineShaderStageCreateInfo> shaderStagesInfo = {vertShaderStageInfo, fragShaderStageInfo};
@@ -89,9 +160,12 @@ namespace dot
             pipelineConfig.subpass                  // subpass 
         );
 
+        if(!pipelineConfig.renderPass)
+            createInfo.pNext = &pipelineConfig.renderingInfo;
+
         try
         {
-            pipeline = device.getVkDevice().createGraphicsPipeline(nullptr, createInfo).value;
+            return device.getVkDevice().createGraphicsPipeline(cache, createInfo).value;
         }
         catch(const std::runtime_error& e)
         {
@@ -99,7 +173,7 @@ namespace dot
         }
     }
 
-    void Pipeline::defaultConfig(PipelineConfig& pipelineConfig, const vk::RenderPass& renderPass)
+    void Pipeline::defaultConfig(PipelineConfig& pipelineConfig, const vk::RenderPass& renderPass, vk::SampleCountFlagBits samples)
     {
         pipelineConfig.bindingDescriptions = std::move(Model::Vertex::getBindingDescription());
         pipelineConfig.attributeDescriptions = std::move(Model::Vertex::getAttributeDescription());
@@ -144,11 +218,28 @@ namespace dot
         pipelineConfig.multisampleStateInfo = vk::PipelineMultisampleStateCreateInfo
         (
             vk::PipelineMultisampleStateCreateFlags(0U),    // flags
-            vk::SampleCountFlagBits::e1,                    // rasterizationSamples
+            samples,                                        // rasterizationSamples
             VK_FALSE,                                       // sampleShadingEnable
             1.0f                                            // minSampleShading
         );
 
+        // ignored by render passes without a depth attachment; with one, opaque draws sorted front to back
+        // let early depth testing reject hidden fragments before shading
+
+        pipelineConfig.stencilStateInfo = vk::PipelineDepthStencilStateCreateInfo
+        (
+            vk::PipelineDepthStencilStateCreateFlags(0U),   // flags
+            VK_TRUE,                                        // depthTestEnable
+            VK_TRUE,                                        // depthWriteEnable
+            vk::CompareOp::eLess,                           // depthCompareOp
+            VK_FALSE,                                       // depthBoundsTestEnable
+            VK_FALSE,                                       // stencilTestEnable
+            {},                                             // front
+            {},                                             // back
+            0.0f,                                           // minDepthBounds
+            1.0f                                            // maxDepthBounds
+        );
+
         pipelineConfig.colorBlendAttachmentState = vk::PipelineColorBlendAttachmentState
         (
             VK_FALSE,                                                           // blendEnable
@@ -178,8 +269,156 @@ namespace dot
             pipelineConfig.dynamicStates                // dynamicStates
         );
 
+        featureConfig(pipelineConfig, {});
+
+        // the scene shaders' camera and object buffers, bound with an offset into the frame's region
+
+        pipelineConfig.reflectLayout = true;
+        pipelineConfig.dynamicBuffers = {{0, 0}, {0, 1}};
+
         pipelineConfig.renderPass = renderPass;
 
         pipelineConfig.subpass = 0;
     }
+
+    void Pipeline::renderingConfig(PipelineConfig& pipelineConfig, std::vector<vk::Format> colorFormats, vk::Format depthFormat)
+    {
+        // the pipeline is built against the attachment formats instead of a render pass, resizes never affect it
+
+        pipelineConfig.colorFormats = std::move(colorFormats);
+
+        pipelineConfig.renderingInfo = vk::PipelineRenderingCreateInfoKHR
+        (
+            0,                                  // viewMask
+            pipelineConfig.colorFormats,        // colorAttachmentFormats
+            depthFormat,                        // depthAttachmentFormat
+            vk::Format::eUndefined              // stencilAttachmentFormat
+        );
+
+        pipelineConfig.renderPass = nullptr;
+        pipelineConfig.subpass = 0;
+    }
+
+    void Pipeline::featureConfig(PipelineConfig& pipelineConfig, const ShaderFeatures& features)
+    {
+        // constants a shader does not declare are ignored, one info serves both stages
+
+        pipelineConfig.features = features;
+        pipelineConfig.features.lightCount = std::min(features.lightCount, ShaderFeatures::maxLightCount);
+        pipelineConfig.specializationData =
+        {
+            features.vertexColor,
+            features.instancing,
+            features.alphaTest,
+            pipelineConfig.features.lightCount,
+            std::bit_cast<uint32_t>(features.alphaCutoff),
+            features.objectBuffer
+        };
+
+        pipelineConfig.specializationEntries.clear();
+        for(uint32_t id = 0; id < pipelineConfig.specializationData.size(); id++)
+            pipelineConfig.specializationEntries.emplace_back(id, id * sizeof(uint32_t), sizeof(uint32_t));
+
+        pipelineConfig.specializationInfo = vk::SpecializationInfo
+        (
+            pipelineConfig.specializationEntries,   // mapEntries
+            pipelineConfig.specializationData       // data
+        );
+    }
+
+    void Pipeline::drawStateConfig(PipelineConfig& pipelineConfig, const DrawState& state)
+    {
+        pipelineConfig.inputAssemblyStateInfo.topology = state.topology;
+
+        pipelineConfig.rasterizationStateInfo.cullMode = state.cullMode;
+        pipelineConfig.rasterizationStateInfo.frontFace = state.frontFace;
+        pipelineConfig.rasterizationStateInfo.depthBiasEnable = state.depthBias;
+        pipelineConfig.rasterizationStateInfo.depthBiasConstantFactor = state.depthBias ? DrawState::depthBiasConstant : 0.0f;
+        pipelineConfig.rasterizationStateInfo.depthBiasSlopeFactor = state.depthBias ? DrawState::depthBiasSlope : 0.0f;
+
+        pipelineConfig.stencilStateInfo.depthTestEnable = state.depthTest;
+        pipelineConfig.stencilStateInfo.depthWriteEnable = state.depthWrite;
+        pipelineConfig.stencilStateInfo.depthCompareOp = state.depthCompare;
+
+        pipelineConfig.colorBlendAttachmentState.blendEnable = state.blend;
+        pipelineConfig.colorBlendAttachmentState.srcColorBlendFactor = state.blend ? vk::BlendFactor::eSrcAlpha : vk::BlendFactor::eOne;
+        pipelineConfig.colorBlendAttachmentState.dstColorBlendFactor = state.blend ? vk::BlendFactor::eOneMinusSrcAlpha : vk::BlendFactor::eZero;
+        pipelineConfig.colorBlendStateInfo.setAttachments(pipelineConfig.colorBlendAttachmentState);
+    }
+
+    void Pipeline::dynamicStateConfig(PipelineConfig& pipelineConfig, uint32_t dynamicMask)
+    {
+        // the baked values of dynamic states are ignored, draws must set them before drawing with the pipeline
+
+        pipelineConfig.dynamicMask = dynamicMask;
+
+        if(dynamicMask & DynamicCullMode)
+            pipelineConfig.dynamicStates.push_back(vk::DynamicState::eCullModeEXT);
+
+        if(dynamicMask & DynamicFrontFace)
+            pipelineConfig.dynamicStates.push_back(vk::DynamicState::eFrontFaceEXT);
+
+        if(dynamicMask & DynamicTopology)
+            pipelineConfig.dynamicStates.push_back(vk::DynamicState::ePrimitiveTopologyEXT);
+
+        if(dynamicMask & DynamicDepth)
+        {
+            pipelineConfig.dynamicStates.push_back(vk::DynamicState::eDepthTestEnableEXT);
+            pipelineConfig.dynamicStates.push_back(vk::DynamicState::eDepthWriteEnableEXT);
+            pipelineConfig.dynamicStates.push_back(vk::DynamicState::eDepthCompareOpEXT);
+        }
+
+        if(dynamicMask & DynamicDepthBias)
+        {
+            pipelineConfig.dynamicStates.push_back(vk::DynamicState::eDepthBiasEnableEXT);
+            pipelineConfig.dynamicStates.push_back(vk::DynamicState::eDepthBias);
+        }
+
+        if(dynamicMask & DynamicBlend)
+        {
+            pipelineConfig.dynamicStates.push_back(vk::DynamicState::eColorBlendEnableEXT);
+            pipelineConfig.dynamicStates.push_back(vk::DynamicState::eColorBlendEquationEXT);
+        }
+
+        pipelineConfig.dynamicStateInfo.setDynamicStates(pipelineConfig.dynamicStates);
+    }
+
+    void Pipeline::bindlessConfig(PipelineConfig& pipelineConfig, uint32_t set, const vk::DescriptorSetLayout& setLayout)
+    {
+        // the global set is bound once for every pipeline using it, its layout has to be the identical one
+
+        pipelineConfig.fixedSetLayouts.emplace_back(set, setLayout);
+    }
+
+    void Pipeline::postConfig(PipelineConfig& pipelineConfig, const vk::RenderPass& renderPass, uint32_t subpass, const vk::DescriptorSetLayout& setLayout)
+    {
+        defaultConfig(pipelineConfig, renderPass);
+
+        // a full screen triangle generated from the vertex index, no vertex buffer, depth or culling
+
+        pipelineConfig.bindingDescriptions.clear();
+        pipelineConfig.attributeDescriptions.clear();
+        pipelineConfig.vertexStateInfo = vk::PipelineVertexInputStateCreateInfo();
+
+        pipelineConfig.rasterizationStateInfo.cullMode = vk::CullModeFlagBits::eNone;
+
+        pipelineConfig.stencilStateInfo.depthTestEnable = VK_FALSE;
+        pipelineConfig.stencilStateInfo.depthWriteEnable = VK_FALSE;
+
+        // the input image and the reciprocal of the target extent for effects sampling neighbours
+
+        pipelineConfig.setLayouts = {setLayout};
+        pipelineConfig.pushConstantRanges = {vk::PushConstantRange(vk::ShaderStageFlagBits::eFragment, 0, 2 * sizeof(float))};
+
+        pipelineConfig.layoutInfo = vk::PipelineLayoutCreateInfo
+        (
+            vk::PipelineLayoutCreateFlags(0U),  // flags
+            pipelineConfig.setLayouts,          // setLayouts
+            pipelineConfig.pushConstantRanges   // pushConstantRanges
+        );
+        pipelineConfig.reflectLayout = false;
+        pipelineConfig.dynamicBuffers.clear();
+
+        pipelineConfig.subpass = subpass;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,360 @@
+#include "dot_PipelineLibrary.h"
+#include "dot_Exception.h"
+#include "dot_Logger.h"
+
+#include "Shader.h"
+
+#include <algorithm>
+#include <chrono>
+
+namespace dot
+{
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    PipelineLibrary::PipelineLibrary(Device& device, ConfigFn baseConfig, uint32_t dynamicMask, const vk::PipelineCache& cache, bool linkParts)
+        : baseConfig(std::move(baseConfig)), dynamicMask(dynamicMask), cache(cache), useLibraries(linkParts && device.pipelineLibraryEnabled()), device(device){}
+
+    PipelineLibrary::~PipelineLibrary()
+    {
+        const vk::Device& vkDevice = device.getVkDevice();
+
+        for(auto& [key, variant] : variants)
+        {
+            if(variant.optimized.valid())
+            {
+                try
+                {
+                    vkDevice.destroyPipeline(variant.optimized.get());
+                }
+                catch(...){}
+            }
+
+            vkDevice.destroyPipeline(variant.pipeline);
+        }
+
+        for(const auto& [key, part] : parts)
+            vkDevice.destroyPipeline(part);
+    }
+
+    vk::Pipeline PipelineLibrary::get(const std::string& vertPath, const std::string& fragPath, const DrawState& state, const ShaderFeatures& features)
+    {
+        const VariantKey key{vertPath, fragPath, state.key(dynamicMask), features.key()};
+
+        if(auto found = variants.find(key); found != variants.end())
+            return found->second.pipeline;
+
+        if(!layout)
+            createLayout(vertPath, fragPath);
+
+        Variant variant;
+
+        if(!useLibraries)
+        {
+            const auto start = Clock::now();
+            variant.pipeline = createComplete(vertPath, fragPath, state, features);
+
+            const double ms = Milliseconds(Clock::now() - start).count();
+            stats.linkMs += ms;
+            stats.linkMsMax = std::max(stats.linkMsMax, ms);
+        }
+        else
+        {
+            std::vector<vk::Pipeline> variantParts =
+            {
+                getPart(VertexInput, {}, state, features),
+                getPart(PreRasterization, vertPath, state, features),
+                getPart(FragmentShader, fragPath, state, features),
+                getPart(FragmentOutput, {}, state, features)
+            };
+
+            const auto start = Clock::now();
+            variant.pipeline = link(variantParts, false);
+
+            const double ms = Milliseconds(Clock::now() - start).count();
+            stats.linkMs += ms;
+            stats.linkMsMax = std::max(stats.linkMsMax, ms);
+
+            // parts live as long as the library, the background link only reads handles and the cache
+
+            variant.optimized = std::async(std::launch::async, [this, variantParts = std::move(variantParts)]
+            {
+                return link(variantParts, true);
+            });
+        }
+
+        stats.variants++;
+
+        return variants.emplace(key, std::move(variant)).first->second.pipeline;
+    }
+
+    bool PipelineLibrary::update() noexcept
+    {
+        bool swapped = false;
+
+        for(auto& [key, variant] : variants)
+        {
+            if(!variant.optimized.valid() || variant.optimized.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+                continue;
+
+            // a failed optimized link keeps the fast linked pipeline, it is complete and correct, only slower
+
+            vk::Pipeline optimized;
+            try
+            {
+                optimized = variant.optimized.get();
+            }
+            catch(const std::exception& e)
+            {
+                Logger::get().log(LogSeverity::Warning, LogCategory::Engine, 0, e.what());
+                continue;
+            }
+
+            auto destroy = [&device = device, pipeline = variant.pipeline]
+            {
+                device.getVkDevice().destroyPipeline(pipeline);
+            };
+
+            device.retire(destroy);
+
+            variant.pipeline = optimized;
+            stats.optimized++;
+            swapped = true;
+        }
+
+        return swapped;
+    }
+
+    const vk::PipelineLayout& PipelineLibrary::getLayout() const noexcept
+    {
+        return layout;
+    }
+
+    bool PipelineLibrary::linking() const noexcept
+    {
+        return std::any_of(variants.begin(), variants.end(), [](const auto& entry){ return entry.second.optimized.valid(); });
+    }
+
+    const PipelineLibraryStats& PipelineLibrary::getStats() const noexcept
+    {
+        return stats;
+    }
+
+    void PipelineLibrary::createLayout(const std::string& vertPath, const std::string& fragPath)
+    {
+        // every part and variant uses this one layout, identical handles are trivially compatible when linking;
+        // a reflected layout comes from the shaders of the first variant
+
+        PipelineConfig pipelineConfig;
+        baseConfig(pipelineConfig);
+
+        Shader vertShader(device.getVkDevice());
+        Shader fragShader(device.getVkDevice());
+
+        try
+        {
+            vertShader.read(vertPath);
+            fragShader.read(fragPath);
+        }
+        catch(const std::runtime_error& e)
+        {
+            throw DOT_RUNTIME_WHAT(e);
+        }
+
+        layout = Pipeline::layoutFor(device, pipelineConfig, vertShader.getCode(), fragShader.getCode());
+    }
+
+    vk::Pipeline PipelineLibrary::getPart(Part part, const std::string& shaderPath, const DrawState& state, const ShaderFeatures& features)
+    {
+        // states a part does not consume are masked out of its key, variants differing only in them share it;
+        // parts without a shader are not specialized
+
+        const uint64_t featuresKey = shaderPath.empty() ? 0 : features.key();
+        const PartKey key{part, shaderPath, state.key(dynamicMask | (DynamicAll & ~partStates(part))), featuresKey};
+
+        if(auto found = parts.find(key); found != parts.end())
+            return found->second;
+
+        const auto start = Clock::now();
+        const vk::Pipeline pipeline = createPart(part, shaderPath, state, features);
+        stats.partMs += Milliseconds(Clock::now() - start).count();
+        stats.parts++;
+
+        parts.emplace(key, pipeline);
+
+        return pipeline;
+    }
+
+    vk::Pipeline PipelineLibrary::createPart(Part part, const std::string& shaderPath, const DrawState& state, const ShaderFeatures& features) const
+    {
+        PipelineConfig pipelineConfig;
+        configure(pipelineConfig, state, features);
+
+        Shader shader(device.getVkDevice());
+        std::vector<vk::PipelineShaderStageCreateInfo> shaderStagesInfo;
+
+        if(!shaderPath.empty())
+        {
+            try
+            {
+                shader.read(shaderPath);
+            }
+            catch(const std::runtime_error& e)
+            {
+                throw DOT_RUNTIME_WHAT(e);
+            }
+
+            shaderStagesInfo.emplace_back
+            (
+                vk::PipelineShaderStageCreateFlags(0U),                                                             // flags
+                part == PreRasterization ? vk::ShaderStageFlagBits::eVertex : vk::ShaderStageFlagBits::eFragment,   // stage
+                shader,                                                                                             // module
+                "main",                                                                                             // pName
+                &pipelineConfig.specializationInfo                                                                  // pSpecializationInfo
+            );
+        }
+
+        // the implementation only reads the states of the part being compiled, the rest of the config is ignored
+
+        vk::GraphicsPipelineLibraryCreateInfoEXT libraryInfo(partFlags(part));
+        if(!pipelineConfig.renderPass)
+            libraryInfo.pNext = &pipelineConfig.renderingInfo;
+
+        vk::GraphicsPipelineCreateInfo createInfo
+        (
+            vk::PipelineCreateFlagBits::eLibraryKHR |                   // flags
+            vk::PipelineCreateFlagBits::eRetainLinkTimeOptimizationInfoEXT,
+            shaderStagesInfo,                                           // shaderStagesInfo
+            &pipelineConfig.vertexStateInfo,                            // pVertexInputState
+            &pipelineConfig.inputAssemblyStateInfo,                     // pInputAssemblyState
+            &pipelineConfig.tessellationStateInfo,                      // pTessellationState
+            &pipelineConfig.viewportStateInfo,                          // pViewportState
+            &pipelineConfig.rasterizationStateInfo,                     // pRasterizationState
+            &pipelineConfig.multisampleStateInfo,                       // pMultisampleState
+            &pipelineConfig.stencilStateInfo,                           // pDepthStencilState
+            &pipelineConfig.colorBlendStateInfo,                        // pColorBlendState
+            &pipelineConfig.dynamicStateInfo,                           // pDynamicState
+            layout,                                                     // layout
+            pipelineConfig.renderPass,                                  // renderPass
+            pipelineConfig.subpass                                      // subpass
+        );
+        createInfo.pNext = &libraryInfo;
+
+        try
+        {
+            return device.getVkDevice().createGraphicsPipeline(cache, createInfo).value;
+        }
+        catch(const std::runtime_error& e)
+        {
+            throw DOT_RUNTIME_WHAT(e);
+        }
+    }
+
+    vk::Pipeline PipelineLibrary::createComplete(const std::string& vertPath, const std::string& fragPath, const DrawState& state, const ShaderFeatures& features) const
+    {
+        PipelineConfig pipelineConfig;
+        configure(pipelineConfig, state, features);
+
+        Shader vertShader(device.getVkDevice());
+        Shader fragShader(device.getVkDevice());
+
+        try
+        {
+            vertShader.read(vertPath);
+            fragShader.read(fragPath);
+        }
+        catch(const std::runtime_error& e)
+        {
+            throw DOT_RUNTIME_WHAT(e);
+        }
+
+        std::vector<vk::PipelineShaderStageCreateInfo> shaderStagesInfo =
+        {
+            {vk::PipelineShaderStageCreateFlags(0U), vk::ShaderStageFlagBits::eVertex, vertShader, "main", &pipelineConfig.specializationInfo},
+            {vk::PipelineShaderStageCreateFlags(0U), vk::ShaderStageFlagBits::eFragment, fragShader, "main", &pipelineConfig.specializationInfo}
+        };
+
+        vk::GraphicsPipelineCreateInfo createInfo
+        (
+            vk::PipelineCreateFlags(0U),            // flags
+            shaderStagesInfo,                       // shaderStagesInfo
+            &pipelineConfig.vertexStateInfo,        // pVertexInputState
+            &pipelineConfig.inputAssemblyStateInfo, // pInputAssemblyState
+            &pipelineConfig.tessellationStateInfo,  // pTessellationState
+            &pipelineConfig.viewportStateInfo,      // pViewportState
+            &pipelineConfig.rasterizationStateInfo, // pRasterizationState
+            &pipelineConfig.multisampleStateInfo,   // pMultisampleState
+            &pipelineConfig.stencilStateInfo,       // pDepthStencilState
+            &pipelineConfig.colorBlendStateInfo,    // pColorBlendState
+            &pipelineConfig.dynamicStateInfo,       // pDynamicState
+            layout,                                 // layout
+            pipelineConfig.renderPass,              // renderPass
+            pipelineConfig.subpass                  // subpass
+        );
+
+        if(!pipelineConfig.renderPass)
+            createInfo.pNext = &pipelineConfig.renderingInfo;
+
+        try
+        {
+            return device.getVkDevice().createGraphicsPipeline(cache, createInfo).value;
+        }
+        catch(const std::runtime_error& e)
+        {
+            throw DOT_RUNTIME_WHAT(e);
+        }
+    }
+
+    vk::Pipeline PipelineLibrary::link(std::vector<vk::Pipeline> variantParts, bool optimize) const
+    {
+        // a fast link only stitches the compiled parts together, the optimized one recompiles across their boundaries
+
+        vk::PipelineLibraryCreateInfoKHR libraryInfo(variantParts);
+
+        vk::GraphicsPipelineCreateInfo createInfo;
+        createInfo.flags = optimize ? vk::PipelineCreateFlagBits::eLinkTimeOptimizationEXT : vk::PipelineCreateFlags(0U);
+        createInfo.layout = layout;
+        createInfo.pNext = &libraryInfo;
+
+        try
+        {
+            return device.getVkDevice().createGraphicsPipeline(cache, createInfo).value;
+        }
+        catch(const std::runtime_error& e)
+        {
+            throw DOT_RUNTIME_WHAT(e);
+        }
+    }
+
+    void PipelineLibrary::configure(PipelineConfig& pipelineConfig, const DrawState& state, const ShaderFeatures& features) const
+    {
+        baseConfig(pipelineConfig);
+        Pipeline::featureConfig(pipelineConfig, features);
+        Pipeline::drawStateConfig(pipelineConfig, state);
+        Pipeline::dynamicStateConfig(pipelineConfig, dynamicMask);
+    }
+
+    uint32_t PipelineLibrary::partStates(Part part) noexcept
+    {
+        switch(part)
+        {
+            case VertexInput:       return DynamicTopology;
+            case PreRasterization:  return DynamicCullMode | DynamicFrontFace | DynamicDepthBias;
+            case FragmentShader:    return DynamicDepth;
+            case FragmentOutput:    return DynamicBlend;
+            default:                return 0;
+        }
+    }
+
+    vk::GraphicsPipelineLibraryFlagsEXT PipelineLibrary::partFlags(Part part) noexcept
+    {
+        switch(part)
+        {
+            case VertexInput:       return vk::GraphicsPipelineLibraryFlagBitsEXT::eVertexInputInterface;
+            case PreRasterization:  return vk::GraphicsPipelineLibraryFlagBitsEXT::ePreRasterizationShaders;
+            case FragmentShader:    return vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentShader;
+            case FragmentOutput:    return vk::GraphicsPipelineLibraryFlagBitsEXT::eFragmentOutputInterface;
+            default:                return {};
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,303 @@
+#include "dot_PostProcess.h"
+#include "dot_Exception.h"
+
+namespace dot
+{
+    static const char* getFragName(PostEffect effect) noexcept
+    {
+        switch(effect)
+        {
+            case PostTonemap:   return "tonemap_frag.spv";
+            case PostGrade:     return "grade_frag.spv";
+            case PostVignette:  return "vignette_frag.spv";
+            default:            return "fxaa_frag.spv";
+        }
+    }
+
+    PostProcess::PostProcess(Device& device)
+        : device(device)
+    {
+        createSetLayouts();
+        createSampler();
+    }
+
+    PostProcess::~PostProcess()
+    {
+        for(auto& pPipeline : pipelines)
+            retirePipeline(std::move(pPipeline));
+
+        retireDescriptors();
+
+        device.getVkDevice().destroySampler(sampler);
+    }
+
+    void PostProcess::setSwapchain(const Swapchain& swapchain)
+    {
+        // descriptors reference the image views of every swapchain, pipelines only the stage render passes
+
+        updatePipelines(swapchain);
+        createDescriptors(swapchain);
+    }
+
+    void PostProcess::updatePipelines(const Swapchain& swapchain)
+    {
+        // a stage keeps its pipeline while its render pass stays, a new sample count only replaces the merged ones
+
+        const size_t stageCount = swapchain.getStageCount();
+
+        for(size_t stage = stageCount + 1; stage <= pipelines.size(); stage++)
+            retirePipeline(std::move(pipelines[stage - 1]));
+
+        pipelines.resize(stageCount);
+        pipelineRenderPasses.resize(stageCount);
+
+        for(size_t stage = 1; stage <= stageCount; stage++)
+        {
+            if(pipelines[stage - 1] && pipelineRenderPasses[stage - 1] == swapchain.getStageRenderPass(stage))
+                continue;
+
+            auto pPipeline = createPipeline(swapchain, stage);
+            retirePipeline(std::move(pipelines[stage - 1]));
+
+            pipelines[stage - 1] = std::move(pPipeline);
+            pipelineRenderPasses[stage - 1] = swapchain.getStageRenderPass(stage);
+        }
+    }
+
+    bool PostProcess::reloadShader(const Swapchain& swapchain, const std::string& name, std::vector<char> code)
+    {
+        // the vertex shader is shared by every stage, a fragment shader only by the stages of its effect
+
+        const bool vert = name == "post_vert.spv";
+        if(!vert && name != getFragName(PostTonemap) && name != getFragName(PostGrade) &&
+           name != getFragName(PostVignette) && name != getFragName(PostFxaa))
+            return false;
+
+        reloadedCode[name] = std::move(code);
+
+        for(size_t stage = 1; stage <= pipelines.size(); stage++)
+        {
+            if(!vert && name != getFragName(swapchain.getStageEffect(stage)))
+                continue;
+
+            auto pPipeline = createPipeline(swapchain, stage);
+            retirePipeline(std::move(pipelines[stage - 1]));
+
+            pipelines[stage - 1] = std::move(pPipeline);
+            pipelineRenderPasses[stage - 1] = swapchain.getStageRenderPass(stage);
+        }
+
+        return true;
+    }
+
+    void PostProcess::recordMerged(const vk::CommandBuffer& cmdBuffer, const Swapchain& swapchain, size_t imageIndex) const noexcept
+    {
+        // the frame's render pass is on the scene subpass, every merged stage is the next one
+
+        for(size_t stage = 1; stage <= swapchain.getMergedStageCount(); stage++)
+        {
+            cmdBuffer.nextSubpass(vk::SubpassContents::eInline);
+            recordStage(cmdBuffer, swapchain, stage, imageIndex);
+        }
+    }
+
+    void PostProcess::recordSeparate(const vk::CommandBuffer& cmdBuffer, const Swapchain& swapchain, size_t imageIndex) const noexcept
+    {
+        for(size_t stage = swapchain.getMergedStageCount() + 1; stage <= swapchain.getStageCount(); stage++)
+        {
+            vk::RenderPassBeginInfo beginInfo
+            (
+                swapchain.getStageRenderPass(stage),                    // renderPass
+                swapchain.getStageFramebuffer(stage, imageIndex),       // framebuffer
+                vk::Rect2D(vk::Offset2D(0, 0), swapchain.getExtent()),  // renderArea
+                0,                                                      // clearValueCount
+                nullptr                                                 // pClearValues
+            );
+
+            cmdBuffer.beginRenderPass(beginInfo, vk::SubpassContents::eInline);
+            recordStage(cmdBuffer, swapchain, stage, imageIndex);
+            cmdBuffer.endRenderPass();
+        }
+    }
+
+    void PostProcess::recordStage(const vk::CommandBuffer& cmdBuffer, const Swapchain& swapchain, size_t stage, size_t imageIndex) const noexcept
+    {
+        const Pipeline& pipeline = *pipelines[stage - 1];
+        const vk::Extent2D& extent = swapchain.getExtent();
+
+        vk::Viewport viewport
+        (
+            0.0f, 0.0f,                 // x, y
+            (float)extent.width,        // width
+            (float)extent.height,       // height
+            0.0f, 1.0f                  // minDepth, maxDepth
+        );
+
+        const float invExtent[2] = {1.0f / extent.width, 1.0f / extent.height};
+
+        // dynamic state is set again, a scene recorded into a secondary buffer leaves it undefined
+
+        cmdBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, pipeline);
+        cmdBuffer.setViewport(0, viewport);
+        cmdBuffer.setScissor(0, vk::Rect2D(vk::Offset2D(0, 0), extent));
+        cmdBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, pipeline.getLayout(), 0, descriptorSets[stage - 1][imageIndex], {});
+        cmdBuffer.pushConstants(pipeline.getLayout(), vk::ShaderStageFlagBits::eFragment, 0, sizeof(invExtent), invExtent);
+        cmdBuffer.draw(3, 1, 0, 0);
+    }
+
+    void PostProcess::createSetLayouts()
+    {
+        vk::DescriptorSetLayoutBinding inputBinding
+        (
+            0,                                      // binding
+            vk::DescriptorType::eInputAttachment,   // descriptorType
+            1,                                      // descriptorCount
+            vk::ShaderStageFlagBits::eFragment      // stageFlags
+        );
+
+        vk::DescriptorSetLayoutBinding samplerBinding
+        (
+            0,                                          // binding
+            vk::DescriptorType::eCombinedImageSampler,  // descriptorType
+            1,                                          // descriptorCount
+            vk::ShaderStageFlagBits::eFragment          // stageFlags
+        );
+
+        // owned by the device's layout cache, the post pipelines' layouts are shared through it as well
+
+        inputSetLayout = device.getLayoutCache().getSetLayout({&inputBinding, 1});
+        samplerSetLayout = device.getLayoutCache().getSetLayout({&samplerBinding, 1});
+    }
+
+    void PostProcess::createSampler()
+    {
+        vk::SamplerCreateInfo createInfo
+        (
+            vk::SamplerCreateFlags(0U),                 // flags
+            vk::Filter::eLinear,                        // magFilter
+            vk::Filter::eLinear,                        // minFilter
+            vk::SamplerMipmapMode::eNearest,            // mipmapMode
+            vk::SamplerAddressMode::eClampToEdge,       // addressModeU
+            vk::SamplerAddressMode::eClampToEdge,       // addressModeV
+            vk::SamplerAddressMode::eClampToEdge        // addressModeW
+        );
+
+        try
+        {
+            sampler = device.getVkDevice().createSampler(createInfo);
+        }
+        catch(const std::runtime_error& e)
+        {
+            throw DOT_RUNTIME_WHAT(e);
+        }
+    }
+
+    std::unique_ptr<Pipeline> PostProcess::createPipeline(const Swapchain& swapchain, size_t stage) const
+    {
+        const PostEffect effect = swapchain.getStageEffect(stage);
+
+        PipelineConfig pipelineConfig;
+        Pipeline::postConfig
+        (
+            pipelineConfig, swapchain.getStageRenderPass(stage), swapchain.getStageSubpass(stage),
+            effect == PostFxaa ? samplerSetLayout : inputSetLayout
+        );
+
+        return std::make_unique<Pipeline>
+        (
+            device, getCode("post_vert.spv"), getCode(getFragName(effect)), pipelineConfig, device.getPipelineCache()
+        );
+    }
+
+    std::vector<char> PostProcess::getCode(const std::string& name) const
+    {
+        const auto it = reloadedCode.find(name);
+
+        return it != reloadedCode.end() ? it->second : Shader::readCode("engine/shaders/" + name);
+    }
+
+    void PostProcess::createDescriptors(const Swapchain& swapchain)
+    {
+        retireDescriptors();
+
+        const size_t stageCount = swapchain.getStageCount();
+        const size_t imageCount = swapchain.getImageCount();
+        if(!stageCount)
+            return;
+
+        // one set per stage and image, the pool is sized for the worst case of a single descriptor type
+
+        const auto setCount = static_cast<uint32_t>(stageCount * imageCount);
+        const std::vector<vk::DescriptorPoolSize> poolSizes =
+        {
+            vk::DescriptorPoolSize(vk::DescriptorType::eInputAttachment, setCount),
+            vk::DescriptorPoolSize(vk::DescriptorType::eCombinedImageSampler, setCount)
+        };
+
+        try
+        {
+            descriptorPool = device.getVkDevice().createDescriptorPool({vk::DescriptorPoolCreateFlags(0U), setCount, poolSizes});
+
+            for(size_t stage = 1; stage <= stageCount; stage++)
+            {
+                const bool sampled = swapchain.getStageEffect(stage) == PostFxaa;
+                const std::vector<vk::DescriptorSetLayout> setLayouts(imageCount, sampled ? samplerSetLayout : inputSetLayout);
+
+                descriptorSets.push_back(device.getVkDevice().allocateDescriptorSets({descriptorPool, setLayouts}));
+
+                for(size_t i = 0; i < imageCount; i++)
+                {
+                    vk::DescriptorImageInfo imageInfo
+                    (
+                        sampled ? sampler : vk::Sampler(),          // sampler
+                        swapchain.getStageInput(stage, i),          // imageView
+                        vk::ImageLayout::eShaderReadOnlyOptimal     // imageLayout
+                    );
+
+                    vk::WriteDescriptorSet write
+                    (
+                        descriptorSets.back()[i],                                                               // dstSet
+                        0,                                                                                      // dstBinding
+                        0,                                                                                      // dstArrayElement
+                        sampled ? vk::DescriptorType::eCombinedImageSampler : vk::DescriptorType::eInputAttachment, // descriptorType
+                        imageInfo                                                                               // imageInfo
+                    );
+
+                    device.getVkDevice().updateDescriptorSets(write, {});
+                }
+            }
+        }
+        catch(const std::runtime_error& e)
+        {
+            throw DOT_RUNTIME_WHAT(e);
+        }
+    }
+
+    void PostProcess::retirePipeline(std::unique_ptr<Pipeline> pPipeline) noexcept
+    {
+        if(!pPipeline)
+            return;
+
+        // frames in flight may still use the pipeline, the layouts it references outlive it
+
+        std::shared_ptr<Pipeline> pRetired = std::move(pPipeline);
+
+        device.retire([pRetired]{});
+    }
+
+    void PostProcess::retireDescriptors() noexcept
+    {
+        descriptorSets.clear();
+        if(!descriptorPool)
+            return;
+
+        auto destroy = [&device = device, descriptorPool = descriptorPool]
+        {
+            device.getVkDevice().destroyDescriptorPool(descriptorPool);
+        };
+
+        device.retire(destroy);
+
+        descriptorPool = nullptr;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,63 @@
+#include "dot_Profiler.h"
+
+#include <algorithm>
+#include <iomanip>
+#include <map>
+
+namespace dot
+{
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    std::mutex Profiler::mutex;
+    std::vector<Profiler::Phase> Profiler::phases;
+    const Profiler::Clock::time_point Profiler::startTime = Profiler::Clock::now();
+
+    Profiler::Scope::Scope(std::string phase) noexcept
+        : phase(std::move(phase)), start(Clock::now()){}
+
+    Profiler::Scope::~Scope()
+    {
+        record(phase, start, Clock::now());
+    }
+
+    void Profiler::record(const std::string& phase, Clock::time_point start, Clock::time_point end)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        phases.push_back
+        ({
+            phase,
+            Milliseconds(start - startTime).count(),
+            Milliseconds(end - start).count(),
+            std::this_thread::get_id()
+        });
+    }
+
+    void Profiler::report(std::ostream& os)
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+
+        std::vector<Phase> sorted = phases;
+        std::sort(sorted.begin(), sorted.end(), [](const Phase& a, const Phase& b){ return a.startMs < b.startMs; });
+
+        // threads are numbered in order of their first phase, thread 0 is whichever started profiling first
+
+        std::map<std::thread::id, size_t> threads;
+        for(const auto& phase : sorted)
+            threads.emplace(phase.thread, threads.size());
+
+        os << "\nStartup phases:\n" << std::fixed << std::setprecision(2);
+        for(const auto& phase : sorted)
+            os << '\t' << std::left << std::setw(24) << phase.name << std::right
+               << " start " << std::setw(9) << phase.startMs << " ms"
+               << " took " << std::setw(9) << phase.durationMs << " ms"
+               << " [thread " << threads[phase.thread] << "]\n";
+
+        os << std::defaultfloat << '\n';
+    }
+
+    double Profiler::sinceStart() noexcept
+    {
+        return Milliseconds(Clock::now() - startTime).count();
+    }
+}
\ No newline at end of file
@@ -0,0 +1,721 @@
+#include "dot_RenderGraph.h"
+#include "dot_Exception.h"
+
+#include <algorithm>
+#include <optional>
+#include <queue>
+
+namespace dot
+{
+    // layout, stages and access an image needs for one kind of access
+
+    struct AccessState
+    {
+        vk::ImageLayout layout;
+        vk::PipelineStageFlags stages;
+        vk::AccessFlags access;
+    };
+
+    static AccessState accessState(RenderGraphAccess type) noexcept
+    {
+        switch(type)
+        {
+            case RenderGraphAccess::ColorAttachment:
+                return
+                {
+                    vk::ImageLayout::eColorAttachmentOptimal,
+                    vk::PipelineStageFlagBits::eColorAttachmentOutput,
+                    vk::AccessFlagBits::eColorAttachmentRead | vk::AccessFlagBits::eColorAttachmentWrite
+                };
+            case RenderGraphAccess::DepthAttachment:
+                return
+                {
+                    vk::ImageLayout::eDepthStencilAttachmentOptimal,
+                    vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests,
+                    vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite
+                };
+            case RenderGraphAccess::Sampled:
+                return {vk::ImageLayout::eShaderReadOnlyOptimal, vk::PipelineStageFlagBits::eFragmentShader, vk::AccessFlagBits::eShaderRead};
+            case RenderGraphAccess::TransferSrc:
+                return {vk::ImageLayout::eTransferSrcOptimal, vk::PipelineStageFlagBits::eTransfer, vk::AccessFlagBits::eTransferRead};
+            case RenderGraphAccess::TransferDst:
+                return {vk::ImageLayout::eTransferDstOptimal, vk::PipelineStageFlagBits::eTransfer, vk::AccessFlagBits::eTransferWrite};
+        }
+
+        return {};
+    }
+
+    static vk::ImageUsageFlags accessUsage(RenderGraphAccess type) noexcept
+    {
+        switch(type)
+        {
+            case RenderGraphAccess::ColorAttachment:    return vk::ImageUsageFlagBits::eColorAttachment;
+            case RenderGraphAccess::DepthAttachment:    return vk::ImageUsageFlagBits::eDepthStencilAttachment;
+            case RenderGraphAccess::Sampled:            return vk::ImageUsageFlagBits::eSampled;
+            case RenderGraphAccess::TransferSrc:        return vk::ImageUsageFlagBits::eTransferSrc;
+            case RenderGraphAccess::TransferDst:        return vk::ImageUsageFlagBits::eTransferDst;
+        }
+
+        return {};
+    }
+
+    static bool isAttachment(RenderGraphAccess type) noexcept
+    {
+        return type == RenderGraphAccess::ColorAttachment || type == RenderGraphAccess::DepthAttachment;
+    }
+
+    RenderGraph::PassBuilder::PassBuilder(RenderGraph& graph, PassId pass) noexcept
+        : graph(graph), pass(pass){}
+
+    RenderGraph::ResourceId RenderGraph::PassBuilder::create(const std::string& name, const RenderGraphImageDesc& desc)
+    {
+        // transient, lives from the creating pass to its last reader and is never visible outside the graph
+
+        const auto id = static_cast<ResourceId>(graph.resources.size());
+        graph.resources.push_back({name, desc});
+        return id;
+    }
+
+    void RenderGraph::PassBuilder::read(ResourceId resource, RenderGraphAccess type)
+    {
+        graph.passes[pass].accesses.push_back({resource, type, false});
+        graph.resources[resource].usage |= accessUsage(type);
+    }
+
+    void RenderGraph::PassBuilder::write(ResourceId resource, RenderGraphAccess type)
+    {
+        graph.passes[pass].accesses.push_back({resource, type, true});
+        graph.resources[resource].usage |= accessUsage(type);
+    }
+
+    void RenderGraph::PassBuilder::sideEffect() noexcept
+    {
+        graph.passes[pass].sideEffect = true;
+    }
+
+    RenderGraph::RenderGraph(Device& device)
+        : device(device){}
+
+    RenderGraph::~RenderGraph()
+    {
+        destroyObjects();
+    }
+
+    RenderGraph::ResourceId RenderGraph::importImage
+    (
+        const std::string& name, const vk::Image& image, const vk::ImageView& view, const RenderGraphImageDesc& desc,
+        vk::ImageLayout initialLayout, vk::ImageLayout finalLayout
+    )
+    {
+        const auto id = static_cast<ResourceId>(resources.size());
+
+        Resource resource{name, desc, true, initialLayout, finalLayout};
+        resource.image = image;
+        resource.view = view;
+        resources.push_back(std::move(resource));
+
+        return id;
+    }
+
+    RenderGraph::PassId RenderGraph::addPass(const std::string& name, const SetupFn& setup, ExecuteFn execute)
+    {
+        const auto id = static_cast<PassId>(passes.size());
+        passes.push_back({name, {}, std::move(execute)});
+
+        PassBuilder builder(*this, id);
+        setup(builder);
+
+        return id;
+    }
+
+    void RenderGraph::compile()
+    {
+        if(compiled)
+            throw DOT_RUNTIME("Render graph is already compiled, reset it before adding passes!");
+
+        stats = {};
+        stats.passes = passes.size();
+
+        cullPasses();
+        sortPasses();
+        computeLifetimes();
+        allocateTransients();
+
+        for(size_t position = 0; position < order.size(); position++)
+            createRenderPass(passes[order[position]], position);
+
+        computeBarriers();
+
+        compiled = true;
+    }
+
+    void RenderGraph::execute(const vk::CommandBuffer& cmdBuffer) const noexcept
+    {
+        auto recordBarriers = [&](const Barriers& barriers)
+        {
+            if(!barriers.images.empty())
+                cmdBuffer.pipelineBarrier(barriers.srcStages, barriers.dstStages, vk::DependencyFlags(), {}, {}, barriers.images);
+        };
+
+        for(PassId id : order)
+        {
+            const Pass& pass = passes[id];
+
+            recordBarriers(pass.barriers);
+
+            if(pass.renderPass)
+            {
+                vk::RenderPassBeginInfo beginInfo
+                (
+                    pass.renderPass,                                // renderPass
+                    pass.framebuffer,                               // framebuffer
+                    vk::Rect2D(vk::Offset2D(0, 0), pass.extent),    // renderArea
+                    pass.clearValues                                // clearValues
+                );
+
+                cmdBuffer.beginRenderPass(beginInfo, vk::SubpassContents::eInline);
+
+                if(pass.execute)
+                    pass.execute(cmdBuffer);
+
+                cmdBuffer.endRenderPass();
+            }
+            else if(pass.execute)
+                pass.execute(cmdBuffer);
+        }
+
+        recordBarriers(finalBarriers);
+    }
+
+    void RenderGraph::reset() noexcept
+    {
+        destroyObjects();
+
+        resources.clear();
+        passes.clear();
+        order.clear();
+        finalBarriers = {};
+        stats = {};
+        compiled = false;
+    }
+
+    const vk::RenderPass& RenderGraph::getRenderPass(PassId pass) const noexcept
+    {
+        return passes[pass].renderPass;
+    }
+
+    const vk::ImageView& RenderGraph::getView(ResourceId resource) const noexcept
+    {
+        return resources[resource].view;
+    }
+
+    const RenderGraphStats& RenderGraph::getStats() const noexcept
+    {
+        return stats;
+    }
+
+    void RenderGraph::report(std::ostream& os) const
+    {
+        os << "Render graph: " << stats.passes << " passes, " << stats.culledPasses << " culled, " << stats.barriers << " barriers\n";
+
+        for(PassId id : order)
+            os << '\t' << passes[id].name << '\n';
+
+        os << "Transient memory: " << stats.allocatedBytes << " bytes allocated, "
+           << stats.transientBytes - stats.allocatedBytes << " of " << stats.transientBytes << " bytes saved by aliasing\n";
+    }
+
+    void RenderGraph::cullPasses()
+    {
+        // walks back from the passes that matter, imported images and side effects, marking every pass they depend on
+
+        std::vector<bool> needed(resources.size(), false);
+
+        for(size_t i = passes.size(); i-- > 0;)
+        {
+            Pass& pass = passes[i];
+
+            bool used = pass.sideEffect;
+            for(const auto& access : pass.accesses)
+                if(access.write && (resources[access.resource].imported || needed[access.resource]))
+                    used = true;
+
+            pass.culled = !used;
+            if(pass.culled)
+            {
+                stats.culledPasses++;
+                continue;
+            }
+
+            for(const auto& access : pass.accesses)
+                needed[access.resource] = true;
+        }
+    }
+
+    void RenderGraph::sortPasses()
+    {
+        // a pass depends on the last writer of everything it touches, a writer also on the readers before it;
+        // kahn's algorithm prefers the lowest declaration index so independent passes keep their submission order
+
+        std::vector<std::vector<PassId>> dependents(passes.size());
+        std::vector<size_t> dependencyCount(passes.size(), 0);
+        std::vector<PassId> lastWriter(resources.size(), ~PassId(0));
+        std::vector<std::vector<PassId>> readersSinceWrite(resources.size());
+
+        auto addEdge = [&](PassId from, PassId to)
+        {
+            if(from == to || from == ~PassId(0))
+                return;
+
+            dependents[from].push_back(to);
+            dependencyCount[to]++;
+        };
+
+        for(PassId id = 0; id < passes.size(); id++)
+        {
+            if(passes[id].culled)
+                continue;
+
+            for(const auto& access : passes[id].accesses)
+            {
+                addEdge(lastWriter[access.resource], id);
+
+                if(access.write)
+                {
+                    for(PassId reader : readersSinceWrite[access.resource])
+                        addEdge(reader, id);
+
+                    readersSinceWrite[access.resource].clear();
+                }
+                else
+                    readersSinceWrite[access.resource].push_back(id);
+            }
+
+            for(const auto& access : passes[id].accesses)
+                if(access.write)
+                    lastWriter[access.resource] = id;
+        }
+
+        std::priority_queue<PassId, std::vector<PassId>, std::greater<PassId>> ready;
+        for(PassId id = 0; id < passes.size(); id++)
+            if(!passes[id].culled && dependencyCount[id] == 0)
+                ready.push(id);
+
+        order.clear();
+        while(!ready.empty())
+        {
+            const PassId id = ready.top();
+            ready.pop();
+            order.push_back(id);
+
+            for(PassId dependent : dependents[id])
+                if(--dependencyCount[dependent] == 0)
+                    ready.push(dependent);
+        }
+
+        if(order.size() != passes.size() - stats.culledPasses)
+            throw DOT_RUNTIME("Render graph has a dependency cycle!");
+    }
+
+    void RenderGraph::computeLifetimes()
+    {
+        for(size_t position = 0; position < order.size(); position++)
+            for(const auto& access : passes[order[position]].accesses)
+            {
+                Resource& resource = resources[access.resource];
+                resource.firstUse = std::min(resource.firstUse, position);
+                resource.lastUse = std::max(resource.lastUse, position);
+            }
+    }
+
+    void RenderGraph::allocateTransients()
+    {
+        // every transient image is created up front, placement in memory is then a first fit over offsets:
+        // an image may overlap the memory of any image whose lifetime does not overlap its own
+
+        std::vector<ResourceId> transients;
+        vk::MemoryRequirements combined;
+        combined.memoryTypeBits = ~0U;
+
+        for(ResourceId id = 0; id < resources.size(); id++)
+        {
+            Resource& resource = resources[id];
+
+            if(resource.imported || resource.firstUse > resource.lastUse)
+                continue;
+
+            vk::ImageCreateInfo createInfo
+            (
+                vk::ImageCreateFlagBits::eAlias,                                    // flags
+                vk::ImageType::e2D,                                                 // imageType
+                resource.desc.format,                                               // format
+                vk::Extent3D(resource.desc.extent.width, resource.desc.extent.height, 1), // extent
+                1,                                                                  // mipLevels
+                1,                                                                  // arrayLayers
+                vk::SampleCountFlagBits::e1,                                        // samples
+                vk::ImageTiling::eOptimal,                                          // tiling
+                resource.usage,                                                     // usage
+                vk::SharingMode::eExclusive,                                        // sharingMode
+                {},                                                                 // queueFamilyIndices
+                vk::ImageLayout::eUndefined                                         // initialLayout
+            );
+
+            try
+            {
+                resource.image = device.getVkDevice().createImage(createInfo);
+            }
+            catch(const std::runtime_error& e)
+            {
+                throw DOT_RUNTIME_WHAT(e);
+            }
+
+            const vk::MemoryRequirements requirements = device.getVkDevice().getImageMemoryRequirements(resource.image);
+            resource.size = requirements.size;
+            combined.alignment = std::max(combined.alignment, requirements.alignment);
+            combined.memoryTypeBits &= requirements.memoryTypeBits;
+
+            stats.transientBytes += requirements.size;
+            transients.push_back(id);
+        }
+
+        if(transients.empty())
+            return;
+
+        // largest first packs tighter, placed images are kept sorted by offset for the gap search
+
+        std::sort(transients.begin(), transients.end(), [&](ResourceId a, ResourceId b){ return resources[a].size > resources[b].size; });
+
+        auto alignUp = [&](vk::DeviceSize value){ return (value + combined.alignment - 1) / combined.alignment * combined.alignment; };
+
+        std::vector<ResourceId> placed;
+        vk::DeviceSize heapSize = 0;
+
+        for(ResourceId id : transients)
+        {
+            Resource& resource = resources[id];
+
+            std::vector<ResourceId> conflicts;
+            for(ResourceId other : placed)
+                if(resources[other].firstUse <= resource.lastUse && resource.firstUse <= resources[other].lastUse)
+                    conflicts.push_back(other);
+
+            std::sort(conflicts.begin(), conflicts.end(), [&](ResourceId a, ResourceId b){ return resources[a].offset < resources[b].offset; });
+
+            vk::DeviceSize offset = 0;
+            for(ResourceId other : conflicts)
+            {
+                if(offset + resource.size <= resources[other].offset)
+                    break;
+
+                offset = std::max(offset, alignUp(resources[other].offset + resources[other].size));
+            }
+
+            resource.offset = offset;
+            heapSize = std::max(heapSize, offset + resource.size);
+            placed.push_back(id);
+        }
+
+        // attachments sharing memory with another image have to be declared as such in their render pass
+
+        for(ResourceId id : transients)
+        {
+            Resource& resource = resources[id];
+
+            bool overlaps = false;
+            for(ResourceId other : transients)
+                if(other != id && resources[other].offset < resource.offset + resource.size && resource.offset < resources[other].offset + resources[other].size)
+                    overlaps = true;
+
+            resource.aliased = overlaps;
+        }
+
+        vk::DeviceMemory memory;
+        try
+        {
+            const uint32_t memTypeIndex = device.getMemoryType(combined.memoryTypeBits, vk::MemoryPropertyFlagBits::eDeviceLocal);
+            memory = device.getVkDevice().allocateMemory(vk::MemoryAllocateInfo(heapSize, memTypeIndex));
+        }
+        catch(const std::runtime_error& e)
+        {
+            throw DOT_RUNTIME_WHAT(e);
+        }
+
+        memories.push_back(memory);
+        device.memoryAllocated(heapSize);
+        stats.allocatedBytes = heapSize;
+
+        for(ResourceId id : transients)
+        {
+            Resource& resource = resources[id];
+
+            device.getVkDevice().bindImageMemory(resource.image, memory, resource.offset);
+
+            vk::ImageViewCreateInfo viewInfo
+            (
+                vk::ImageViewCreateFlags(0U),                                                   // flags
+                resource.image,                                                                 // image
+                vk::ImageViewType::e2D,                                                         // viewType
+                resource.desc.format,                                                           // format
+                vk::ComponentMapping(),                                                         // components
+                vk::ImageSubresourceRange(viewAspectOf(resource.desc.format), 0, 1, 0, 1)       // subresourceRange
+            );
+
+            try
+            {
+                resource.view = device.getVkDevice().createImageView(viewInfo);
+            }
+            catch(const std::runtime_error& e)
+            {
+                throw DOT_RUNTIME_WHAT(e);
+            }
+        }
+    }
+
+    void RenderGraph::createRenderPass(Pass& pass, size_t position)
+    {
+        // attachments are already in their layout when the pass begins, barriers between passes do the transitions
+
+        std::vector<vk::AttachmentDescription> attachments;
+        std::vector<vk::AttachmentReference> colorRefs;
+        std::optional<vk::AttachmentReference> depthRef;
+        std::vector<vk::ImageView> views;
+
+        for(const auto& access : pass.accesses)
+        {
+            if(!isAttachment(access.type))
+                continue;
+
+            const Resource& resource = resources[access.resource];
+            const AccessState state = accessState(access.type);
+
+            if(attachments.empty())
+                pass.extent = resource.desc.extent;
+            else if(pass.extent != resource.desc.extent)
+                throw DOT_RUNTIME("Attachments of render graph pass " + pass.name + " differ in size!");
+
+            // first use of a transient has nothing to load, a result nobody reads later is not stored
+
+            const bool firstUse = resource.firstUse == position && (!resource.imported || resource.initialLayout == vk::ImageLayout::eUndefined);
+            const bool readLater = resource.imported || resource.lastUse > position;
+
+            attachments.emplace_back
+            (
+                resource.aliased ? vk::AttachmentDescriptionFlagBits::eMayAlias : vk::AttachmentDescriptionFlags(),  // flags
+                resource.desc.format,                                               // format
+                vk::SampleCountFlagBits::e1,                                        // samples
+                firstUse ? vk::AttachmentLoadOp::eClear : vk::AttachmentLoadOp::eLoad, // loadOp
+                readLater ? vk::AttachmentStoreOp::eStore : vk::AttachmentStoreOp::eDontCare, // storeOp
+                vk::AttachmentLoadOp::eDontCare,                                    // stencilLoadOp
+                vk::AttachmentStoreOp::eDontCare,                                   // stencilStoreOp
+                state.layout,                                                       // initialLayout
+                state.layout                                                        // finalLayout
+            );
+
+            const auto attachment = static_cast<uint32_t>(attachments.size() - 1);
+            if(access.type == RenderGraphAccess::DepthAttachment)
+            {
+                depthRef = vk::AttachmentReference(attachment, state.layout);
+                pass.clearValues.emplace_back(vk::ClearDepthStencilValue(1.0f, 0));
+            }
+            else
+            {
+                colorRefs.emplace_back(attachment, state.layout);
+                pass.clearValues.emplace_back(vk::ClearColorValue());
+            }
+
+            views.push_back(resource.view);
+        }
+
+        if(attachments.empty())
+            return;
+
+        vk::SubpassDescription subpass
+        (
+            vk::SubpassDescriptionFlags(0U),        // flags
+            vk::PipelineBindPoint::eGraphics,       // pipelineBindPoint
+            {},                                     // inputAttachments
+            colorRefs,                              // colorAttachments
+            {},                                     // resolveAttachments
+            depthRef ? &*depthRef : nullptr         // pDepthStencilAttachment
+        );
+
+        vk::RenderPassCreateInfo renderPassInfo
+        (
+            vk::RenderPassCreateFlags(0U),  // flags
+            attachments,                    // attachments
+            subpass                         // subpasses
+        );
+
+        try
+        {
+            pass.renderPass = device.getVkDevice().createRenderPass(renderPassInfo);
+
+            vk::FramebufferCreateInfo framebufferInfo
+            (
+                vk::FramebufferCreateFlags(0U), // flags
+                pass.renderPass,                // renderPass
+                views,                          // attachments
+                pass.extent.width,              // width
+                pass.extent.height,             // height
+                1                               // layers
+            );
+
+            pass.framebuffer = device.getVkDevice().createFramebuffer(framebufferInfo);
+        }
+        catch(const std::runtime_error& e)
+        {
+            throw DOT_RUNTIME_WHAT(e);
+        }
+    }
+
+    void RenderGraph::computeBarriers()
+    {
+        // replays the compiled order tracking every image's state, a barrier is needed on a layout change
+        // and whenever a write is involved; reads of an image in the same layout run without one
+
+        struct State
+        {
+            vk::ImageLayout layout;
+            vk::PipelineStageFlags stages;
+            vk::AccessFlags writes;
+            vk::AccessFlags reads;
+        };
+
+        // a transient's memory was last used by whatever image aliased it or by the previous frame, its first use
+        // waits for every stage any transient is used in; imported images wait for whatever used them outside the graph
+
+        vk::PipelineStageFlags transientStages;
+        vk::AccessFlags transientWrites;
+        for(PassId id : order)
+            for(const auto& access : passes[id].accesses)
+                if(!resources[access.resource].imported)
+                {
+                    const AccessState state = accessState(access.type);
+                    transientStages |= state.stages;
+                    if(access.write || isAttachment(access.type))
+                        transientWrites |= state.access;
+                }
+
+        std::vector<State> states(resources.size());
+        for(ResourceId id = 0; id < resources.size(); id++)
+        {
+            if(resources[id].imported)
+                states[id] = {resources[id].initialLayout, vk::PipelineStageFlagBits::eAllCommands, vk::AccessFlagBits::eMemoryWrite, {}};
+            else
+                states[id] = {vk::ImageLayout::eUndefined, transientStages, transientWrites, {}};
+        }
+
+        auto transition = [&](Barriers& barriers, ResourceId id, const AccessState& next, bool write)
+        {
+            State& state = states[id];
+
+            const bool layoutChange = state.layout != next.layout;
+            const bool hazard = layoutChange || write || state.writes;
+
+            if(!hazard)
+            {
+                state.stages |= next.stages;
+                state.reads |= next.access;
+                return;
+            }
+
+            barriers.srcStages |= state.stages ? state.stages : vk::PipelineStageFlagBits::eTopOfPipe;
+            barriers.dstStages |= next.stages;
+            barriers.images.emplace_back
+            (
+                state.writes | state.reads,                                                     // srcAccessMask
+                next.access,                                                                    // dstAccessMask
+                state.layout,                                                                   // oldLayout
+                next.layout,                                                                    // newLayout
+                VK_QUEUE_FAMILY_IGNORED,                                                        // srcQueueFamilyIndex
+                VK_QUEUE_FAMILY_IGNORED,                                                        // dstQueueFamilyIndex
+                resources[id].image,                                                            // image
+                vk::ImageSubresourceRange(aspectOf(resources[id].desc.format), 0, 1, 0, 1)      // subresourceRange
+            );
+            stats.barriers++;
+
+            state = {next.layout, next.stages, write ? next.access : vk::AccessFlags(), write ? vk::AccessFlags() : next.access};
+        };
+
+        for(PassId id : order)
+        {
+            Pass& pass = passes[id];
+
+            for(const auto& access : pass.accesses)
+                transition(pass.barriers, access.resource, accessState(access.type), access.write || isAttachment(access.type));
+        }
+
+        for(ResourceId id = 0; id < resources.size(); id++)
+            if(resources[id].imported && resources[id].finalLayout != vk::ImageLayout::eUndefined && states[id].layout != resources[id].finalLayout)
+                transition(finalBarriers, id, {resources[id].finalLayout, vk::PipelineStageFlagBits::eAllCommands, vk::AccessFlagBits::eMemoryRead}, false);
+    }
+
+    void RenderGraph::destroyObjects() noexcept
+    {
+        // frames recorded with the graph may still be in flight, everything goes once the device passed them
+
+        std::vector<vk::RenderPass> renderPasses;
+        std::vector<vk::Framebuffer> framebuffers;
+        std::vector<vk::Image> images;
+        std::vector<vk::ImageView> views;
+
+        for(const auto& pass : passes)
+            if(pass.renderPass)
+            {
+                renderPasses.push_back(pass.renderPass);
+                framebuffers.push_back(pass.framebuffer);
+            }
+
+        for(const auto& resource : resources)
+            if(!resource.imported && resource.image)
+            {
+                images.push_back(resource.image);
+                views.push_back(resource.view);
+            }
+
+        if(renderPasses.empty() && images.empty() && memories.empty())
+            return;
+
+        auto destroy = [&device = device, renderPasses, framebuffers, images, views, memories = memories, allocatedBytes = stats.allocatedBytes]
+        {
+            for(const auto& framebuffer : framebuffers)
+                device.getVkDevice().destroyFramebuffer(framebuffer);
+            for(const auto& renderPass : renderPasses)
+                device.getVkDevice().destroyRenderPass(renderPass);
+            for(const auto& view : views)
+                device.getVkDevice().destroyImageView(view);
+            for(const auto& image : images)
+                device.getVkDevice().destroyImage(image);
+            for(const auto& memory : memories)
+                device.getVkDevice().freeMemory(memory);
+
+            device.memoryFreed(allocatedBytes);
+        };
+
+        memories.clear();
+
+        device.retire(destroy);
+    }
+
+    bool RenderGraph::isDepthFormat(vk::Format format) noexcept
+    {
+        return format == vk::Format::eD32Sfloat || format == vk::Format::eD32SfloatS8Uint || format == vk::Format::eD24UnormS8Uint || format == vk::Format::eD16Unorm;
+    }
+
+    vk::ImageAspectFlags RenderGraph::aspectOf(vk::Format format) noexcept
+    {
+        // depth stencil formats are transitioned as a whole
+
+        if(format == vk::Format::eD32SfloatS8Uint || format == vk::Format::eD24UnormS8Uint)
+            return vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil;
+
+        return isDepthFormat(format) ? vk::ImageAspectFlagBits::eDepth : vk::ImageAspectFlagBits::eColor;
+    }
+
+    vk::ImageAspectFlags RenderGraph::viewAspectOf(vk::Format format) noexcept
+    {
+        // views can be sampled, which only works with a single aspect
+
+        return isDepthFormat(format) ? vk::ImageAspectFlagBits::eDepth : vk::ImageAspectFlagBits::eColor;
+    }
+}
\ No newline at end of file
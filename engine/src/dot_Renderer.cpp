@@ -1,54 +1,310 @@
 #include "dot_Renderer.h"
 #include "dot_Exception.h"
+#include "dot_Profiler.h"
+#include "dot_Logger.h"
 
-#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <tuple>
 
 namespace dot
 {
-    Renderer::Renderer(Window& wnd, Device& device)
-        : wnd(wnd), device(device)
+    Renderer::Renderer(Window& wnd, Device& device, const RendererConfig& config)
+        : wnd(wnd), device(device), maxObjects(config.maxObjects), framesInFlight(std::max<size_t>(config.framesInFlight, 1)), postConfig(config.post)
     {
-        recreateSwapchain();
-        createPipeline("engine/shaders/vert.spv", "engine/shaders/frag.spv");
-        allocateCmdBuffersGfx();
+        if(config.depth)
+            depthFormat = device.getDepthFormat();
+
+        samples = device.getSampleCount(config.samples);
+        dynamicRendering = config.dynamicRendering && device.dynamicRenderingEnabled();
+        pPost = std::make_unique<PostProcess>(device);
+        pDescriptors = std::make_unique<Descriptors>(device, framesInFlight);
+
+        if(device.descriptorIndexingEnabled())
+            pBindless = std::make_unique<Bindless>(device);
+
+        // shader files are read while the swapchain is created, the pipeline compiles while the engine uploads models
+
+        auto shaderCode = std::async(std::launch::async, []
+        {
+            DOT_PROFILE_SCOPE("shader_load");
+            return std::make_pair(Shader::readCode("engine/shaders/vert.spv"), Shader::readCode("engine/shaders/frag.spv"));
+        });
+
+        {
+            DOT_PROFILE_SCOPE("swapchain");
+            DOT_CHECK(recreateSwapchain());
+        }
+
+        std::tie(vertCode, fragCode) = shaderCode.get();
+        createPipeline(vertCode, fragCode);
+
+        // a missing source directory only costs hot reload, rendering works from the loaded code
+
+        if(config.hotReload)
+        {
+            try
+            {
+                pWatcher = std::make_unique<ShaderWatcher>(config.shaderSourceDir, []{ glfwPostEmptyEvent(); });
+            }
+            catch(const std::exception& e)
+            {
+                Logger::get().log(LogSeverity::Warning, LogCategory::Engine, 0, e.what());
+            }
+        }
+
+        {
+            DOT_PROFILE_SCOPE("cmd_buffers");
+            allocateCmdBuffersGfx();
+            allocateSceneCmdBuffers();
+            createSyncObjects();
+        }
     }
 
     Renderer::~Renderer()
     {
+        if(pipelineFuture.valid())
+            pipelineFuture.wait();
+
         device.getVkDevice().waitIdle();
 
+        releaseRetired(true);
+
         device.getVkDevice().freeCommandBuffers(device.getCmdPoolGfx(), cmdBuffersGfx);
+        device.getVkDevice().freeCommandBuffers(device.getCmdPoolGfx(), sceneCmdBuffers);
+
+        for(const auto& semaphore : imageAvailableSemaphores)
+            device.getVkDevice().destroySemaphore(semaphore);
+    }
+
+    Result<> Renderer::recreateSwapchain() noexcept
+    {
+        // a minimized window has no surface extent, recreation is retried by the next beginFrame instead of blocking here
+
+        swapchainOutdated = wnd.Minimized();
+        if(swapchainOutdated)
+            return {};
+
+        // swapchain creation is exception based, errors are converted here so the frame functions stay free of unwinding
+
+        // rendering continues into the new swapchain right away, the old one and everything recorded for its images
+        // is retired instead of waiting for the device to go idle
+
+        try
+        {
+            auto pNewSwapchain = std::make_unique<Swapchain>(wnd, device, pSwapchain.get(), depthFormat, samples, postConfig, dynamicRendering);
+            const bool sceneCmdBuffersAllocated = !sceneCmdBuffers.empty();
+
+            // one more frame has to complete after the last one rendered to the old swapchain, its present is not tracked
+
+            if(pSwapchain)
+            {
+                retired.push_back({std::move(pSwapchain), nullptr, std::move(sceneCmdBuffers), device.getSubmittedTimelineValue() + 1});
+                sceneCmdBuffers.clear();
+            }
+
+            pSwapchain = std::move(pNewSwapchain);
+            imageTimelineValues.assign(pSwapchain->getImageCount(), 0);
+
+            if(sceneCmdBuffersAllocated)
+                allocateSceneCmdBuffers();
+
+            pPost->setSwapchain(*pSwapchain);
+
+            // regions follow the image index so commands cached per image always read the region written for it
+
+            if(!pTransforms || pTransforms->getRegionCount() != pSwapchain->getImageCount())
+            {
+                auto pNewTransforms = std::make_unique<Transforms>(device, *pDescriptors, pSwapchain->getImageCount(), maxObjects);
+
+                if(pTransforms)
+                {
+                    pNewTransforms->setCamera(pTransforms->getCamera());
+
+                    std::shared_ptr<Transforms> pRetired = std::move(pTransforms);
+
+                    device.retire([pRetired]{});
+                }
+
+                pTransforms = std::move(pNewTransforms);
+            }
+
+            // a pipeline is only compatible with render passes of the same formats, rebuilt when the format changed;
+            // with dynamic rendering there is no render pass and only a new surface format matters
+
+            if(pPipeline && (pSwapchain->getRenderPass() != pipelineRenderPass || pSwapchain->getColorFormat() != pipelineColorFormat))
+                createPipeline(vertCode, fragCode);
+        }
+        catch(const std::exception& e)
+        {
+            Logger::get().log(LogSeverity::Error, LogCategory::Engine, 0, e.what());
+            return Error{vk::Result::eErrorInitializationFailed, "Failed to recreate swapchain!"};
+        }
+
+        return {};
     }
 
-    void Renderer::recreateSwapchain() noexcept
+    void Renderer::createPipeline(std::vector<char> vertCode, std::vector<char> fragCode, bool required)
     {
-        int width = 0, height = 0;
-        glfwGetFramebufferSize(wnd, &width, &height);
-        while (width == 0 || height == 0)
+        // pipeline creation only touches the device and the internally synchronized pipeline cache, no queue or pool
+
+        // a rebuild replacing a reload still compiling drops its pipeline, the reloaded code is compiled again afterwards
+
+        if(required && pipelineFuture.valid() && !pipelineRequired)
         {
-            glfwGetFramebufferSize(wnd, &width, &height);
-            glfwWaitEvents();
+            if(reloadedVertCode.empty())
+                reloadedVertCode = std::move(linkingVertCode);
+
+            if(reloadedFragCode.empty())
+                reloadedFragCode = std::move(linkingFragCode);
+
+            linkingVertCode.clear();
+            linkingFragCode.clear();
+            shadersChanged = true;
         }
 
-        device.getVkDevice().waitIdle();
+        pipelineRequired = required;
+        pipelineRenderPass = pSwapchain->getRenderPass();
+        pipelineColorFormat = pSwapchain->getColorFormat();
 
-        pSwapchain = std::make_unique<Swapchain>(wnd, device, std::move(pSwapchain));
+        pipelineFuture = std::async
+        (
+            std::launch::async, 
+            [
+                this, renderPass = pSwapchain->getRenderPass(), samples = samples, dynamic = pSwapchain->usesDynamicRendering(),
+                colorFormat = pSwapchain->getColorFormat(), depthFormat = pSwapchain->getDepthFormat(),
+                vertCode = std::move(vertCode), fragCode = std::move(fragCode)
+            ]() mutable
+            {
+                DOT_PROFILE_SCOPE("pipeline_compile");
+
+                dot::PipelineConfig pipelineConfig;
+                dot::Pipeline::defaultConfig(pipelineConfig, renderPass, samples); 
+                if(dynamic)
+                    dot::Pipeline::renderingConfig(pipelineConfig, {colorFormat}, depthFormat);
+
+                return std::make_unique<Pipeline>(device, std::move(vertCode), std::move(fragCode), pipelineConfig, device.getPipelineCache());
+            }
+        );
     }
 
-    void Renderer::createPipeline(const std::string& vertPath, const std::string& fragPath)
+    Result<> Renderer::waitPipeline() noexcept
     {
-        dot::PipelineConfig pipelineConfig;
-        dot::Pipeline::defaultConfig(pipelineConfig, pSwapchain->getRenderPass()); 
-        pPipeline = std::make_unique<Pipeline>(device, vertPath, fragPath, pipelineConfig);
+        if(!pipelineFuture.valid())
+            return {};
+
+        // a reloaded pipeline replaces one that still works, frames keep the current one until the compile is done
+
+        if(!pipelineRequired && pipelineFuture.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+            return {};
+
+        try
+        {
+            auto pNewPipeline = pipelineFuture.get();
+
+            if(pPipeline)
+                retired.push_back({nullptr, std::move(pPipeline), {}, device.getSubmittedTimelineValue()});
+
+            pPipeline = std::move(pNewPipeline);
+            invalidateCommands();
+
+            // reloaded code becomes what later rebuilds use only now that it is known to link
+
+            if(!pipelineRequired)
+            {
+                vertCode = std::move(linkingVertCode);
+                fragCode = std::move(linkingFragCode);
+            }
+        }
+        catch(const std::exception& e)
+        {
+            Logger::get().log(LogSeverity::Error, LogCategory::Engine, 0, e.what());
+
+            linkingVertCode.clear();
+            linkingFragCode.clear();
+
+            // shaders that compiled but do not link into a pipeline are reported like compile errors
+
+            if(!pipelineRequired && pPipeline)
+                return {};
+
+            return Error{vk::Result::eErrorInitializationFailed, "Failed to create pipeline!"};
+        }
+
+        return {};
+    }
+
+    void Renderer::reloadShaders() noexcept
+    {
+        if(!pWatcher)
+            return;
+
+        try
+        {
+            if(pWatcher->hasCompiled())
+                for(auto& [name, code] : pWatcher->takeCompiled())
+                {
+                    if(name == "vert.spv")
+                        reloadedVertCode = std::move(code);
+                    else if(name == "frag.spv")
+                        reloadedFragCode = std::move(code);
+                    else
+                    {
+                        // post shaders rebuild their stages right away, bindless and library variants are not owned here
+
+                        if(!pSwapchain || !pPost->reloadShader(*pSwapchain, name, std::move(code)))
+                            Logger::get().log(LogSeverity::Warning, LogCategory::Engine, 0, "Shader " + name + " is not reloadable, restart to apply it");
+
+                        continue;
+                    }
+
+                    shadersChanged = true;
+                }
+
+            // one compile at a time, replacing the future of a running one would block until it finished
+
+            if(shadersChanged && !pipelineFuture.valid())
+            {
+                linkingVertCode = reloadedVertCode.empty() ? vertCode : std::move(reloadedVertCode);
+                linkingFragCode = reloadedFragCode.empty() ? fragCode : std::move(reloadedFragCode);
+                reloadedVertCode.clear();
+                reloadedFragCode.clear();
+
+                createPipeline(linkingVertCode, linkingFragCode, false);
+                shadersChanged = false;
+            }
+        }
+        catch(const std::exception& e)
+        {
+            Logger::get().log(LogSeverity::Error, LogCategory::Engine, 0, e.what());
+        }
+    }
+
+    bool Renderer::shaderReloadPending() const noexcept
+    {
+        return pWatcher && (pWatcher->hasCompiled() || shadersChanged || (pipelineFuture.valid() && !pipelineRequired));
     }
     
+    void Renderer::releaseRetired(bool all) noexcept
+    {
+        const uint64_t completedValue = device.getCompletedTimelineValue();
+
+        auto completed = [&](const Retired& object){ return all || object.timelineValue <= completedValue; };
+
+        for(auto& object : retired)
+            if(completed(object) && !object.cmdBuffers.empty())
+                device.getVkDevice().freeCommandBuffers(device.getCmdPoolGfx(), object.cmdBuffers);
+
+        std::erase_if(retired, completed);
+    }
+
     void Renderer::allocateCmdBuffersGfx()
     {
         vk::CommandBufferAllocateInfo allocInfo
         (
             device.getCmdPoolGfx(),             // commandPool
             vk::CommandBufferLevel::ePrimary,   // level    
-            pSwapchain->getMaxFramesInFlight()  // commandBufferCount
+            static_cast<uint32_t>(framesInFlight)   // commandBufferCount
         );
 
         try
@@ -61,51 +317,143 @@ namespace dot
         }
     }
 
-    void Renderer::beginFrame()
+    void Renderer::allocateSceneCmdBuffers()
     {
-        const vk::Result& result = pSwapchain->acquireNextImage(currentImageIndex);
+        // one buffer per image of the current swapchain, the previous set is retired together with its swapchain
 
-        if(result == vk::Result::eErrorOutOfDateKHR)
+        vk::CommandBufferAllocateInfo allocInfo
+        (
+            device.getCmdPoolGfx(),                                     // commandPool
+            vk::CommandBufferLevel::eSecondary,                         // level    
+            static_cast<uint32_t>(pSwapchain->getImageCount())          // commandBufferCount
+        );
+
+        try
         {
-            glfwWaitEvents();
-            recreateSwapchain();
-            return;
+            sceneCmdBuffers = device.getVkDevice().allocateCommandBuffers(allocInfo);
+        }
+        catch(const std::runtime_error& e)
+        {
+            throw DOT_RUNTIME_WHAT(e);
         }
-        else if(result != vk::Result::eSuccess && result != vk::Result::eSuboptimalKHR)
-            throw DOT_RUNTIME("Failed to acquire swapchain image!");
 
-        _frameStarted = true;
+        sceneVersions.assign(sceneCmdBuffers.size(), noVersion);
+    }
 
-        const auto& cmdBufferGfx = getCurrentCmdBufferGfx();
+    void Renderer::createSyncObjects()
+    {
+        imageAvailableSemaphores.reserve(framesInFlight);
+        frameTimelineValues.assign(framesInFlight, 0);
+
+        vk::SemaphoreCreateInfo semaphoreInfo;
 
         try
         {
-            vk::CommandBufferBeginInfo beginInfo;
-            cmdBufferGfx.begin(beginInfo);
+            for(size_t i = 0; i < framesInFlight; i++)
+                imageAvailableSemaphores.emplace_back(device.getVkDevice().createSemaphore(semaphoreInfo));
         }
         catch(const std::runtime_error& e)
         {
             throw DOT_RUNTIME_WHAT(e);
         }
+    }
+
+    Result<> Renderer::beginFrame() noexcept
+    {
+        reloadShaders();
+        DOT_TRY(waitPipeline());
+
+        if(swapchainOutdated)
+        {
+            DOT_TRY(recreateSwapchain());
+            if(swapchainOutdated)
+                return {};
+        }
+
+        // the frame slot is reused once the gpu finished its previous submission, the only wait on the way to recording
+
+        DOT_TRY(device.waitTimeline(frameTimelineValues[currentFrameInFlight]));
+        pDescriptors->beginFrame(currentFrameInFlight);
+
+        const vk::Result result = pSwapchain->acquireNextImage(imageAvailableSemaphores[currentFrameInFlight], currentImageIndex);
+
+        if(result == vk::Result::eErrorOutOfDateKHR)
+            return recreateSwapchain();
+        else if(result != vk::Result::eSuccess && result != vk::Result::eSuboptimalKHR)
+            return Error{result, "Failed to acquire swapchain image!"};
+
+        // images can be acquired out of order, commands recorded for this image are reused only after its last frame completed
+
+        if(auto waited = device.waitTimeline(imageTimelineValues[currentImageIndex]); !waited)
+        {
+            // the acquire already signaled the frame's semaphore, an empty submission consumes it so the slot can acquire again
+
+            const VkSemaphore waitSemaphores[] = {imageAvailableSemaphores[currentFrameInFlight]};
+            const VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_ALL_COMMANDS_BIT};
+            [[maybe_unused]] auto consumed = device.submitGfx({}, waitSemaphores, waitStages);
+
+            return waited.error();
+        }
 
-        beginRenderPass();
+        pTransforms->begin(currentImageIndex);
+
+        releaseRetired();
+        device.collectGarbage();
+
+        // using vulkan c api to prevent from throwing an exception
+
+        const VkCommandBufferBeginInfo beginInfo = {.sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO};
+        if(VkResult beginResult = vkBeginCommandBuffer(getCurrentCmdBufferGfx(), &beginInfo); beginResult != VK_SUCCESS)
+            return Error{vk::Result(beginResult), "Failed to begin command buffer!"};
+
+        _frameStarted = true;
+        frameCaching = commandCaching;
+        renderPassBegun = false;
+
+        return {};
     }
 
-    void Renderer::beginRenderPass() const noexcept
+    void Renderer::beginRenderPass() noexcept
     {
+        renderPassBegun = true;
+
+        auto cmdBufferGfx = getCurrentCmdBufferGfx();
+
+        if(pSwapchain->usesDynamicRendering())
+        {
+            pSwapchain->beginRendering
+            (
+                cmdBufferGfx, currentImageIndex,
+                frameCaching ? vk::RenderingFlagBitsKHR::eContentsSecondaryCommandBuffers : vk::RenderingFlagsKHR()
+            );
+
+            if(!frameCaching)
+                setFrameState(cmdBufferGfx);
+
+            return;
+        }
+
         vk::Rect2D renderArea(vk::Offset2D(0, 0), pSwapchain->getExtent());
-        vk::ClearValue clearValue;
 
         vk::RenderPassBeginInfo beginInfo
         (
             pSwapchain->getRenderPass(),                        // renderPass
             pSwapchain->getFramebuffer(currentImageIndex),      // framebuffer
             renderArea,                                         // renderArea
-            clearValue                                          // clearValue 
+            pSwapchain->getClearValues()                        // clearValues
         );
 
-        auto cmdBufferGfx = getCurrentCmdBufferGfx();
-        cmdBufferGfx.beginRenderPass(beginInfo, vk::SubpassContents::eInline);
+        // cached frames only execute the secondary scene buffer inside the render pass
+
+        cmdBufferGfx.beginRenderPass(beginInfo, frameCaching ? vk::SubpassContents::eSecondaryCommandBuffers : vk::SubpassContents::eInline);
+
+        if(!frameCaching)
+            setFrameState(cmdBufferGfx);
+    }
+
+    void Renderer::setFrameState(const vk::CommandBuffer& cmdBuffer) const noexcept
+    {
+        vk::Rect2D renderArea(vk::Offset2D(0, 0), pSwapchain->getExtent());
 
         vk::Viewport viewport
         (
@@ -115,46 +463,213 @@ namespace dot
             0.0f, 1.0f                              // minDepth, maxDepth
         );
 
-        cmdBufferGfx.setViewport(0, viewport);
-        cmdBufferGfx.setScissor(0, renderArea);
-        cmdBufferGfx.bindPipeline(vk::PipelineBindPoint::eGraphics, *pPipeline);
+        cmdBuffer.setViewport(0, viewport);
+        cmdBuffer.setScissor(0, renderArea);
+        cmdBuffer.bindPipeline(vk::PipelineBindPoint::eGraphics, *pPipeline);
+
+        // scene pipelines share the layout of set 0 and the push constants, both stay bound across their pipeline binds;
+        // draws without a transform of their own use the identity
+
+        pTransforms->bind(cmdBuffer, pPipeline->getLayout());
+        Transforms::push(cmdBuffer, pPipeline->getLayout(), {});
     }
 
     void Renderer::endRenderPass() const noexcept
     {
+        // merged post stages are the remaining subpasses, the others read the stored result after the pass
+
         const auto& cmdBufferGfx = getCurrentCmdBufferGfx();
+
+        if(pSwapchain->usesDynamicRendering())
+        {
+            pSwapchain->endRendering(cmdBufferGfx, currentImageIndex);
+            return;
+        }
+
+        pPost->recordMerged(cmdBufferGfx, *pSwapchain, currentImageIndex);
         cmdBufferGfx.endRenderPass();
+        pPost->recordSeparate(cmdBufferGfx, *pSwapchain, currentImageIndex);
     }
 
-    void Renderer::endFrame()
+    Result<> Renderer::endFrame() noexcept
     {
+        // a frame without scene commands still clears and presents its image
+
+        if(!renderPassBegun)
+            beginRenderPass();
+
         endRenderPass();
 
+        _frameStarted = false;        
+
+        // using vulkan c api to prevent from throwing an exception
+
         const auto& cmdBufferGfx = getCurrentCmdBufferGfx();
-        try
+        if(VkResult endResult = vkEndCommandBuffer(cmdBufferGfx); endResult != VK_SUCCESS)
+            return Error{vk::Result(endResult), "Failed to end command buffer!"};
+
+        const VkSemaphore waitSemaphores[] = {imageAvailableSemaphores[currentFrameInFlight]};
+        const VkPipelineStageFlags waitStages[] = {VK_PIPELINE_STAGE_COLOR_ATTACHMENT_OUTPUT_BIT};
+        const VkSemaphore signalSemaphores[] = {pSwapchain->getRenderFinishedSemaphore(currentImageIndex)};
+
+        auto submitted = device.submitGfx(cmdBufferGfx, waitSemaphores, waitStages, signalSemaphores);
+        DOT_TRY(submitted);
+
+        frameTimelineValues[currentFrameInFlight] = submitted.value();
+        imageTimelineValues[currentImageIndex] = submitted.value();
+
+        if(pBindless)
+            pBindless->frameSubmitted(submitted.value());
+
+        const vk::Result result = pSwapchain->present(currentImageIndex);
+
+        // the frame was submitted even when presenting failed, it advances the frame slot either way
+
+        currentFrameInFlight = (currentFrameInFlight + 1) % framesInFlight;
+
+        if(result == vk::Result::eErrorOutOfDateKHR || result == vk::Result::eSuboptimalKHR || wnd.Resized())
         {
-            cmdBufferGfx.end();
+            wnd.Resized(false);
+            return recreateSwapchain();
         }
-        catch(const std::runtime_error& e)
+        else if(result != vk::Result::eSuccess)
+            return Error{result, "Failed to present swapchain image!"};
+
+        return {};
+    }
+
+    Result<> Renderer::recordOffscreen(const RecordFn& record)
+    {
+        // render graph passes and other work outside the swapchain pass, recorded into the frame's command buffer
+
+        if(renderPassBegun)
+            return Error{vk::Result::eErrorUnknown, "Offscreen commands have to be recorded before the scene!"};
+
+        record(getCurrentCmdBufferGfx());
+        return {};
+    }
+
+    Result<> Renderer::recordScene(uint64_t version, const RecordFn& record)
+    {
+        // called once per frame, without caching the scene is recorded straight into the frame's command buffer
+
+        if(!renderPassBegun)
+            beginRenderPass();
+
+        const auto& cmdBufferGfx = getCurrentCmdBufferGfx();
+
+        if(!frameCaching)
         {
-            throw DOT_RUNTIME_WHAT(e);
+            record(cmdBufferGfx);
+            return {};
         }
 
-        const vk::Result& result = pSwapchain->submitCmdBuffer(cmdBufferGfx, currentImageIndex);
+        // using vulkan c api to prevent from throwing an exception
 
-        if(result == vk::Result::eErrorOutOfDateKHR || result == vk::Result::eSuboptimalKHR || wnd.Resized())
+        VkCommandBuffer sceneCmdBuffer = sceneCmdBuffers[currentImageIndex];
+
+        // cached commands may index bindless resources removed since, they are recorded again before the index is reused
+
+        if(pBindless && pBindless->getRemovals() != bindlessRemovals)
         {
-            glfwWaitEvents();
-            recreateSwapchain();
-            wnd.Resized(false);
-            _frameStarted = false;        
-            return;
+            bindlessRemovals = pBindless->getRemovals();
+            invalidateCommands();
         }
-        else if(result != vk::Result::eSuccess)
-            throw DOT_RUNTIME("Failed to present swapchain image!");
 
-        _frameStarted = false;        
-        currentFrameInFlight = (currentFrameInFlight + 1) % pSwapchain->getMaxFramesInFlight();
+        if(sceneVersions[currentImageIndex] != version)
+        {
+            sceneVersions[currentImageIndex] = noVersion;
+
+            // with dynamic rendering the buffer inherits the attachment formats instead of a render pass
+
+            const bool dynamic = pSwapchain->usesDynamicRendering();
+            const VkFormat colorFormat = static_cast<VkFormat>(pSwapchain->getColorFormat());
+
+            const VkCommandBufferInheritanceRenderingInfoKHR renderingInfo
+            {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_RENDERING_INFO_KHR,
+                .colorAttachmentCount = 1,
+                .pColorAttachmentFormats = &colorFormat,
+                .depthAttachmentFormat = static_cast<VkFormat>(pSwapchain->getDepthFormat()),
+                .rasterizationSamples = static_cast<VkSampleCountFlagBits>(samples)
+            };
+
+            const VkCommandBufferInheritanceInfo inheritanceInfo
+            {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_INHERITANCE_INFO,
+                .pNext = dynamic ? &renderingInfo : nullptr,
+                .renderPass = pSwapchain->getRenderPass(),
+                .subpass = 0,
+                .framebuffer = dynamic ? VK_NULL_HANDLE : VkFramebuffer(pSwapchain->getFramebuffer(currentImageIndex))
+            };
+
+            const VkCommandBufferBeginInfo beginInfo
+            {
+                .sType = VK_STRUCTURE_TYPE_COMMAND_BUFFER_BEGIN_INFO,
+                .flags = VK_COMMAND_BUFFER_USAGE_RENDER_PASS_CONTINUE_BIT,
+                .pInheritanceInfo = &inheritanceInfo
+            };
+
+            if(VkResult beginResult = vkBeginCommandBuffer(sceneCmdBuffer, &beginInfo); beginResult != VK_SUCCESS)
+                return Error{vk::Result(beginResult), "Failed to begin scene command buffer!"};
+
+            // dynamic state is not inherited from the primary buffer
+
+            setFrameState(sceneCmdBuffers[currentImageIndex]);
+            record(sceneCmdBuffers[currentImageIndex]);
+
+            if(VkResult endResult = vkEndCommandBuffer(sceneCmdBuffer); endResult != VK_SUCCESS)
+                return Error{vk::Result(endResult), "Failed to end scene command buffer!"};
+
+            sceneVersions[currentImageIndex] = version;
+        }
+
+        vkCmdExecuteCommands(cmdBufferGfx, 1, &sceneCmdBuffer);
+
+        return {};
+    }
+
+    void Renderer::setCommandCaching(bool enabled) noexcept
+    {
+        commandCaching = enabled;
+    }
+
+    Result<> Renderer::setSampleCount(uint32_t count) noexcept
+    {
+        if(_frameStarted)
+            return Error{vk::Result::eErrorUnknown, "The sample count can only change between frames!"};
+
+        samples = device.getSampleCount(count);
+        if(!pSwapchain || pSwapchain->getSamples() == samples)
+            return {};
+
+        // only the scene render pass, its framebuffers and the pipelines built for it change, the swapchain stays
+
+        try
+        {
+            pSwapchain->setSamples(samples);
+            pPost->updatePipelines(*pSwapchain);
+            createPipeline(vertCode, fragCode);
+        }
+        catch(const std::exception& e)
+        {
+            Logger::get().log(LogSeverity::Error, LogCategory::Engine, 0, e.what());
+            return Error{vk::Result::eErrorInitializationFailed, "Failed to change the sample count!"};
+        }
+
+        invalidateCommands();
+
+        return {};
+    }
+
+    vk::SampleCountFlagBits Renderer::getSampleCount() const noexcept
+    {
+        return samples;
+    }
+
+    void Renderer::invalidateCommands() noexcept
+    {
+        std::fill(sceneVersions.begin(), sceneVersions.end(), noVersion);
     }
 
     const vk::CommandBuffer& Renderer::getCurrentCmdBufferGfx() const noexcept
@@ -162,8 +677,52 @@ namespace dot
         return cmdBuffersGfx[currentFrameInFlight];
     }
 
+    const vk::RenderPass& Renderer::getRenderPass() const noexcept
+    {
+        return pSwapchain->getRenderPass();
+    }
+
+    void Renderer::defaultPipelineConfig(PipelineConfig& pipelineConfig) const
+    {
+        // scene pipelines match the swapchain's render pass, or only its formats with dynamic rendering
+
+        Pipeline::defaultConfig(pipelineConfig, pSwapchain->getRenderPass(), samples);
+        if(pSwapchain->usesDynamicRendering())
+            Pipeline::renderingConfig(pipelineConfig, {pSwapchain->getColorFormat()}, pSwapchain->getDepthFormat());
+    }
+
+    size_t Renderer::getFramesInFlight() const noexcept
+    {
+        return framesInFlight;
+    }
+
+    Descriptors& Renderer::getDescriptors() noexcept
+    {
+        return *pDescriptors;
+    }
+
+    Transforms& Renderer::getTransforms() noexcept
+    {
+        return *pTransforms;
+    }
+
+    Bindless* Renderer::getBindless() noexcept
+    {
+        return pBindless.get();
+    }
+
     bool Renderer::frameStarted() const noexcept
     {
         return _frameStarted;
     }
+
+    const PostConfig& Renderer::getPostConfig() const noexcept
+    {
+        return postConfig;
+    }
+
+    vk::DeviceSize Renderer::getPostTrafficBytes() const noexcept
+    {
+        return pSwapchain->getPostTrafficBytes();
+    }
 }
\ No newline at end of file
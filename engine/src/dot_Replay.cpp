@@ -0,0 +1,136 @@
+#include "dot_Replay.h"
+#include "dot_Exception.h"
+
+#include <chrono>
+#include <thread>
+
+namespace dot
+{
+    using Clock = std::chrono::steady_clock;
+    using Milliseconds = std::chrono::duration<double, std::milli>;
+
+    Replay::Replay(Window& wnd, Device& device, Renderer& renderer)
+        : wnd(wnd), device(device), renderer(renderer){}
+
+    void Replay::run(const ReplayConfig& config)
+    {
+        CaptureReader reader(config.capturePath);
+
+        // every captured draw is submitted again, the scene is recorded inline
+        renderer.setCommandCaching(false);
+
+        std::ofstream timings;
+        if(!config.timingsPath.empty())
+        {
+            timings.open(config.timingsPath, std::ios::trunc);
+            if(!timings)
+                throw DOT_RUNTIME("Failed to open the file: " + config.timingsPath);
+        }
+
+        CaptureRecord record;
+        Clock::time_point frameStart;
+        double frameDelta = 0.0;
+        uint64_t checksum = 0;
+        size_t frame = 0;
+
+        // FNV-1a over everything that reaches the renderer in a frame, equal on every replay of the same capture
+
+        auto hash = [&checksum](const void* data, size_t size)
+        {
+            const auto* bytes = static_cast<const uint8_t*>(data);
+            for(size_t i = 0; i < size; i++)
+                checksum = (checksum ^ bytes[i]) * 0x100000001B3ULL;
+        };
+
+        while(reader.next(record) && !glfwWindowShouldClose(wnd))
+        {
+            switch(record.op)
+            {
+                case CaptureOp::FrameBegin:
+                    frameStart = Clock::now();
+                    frameDelta = record.deltaTime;
+                    checksum = 0xCBF29CE484222325ULL;
+                    draws.clear();
+                    break;
+                case CaptureOp::ModelCreate:
+                    models[record.id] = std::make_unique<Model>(device, record.verticies);
+                    hash(record.verticies.data(), record.verticies.size() * sizeof(Model::Vertex));
+                    break;
+                case CaptureOp::ModelWrite:
+                    getModel(record.id).write(record.verticies);
+                    hash(record.verticies.data(), record.verticies.size() * sizeof(Model::Vertex));
+                    break;
+                case CaptureOp::PipelineBind:
+                    // the renderer owns a single pipeline which it binds at the start of every frame
+                    hash(&record.id, sizeof(record.id));
+                    break;
+                case CaptureOp::Draw:
+                    draws.push_back({record.id, record.count});
+                    hash(&draws.back(), sizeof(Draw));
+                    break;
+                case CaptureOp::Resize:
+                    glfwSetWindowSize(wnd, record.width, record.height);
+                    break;
+                case CaptureOp::FrameEnd:
+                {
+                    renderFrame();
+
+                    const double cpuTime = Milliseconds(Clock::now() - frameStart).count();
+                    if(timings.is_open())
+                        timings << frame << ' ' << cpuTime << ' ' << std::hex << checksum << std::dec << '\n';
+
+                    if(config.paced)
+                        std::this_thread::sleep_until(frameStart + std::chrono::duration<double>(frameDelta));
+
+                    frame++;
+                    break;
+                }
+            }
+        }
+
+        device.getVkDevice().waitIdle();
+        models.clear();
+    }
+
+    void Replay::renderFrame()
+    {
+        // a frame is only dropped by the swapchain being out of date, retried so every captured frame is rendered
+
+        do
+        {
+            if(wnd.Minimized())
+                glfwWaitEvents();
+            else
+                glfwPollEvents();
+
+            DOT_CHECK(renderer.beginFrame());
+        }
+        while(!renderer.frameStarted() && !glfwWindowShouldClose(wnd));
+
+        if(!renderer.frameStarted())
+            return;
+
+        // caching is off during replay, the version is never compared
+
+        DOT_CHECK(renderer.recordScene(0, [&](const vk::CommandBuffer& cmdBuffer)
+        {
+            for(const auto& draw : draws)
+            {
+                const auto& model = getModel(draw.modelId);
+                model.bind(cmdBuffer);
+                model.draw(cmdBuffer, draw.instanceCount);
+            }
+        }));
+
+        DOT_CHECK(renderer.endFrame());
+    }
+
+    Model& Replay::getModel(uint32_t id) const
+    {
+        auto model = models.find(id);
+        if(model == models.end())
+            throw DOT_RUNTIME("Capture references unknown model " + std::to_string(id));
+
+        return *model->second;
+    }
+}
\ No newline at end of file
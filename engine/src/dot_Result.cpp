@@ -0,0 +1,10 @@
+#include "dot_Result.h"
+#include "dot_Exception.h"
+
+namespace dot
+{
+    void throwError(const Error& error, const char* file, int line)
+    {
+        throw RuntimeError(file, line, std::string(error.what) + " (" + vk::to_string(error.code) + ")");
+    }
+}
\ No newline at end of file
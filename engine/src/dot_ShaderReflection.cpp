@@ -0,0 +1,535 @@
+#include "dot_ShaderReflection.h"
+#include "dot_Exception.h"
+
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+
+namespace dot
+{
+    namespace
+    {
+        // the subset of the spir-v specification the reflection reads
+
+        enum Op : uint32_t
+        {
+            OpEntryPoint = 15,
+            OpTypeInt = 21,
+            OpTypeFloat = 22,
+            OpTypeVector = 23,
+            OpTypeMatrix = 24,
+            OpTypeImage = 25,
+            OpTypeSampler = 26,
+            OpTypeSampledImage = 27,
+            OpTypeArray = 28,
+            OpTypeRuntimeArray = 29,
+            OpTypeStruct = 30,
+            OpTypePointer = 32,
+            OpConstant = 43,
+            OpSpecConstantTrue = 48,
+            OpSpecConstantFalse = 49,
+            OpSpecConstant = 50,
+            OpVariable = 59,
+            OpDecorate = 71,
+            OpMemberDecorate = 72,
+            OpTypeAccelerationStructure = 5341
+        };
+
+        enum Decoration : uint32_t
+        {
+            DecorationSpecId = 1,
+            DecorationBufferBlock = 3,
+            DecorationArrayStride = 6,
+            DecorationMatrixStride = 7,
+            DecorationBuiltIn = 11,
+            DecorationLocation = 30,
+            DecorationBinding = 33,
+            DecorationDescriptorSet = 34,
+            DecorationOffset = 35
+        };
+
+        enum StorageClass : uint32_t
+        {
+            StorageUniformConstant = 0,
+            StorageInput = 1,
+            StorageUniform = 2,
+            StoragePushConstant = 9,
+            StorageStorageBuffer = 12
+        };
+
+        constexpr uint32_t spirvMagic = 0x07230203;
+        constexpr uint32_t none = ~0U;
+
+        struct Decorations
+        {
+            uint32_t set = 0;
+            uint32_t binding = none;
+            uint32_t location = none;
+            uint32_t specId = none;
+            uint32_t arrayStride = 0;
+            bool bufferBlock = false;
+            bool builtIn = false;
+        };
+
+        struct MemberDecorations
+        {
+            uint32_t offset = 0;
+            uint32_t matrixStride = 0;
+        };
+
+        struct Type
+        {
+            uint32_t op;
+            std::vector<uint32_t> operands;     // the words after the result id
+        };
+
+        struct Variable
+        {
+            uint32_t id;
+            uint32_t pointerType;
+            uint32_t storage;
+        };
+
+        class Module
+        {
+        public:
+            Module(std::span<const uint32_t> code)
+            {
+                if(code.size() < 5 || code[0] != spirvMagic)
+                    throw DOT_RUNTIME("Shader code is not spir-v!");
+
+                for(size_t i = 5; i < code.size();)
+                {
+                    const uint32_t op = code[i] & 0xFFFF;
+                    const uint32_t count = code[i] >> 16;
+
+                    if(!count || i + count > code.size())
+                        throw DOT_RUNTIME("Malformed spir-v instruction!");
+
+                    parse(op, code.subspan(i + 1, count - 1));
+                    i += count;
+                }
+            }
+
+            const Type& type(uint32_t id) const
+            {
+                auto found = types.find(id);
+                if(found == types.end())
+                    throw DOT_RUNTIME("Spir-v references an undeclared type!");
+
+                return found->second;
+            }
+
+            const Decorations& decorations(uint32_t id) const
+            {
+                static const Decorations empty;
+
+                auto found = decorationsById.find(id);
+                return found == decorationsById.end() ? empty : found->second;
+            }
+
+            const MemberDecorations& memberDecorations(uint32_t id, uint32_t member) const
+            {
+                static const MemberDecorations empty;
+
+                auto found = memberDecorationsById.find(uint64_t(id) << 32 | member);
+                return found == memberDecorationsById.end() ? empty : found->second;
+            }
+
+            uint32_t constant(uint32_t id) const
+            {
+                auto found = constants.find(id);
+                if(found == constants.end())
+                    throw DOT_RUNTIME("Spir-v array length is not a constant!");
+
+                return found->second;
+            }
+
+            // bytes a type occupies in a block, with the strides the block layout decorated it with
+
+            uint32_t size(uint32_t id, uint32_t matrixStride = 0) const
+            {
+                const Type& t = type(id);
+
+                switch(t.op)
+                {
+                case OpTypeInt:
+                case OpTypeFloat:
+                    return t.operands[0] / 8;
+                case OpTypeVector:
+                    return size(t.operands[0]) * t.operands[1];
+                case OpTypeMatrix:
+                    return (matrixStride ? matrixStride : size(t.operands[0])) * t.operands[1];
+                case OpTypeArray:
+                {
+                    const uint32_t stride = decorations(id).arrayStride;
+                    return (stride ? stride : size(t.operands[0], matrixStride)) * constant(t.operands[1]);
+                }
+                case OpTypeStruct:
+                {
+                    uint32_t end = 0;
+                    for(uint32_t member = 0; member < t.operands.size(); member++)
+                    {
+                        const MemberDecorations& decor = memberDecorations(id, member);
+                        end = std::max(end, decor.offset + size(t.operands[member], decor.matrixStride));
+                    }
+
+                    return end;
+                }
+                default:
+                    return 0;
+                }
+            }
+
+            vk::ShaderStageFlags stages;
+            std::vector<uint32_t> specConstants;
+            std::vector<Variable> variables;
+        private:
+            void parse(uint32_t op, std::span<const uint32_t> operands)
+            {
+                switch(op)
+                {
+                case OpEntryPoint:
+                    stages |= stage(operands[0]);
+                    break;
+                case OpDecorate:
+                    decorate(decorationsById[operands[0]], operands[1], operands.subspan(2));
+                    break;
+                case OpMemberDecorate:
+                {
+                    MemberDecorations& decor = memberDecorationsById[uint64_t(operands[0]) << 32 | operands[1]];
+                    if(operands[2] == DecorationOffset)
+                        decor.offset = operands[3];
+                    else if(operands[2] == DecorationMatrixStride)
+                        decor.matrixStride = operands[3];
+                    break;
+                }
+                case OpTypeInt:
+                case OpTypeFloat:
+                case OpTypeVector:
+                case OpTypeMatrix:
+                case OpTypeImage:
+                case OpTypeSampler:
+                case OpTypeSampledImage:
+                case OpTypeArray:
+                case OpTypeRuntimeArray:
+                case OpTypeStruct:
+                case OpTypePointer:
+                case OpTypeAccelerationStructure:
+                    types[operands[0]] = Type{op, {operands.begin() + 1, operands.end()}};
+                    break;
+                case OpConstant:
+                    constants[operands[1]] = operands[2];
+                    break;
+                case OpSpecConstantTrue:
+                case OpSpecConstantFalse:
+                case OpSpecConstant:
+                    // decorations come before the constants they decorate
+                    specConstants.push_back(decorations(operands[1]).specId);
+                    break;
+                case OpVariable:
+                    variables.push_back({operands[1], operands[0], operands[2]});
+                    break;
+                }
+            }
+
+            static void decorate(Decorations& decor, uint32_t decoration, std::span<const uint32_t> values)
+            {
+                switch(decoration)
+                {
+                case DecorationSpecId:          decor.specId = values[0]; break;
+                case DecorationBufferBlock:     decor.bufferBlock = true; break;
+                case DecorationArrayStride:     decor.arrayStride = values[0]; break;
+                case DecorationBuiltIn:         decor.builtIn = true; break;
+                case DecorationLocation:        decor.location = values[0]; break;
+                case DecorationBinding:         decor.binding = values[0]; break;
+                case DecorationDescriptorSet:   decor.set = values[0]; break;
+                }
+            }
+
+            static vk::ShaderStageFlags stage(uint32_t executionModel) noexcept
+            {
+                switch(executionModel)
+                {
+                case 0: return vk::ShaderStageFlagBits::eVertex;
+                case 1: return vk::ShaderStageFlagBits::eTessellationControl;
+                case 2: return vk::ShaderStageFlagBits::eTessellationEvaluation;
+                case 3: return vk::ShaderStageFlagBits::eGeometry;
+                case 4: return vk::ShaderStageFlagBits::eFragment;
+                case 5: return vk::ShaderStageFlagBits::eCompute;
+                default: return {};
+                }
+            }
+
+            std::unordered_map<uint32_t, Type> types;
+            std::unordered_map<uint32_t, Decorations> decorationsById;
+            std::unordered_map<uint64_t, MemberDecorations> memberDecorationsById;
+            std::unordered_map<uint32_t, uint32_t> constants;
+        };
+
+        vk::DescriptorType descriptorType(const Module& module, uint32_t typeId, uint32_t storage)
+        {
+            const Type& type = module.type(typeId);
+
+            switch(type.op)
+            {
+            case OpTypeStruct:
+                // BufferBlock is how spir-v before 1.3 marks storage buffers in the uniform storage class
+                return storage == StorageUniform && !module.decorations(typeId).bufferBlock
+                    ? vk::DescriptorType::eUniformBuffer
+                    : vk::DescriptorType::eStorageBuffer;
+            case OpTypeSampler:
+                return vk::DescriptorType::eSampler;
+            case OpTypeSampledImage:
+                return module.type(type.operands[0]).operands[1] == 5
+                    ? vk::DescriptorType::eUniformTexelBuffer
+                    : vk::DescriptorType::eCombinedImageSampler;
+            case OpTypeImage:
+            {
+                // operands: sampled type, dim, depth, arrayed, multisampled, sampled (1 with a sampler, 2 storage)
+
+                const uint32_t dim = type.operands[1];
+                const bool storageImage = type.operands[5] == 2;
+
+                if(dim == 5)
+                    return storageImage ? vk::DescriptorType::eStorageTexelBuffer : vk::DescriptorType::eUniformTexelBuffer;
+                if(dim == 6)
+                    return vk::DescriptorType::eInputAttachment;
+
+                return storageImage ? vk::DescriptorType::eStorageImage : vk::DescriptorType::eSampledImage;
+            }
+            case OpTypeAccelerationStructure:
+                return vk::DescriptorType::eAccelerationStructureKHR;
+            default:
+                throw DOT_RUNTIME("Unsupported spir-v descriptor type!");
+            }
+        }
+
+        vk::Format inputFormat(const Module& module, const Type& type) noexcept
+        {
+            static const vk::Format formats[3][4] =
+            {
+                {vk::Format::eR32Sfloat, vk::Format::eR32G32Sfloat, vk::Format::eR32G32B32Sfloat, vk::Format::eR32G32B32A32Sfloat},
+                {vk::Format::eR32Sint, vk::Format::eR32G32Sint, vk::Format::eR32G32B32Sint, vk::Format::eR32G32B32A32Sint},
+                {vk::Format::eR32Uint, vk::Format::eR32G32Uint, vk::Format::eR32G32B32Uint, vk::Format::eR32G32B32A32Uint}
+            };
+
+            uint32_t components = 1;
+            const Type* scalar = &type;
+
+            if(type.op == OpTypeVector)
+            {
+                components = type.operands[1];
+                scalar = &module.type(type.operands[0]);
+            }
+
+            // 64 and 16 bit inputs are left undefined, validation skips them
+
+            if(components > 4 || scalar->operands[0] != 32)
+                return vk::Format::eUndefined;
+
+            if(scalar->op == OpTypeFloat)
+                return formats[0][components - 1];
+            if(scalar->op == OpTypeInt)
+                return formats[scalar->operands[1] ? 1 : 2][components - 1];
+
+            return vk::Format::eUndefined;
+        }
+
+        // 'f' for formats the shader reads as floats, 'i' and 'u' for signed and unsigned integers
+
+        char numericType(vk::Format format)
+        {
+            const std::string name = vk::to_string(format);
+
+            if(name.ends_with("Sfloat") || name.ends_with("norm") || name.ends_with("scaled") || name.ends_with("Srgb") || name.ends_with("Ufloat"))
+                return 'f';
+            if(name.ends_with("Sint"))
+                return 'i';
+            if(name.ends_with("Uint"))
+                return 'u';
+
+            return 0;
+        }
+    }
+
+    ShaderLayout ShaderLayout::reflect(std::span<const uint32_t> code)
+    {
+        const Module module(code);
+
+        ShaderLayout layout;
+        layout.stages = module.stages;
+        layout.specConstants = module.specConstants;
+
+        for(const Variable& variable : module.variables)
+        {
+            const Decorations& decor = module.decorations(variable.id);
+            const Type& pointer = module.type(variable.pointerType);
+            uint32_t typeId = pointer.operands[1];
+
+            switch(variable.storage)
+            {
+            case StorageUniformConstant:
+            case StorageUniform:
+            case StorageStorageBuffer:
+            {
+                if(decor.binding == none)
+                    break;
+
+                // arrays of descriptors, sized by a constant or by the bound descriptor count
+
+                uint32_t count = 1;
+                const Type& type = module.type(typeId);
+
+                if(type.op == OpTypeArray)
+                {
+                    count = module.constant(type.operands[1]);
+                    typeId = type.operands[0];
+                }
+                else if(type.op == OpTypeRuntimeArray)
+                {
+                    count = 0;
+                    typeId = type.operands[0];
+                }
+
+                layout.bindings.push_back({decor.set, decor.binding, descriptorType(module, typeId, variable.storage), count, module.stages});
+                break;
+            }
+            case StoragePushConstant:
+            {
+                // the block spans from its first member offset, push_constant blocks may start past zero
+
+                const Type& block = module.type(typeId);
+
+                uint32_t offset = ~0U;
+                for(uint32_t member = 0; member < block.operands.size(); member++)
+                    offset = std::min(offset, module.memberDecorations(typeId, member).offset);
+
+                const uint32_t size = module.size(typeId);
+                if(size > offset)
+                    layout.pushConstants = {vk::PushConstantRange(module.stages, offset, size - offset)};
+                break;
+            }
+            case StorageInput:
+            {
+                if(!(module.stages & vk::ShaderStageFlagBits::eVertex) || decor.builtIn || decor.location == none)
+                    break;
+
+                const Type& type = module.type(typeId);
+
+                if(type.op == OpTypeMatrix)
+                {
+                    const vk::Format column = inputFormat(module, module.type(type.operands[0]));
+                    for(uint32_t i = 0; i < type.operands[1]; i++)
+                        layout.inputs.push_back({decor.location + i, column});
+                }
+                else if(type.op != OpTypeStruct)
+                    layout.inputs.push_back({decor.location, inputFormat(module, type)});
+                break;
+            }
+            }
+        }
+
+        std::sort(layout.bindings.begin(), layout.bindings.end(), [](const auto& a, const auto& b){ return a.set != b.set ? a.set < b.set : a.binding < b.binding; });
+        std::sort(layout.specConstants.begin(), layout.specConstants.end());
+        std::sort(layout.inputs.begin(), layout.inputs.end(), [](const auto& a, const auto& b){ return a.location < b.location; });
+
+        return layout;
+    }
+
+    void ShaderLayout::merge(const ShaderLayout& other)
+    {
+        // a binding both stages declare must agree on what it is, the stages that see it are combined
+
+        for(const ShaderBinding& binding : other.bindings)
+        {
+            auto found = std::find_if(bindings.begin(), bindings.end(), [&](const auto& b){ return b.set == binding.set && b.binding == binding.binding; });
+
+            if(found == bindings.end())
+                bindings.push_back(binding);
+            else if(found->type != binding.type || found->count != binding.count)
+                throw DOT_RUNTIME("Shader stages disagree on set " + std::to_string(binding.set) + " binding " + std::to_string(binding.binding) + "!");
+            else
+                found->stages |= binding.stages;
+        }
+
+        // one range covering every stage's block keeps push constant commands to a single stage mask
+
+        if(!other.pushConstants.empty())
+        {
+            if(pushConstants.empty())
+                pushConstants = other.pushConstants;
+            else
+            {
+                vk::PushConstantRange& range = pushConstants[0];
+                const vk::PushConstantRange& add = other.pushConstants[0];
+
+                const uint32_t end = std::max(range.offset + range.size, add.offset + add.size);
+                range.offset = std::min(range.offset, add.offset);
+                range.size = end - range.offset;
+                range.stageFlags |= add.stageFlags;
+            }
+        }
+
+        stages |= other.stages;
+        specConstants.insert(specConstants.end(), other.specConstants.begin(), other.specConstants.end());
+        inputs.insert(inputs.end(), other.inputs.begin(), other.inputs.end());
+
+        std::sort(bindings.begin(), bindings.end(), [](const auto& a, const auto& b){ return a.set != b.set ? a.set < b.set : a.binding < b.binding; });
+        std::sort(specConstants.begin(), specConstants.end());
+        specConstants.erase(std::unique(specConstants.begin(), specConstants.end()), specConstants.end());
+        std::sort(inputs.begin(), inputs.end(), [](const auto& a, const auto& b){ return a.location < b.location; });
+    }
+
+    void ShaderLayout::makeDynamic(uint32_t set, uint32_t binding) noexcept
+    {
+        for(ShaderBinding& b : bindings)
+        {
+            if(b.set != set || b.binding != binding)
+                continue;
+
+            if(b.type == vk::DescriptorType::eUniformBuffer)
+                b.type = vk::DescriptorType::eUniformBufferDynamic;
+            else if(b.type == vk::DescriptorType::eStorageBuffer)
+                b.type = vk::DescriptorType::eStorageBufferDynamic;
+        }
+    }
+
+    uint32_t ShaderLayout::setCount() const noexcept
+    {
+        return bindings.empty() ? 0 : bindings.back().set + 1;
+    }
+
+    std::vector<vk::DescriptorSetLayoutBinding> ShaderLayout::setBindings(uint32_t set) const
+    {
+        std::vector<vk::DescriptorSetLayoutBinding> setBindings;
+
+        for(const ShaderBinding& binding : bindings)
+        {
+            if(binding.set == set)
+                setBindings.emplace_back(binding.binding, binding.type, binding.count, binding.stages);
+        }
+
+        return setBindings;
+    }
+
+    void ShaderLayout::validateVertexInput(std::span<const vk::VertexInputAttributeDescription> attributes) const
+    {
+        for(const ShaderInput& input : inputs)
+        {
+            auto found = std::find_if(attributes.begin(), attributes.end(), [&](const auto& attribute){ return attribute.location == input.location; });
+
+            if(found == attributes.end())
+                throw DOT_RUNTIME("Vertex shader input at location " + std::to_string(input.location) + " has no attribute!");
+
+            if(input.format != vk::Format::eUndefined && numericType(found->format) != numericType(input.format))
+            {
+                throw DOT_RUNTIME
+                (
+                    "Vertex attribute at location " + std::to_string(input.location) + " is " + vk::to_string(found->format) +
+                    ", the shader reads " + vk::to_string(input.format) + "!"
+                );
+            }
+        }
+    }
+}
\ No newline at end of file
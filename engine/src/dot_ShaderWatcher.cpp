@@ -0,0 +1,229 @@
+#include "dot_ShaderWatcher.h"
+#include "dot_Exception.h"
+#include "dot_Logger.h"
+
+#include "Shader.h"
+
+#include <cerrno>
+#include <filesystem>
+#include <set>
+
+#if defined(__linux__)
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <spawn.h>
+    #include <sys/inotify.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
+
+namespace dot
+{
+    ShaderWatcher::ShaderWatcher(const std::string& sourceDir, std::function<void()> onCompiled, const std::string& compiler)
+        : sourceDir(sourceDir), compiler(compiler), onCompiled(std::move(onCompiled))
+    {
+#if defined(__linux__)
+        inotifyFd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if(inotifyFd < 0)
+            throw DOT_RUNTIME("Failed to initialize inotify!");
+
+        // editors either rewrite the file or write a new one and rename it over the old
+
+        if(inotify_add_watch(inotifyFd, sourceDir.c_str(), IN_CLOSE_WRITE | IN_MOVED_TO) < 0)
+        {
+            close(inotifyFd);
+            throw DOT_RUNTIME("Failed to watch shader directory: " + sourceDir);
+        }
+
+        watcher = std::thread(&ShaderWatcher::watch, this);
+#else
+        DOT_LOG(Warning, Engine, "Shader hot reload needs inotify, shaders are not watched");
+#endif
+    }
+
+    ShaderWatcher::~ShaderWatcher()
+    {
+        stopping = true;
+
+        if(watcher.joinable())
+            watcher.join();
+
+#if defined(__linux__)
+        if(inotifyFd >= 0)
+            close(inotifyFd);
+#endif
+    }
+
+    std::vector<ShaderWatcher::Compiled> ShaderWatcher::takeCompiled()
+    {
+        std::lock_guard lock(compiledMutex);
+        compiledPending = false;
+
+        return std::move(compiled);
+    }
+
+    bool ShaderWatcher::hasCompiled() const noexcept
+    {
+        return compiledPending;
+    }
+
+    std::string ShaderWatcher::spirvName(const std::string& source)
+    {
+        // same names the build gives: shader.vert is vert.spv, tonemap.frag is tonemap_frag.spv
+
+        const std::filesystem::path path(source);
+        const std::string stage = path.extension().string().substr(1);
+
+        if(path.stem() == "shader")
+            return stage + ".spv";
+
+        return path.stem().string() + "_" + stage + ".spv";
+    }
+
+    void ShaderWatcher::watch()
+    {
+#if defined(__linux__)
+        // the timeout bounds how long the destructor waits for the thread
+
+        alignas(inotify_event) char buffer[4096];
+        pollfd pollFd{inotifyFd, POLLIN, 0};
+
+        while(!stopping)
+        {
+            if(poll(&pollFd, 1, pollMs) <= 0)
+                continue;
+
+            std::set<std::string> changed;
+
+            do
+            {
+                ssize_t length;
+                while((length = read(inotifyFd, buffer, sizeof(buffer))) > 0)
+                {
+                    for(char* pEvent = buffer; pEvent < buffer + length;)
+                    {
+                        const auto* event = reinterpret_cast<const inotify_event*>(pEvent);
+                        const std::filesystem::path name(event->len ? event->name : "");
+
+                        if(name.extension() == ".vert" || name.extension() == ".frag")
+                            changed.insert(name.string());
+
+                        pEvent += sizeof(inotify_event) + event->len;
+                    }
+                }
+            }
+            while(!stopping && poll(&pollFd, 1, debounceMs) > 0);
+
+            for(const auto& source : changed)
+                compile(source);
+        }
+#endif
+    }
+
+    bool ShaderWatcher::run(const std::vector<std::string>& args, std::string& output)
+    {
+#if defined(__linux__)
+        // spawned without a shell, file names from inotify are passed as they are and never parsed
+
+        int pipeFds[2];
+        if(pipe2(pipeFds, O_CLOEXEC) != 0)
+        {
+            output = "Failed to create a pipe for " + args.front();
+            return false;
+        }
+
+        std::vector<char*> argv;
+        for(const auto& arg : args)
+            argv.push_back(const_cast<char*>(arg.c_str()));
+        argv.push_back(nullptr);
+
+        posix_spawn_file_actions_t actions;
+        posix_spawn_file_actions_init(&actions);
+        posix_spawn_file_actions_adddup2(&actions, pipeFds[1], STDOUT_FILENO);
+        posix_spawn_file_actions_adddup2(&actions, pipeFds[1], STDERR_FILENO);
+
+        pid_t pid;
+        const int spawned = posix_spawnp(&pid, argv.front(), &actions, nullptr, argv.data(), environ);
+        posix_spawn_file_actions_destroy(&actions);
+        close(pipeFds[1]);
+
+        if(spawned != 0)
+        {
+            close(pipeFds[0]);
+            output = "Failed to start " + args.front();
+            return false;
+        }
+
+        char buffer[256];
+        ssize_t length;
+        while((length = read(pipeFds[0], buffer, sizeof(buffer))) > 0 || (length < 0 && errno == EINTR))
+            if(length > 0)
+                output.append(buffer, static_cast<size_t>(length));
+        close(pipeFds[0]);
+
+        int status = 0;
+        while(waitpid(pid, &status, 0) < 0 && errno == EINTR);
+
+        return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+#else
+        return false;
+#endif
+    }
+
+    void ShaderWatcher::compile(const std::string& source)
+    {
+#if defined(__linux__)
+        const auto sourcePath = (std::filesystem::path(sourceDir) / source).string();
+        const auto outputPath = (std::filesystem::temp_directory_path() / ("dot_reload_" + spirvName(source))).string();
+        const auto unoptimizedPath = outputPath + ".unoptimized";
+
+        // same steps as the build, a failed one is logged with its output and leaves the running pipeline untouched
+
+        const std::vector<std::vector<std::string>> steps =
+        {
+            {compiler, "--target-env=vulkan1.2", sourcePath, "-o", unoptimizedPath},
+            {optimizer, "-O", unoptimizedPath, "-o", outputPath},
+            {validator, "--target-env", "vulkan1.2", outputPath}
+        };
+
+        for(const auto& step : steps)
+        {
+            std::string output;
+            if(!run(step, output))
+            {
+                std::error_code error;
+                std::filesystem::remove(unoptimizedPath, error);
+                std::filesystem::remove(outputPath, error);
+
+                const std::string message = "Shader " + source + " failed in " + step.front() + ", previous pipeline kept:\n" + output;
+                DOT_LOG(Error, Engine, message.c_str());
+                return;
+            }
+        }
+
+        try
+        {
+            Compiled result{spirvName(source), Shader::readFile(outputPath)};
+            std::filesystem::remove(unoptimizedPath);
+            std::filesystem::remove(outputPath);
+
+            {
+                std::lock_guard lock(compiledMutex);
+                std::erase_if(compiled, [&](const Compiled& entry){ return entry.name == result.name; });
+                compiled.push_back(std::move(result));
+                compiledPending = true;
+            }
+
+            const std::string message = "Shader " + source + " recompiled";
+            DOT_LOG(Info, Engine, message.c_str());
+
+            if(onCompiled)
+                onCompiled();
+        }
+        catch(const std::exception& e)
+        {
+            DOT_LOG(Error, Engine, e.what());
+        }
+#endif
+    }
+}
\ No newline at end of file
@@ -0,0 +1,42 @@
+#include "dot_Stats.h"
+
+#include <algorithm>
+#include <numeric>
+#include <cmath>
+
+namespace dot
+{
+    Statistics::Statistics(std::vector<double> samples)
+    {
+        count = samples.size();
+
+        if(samples.empty())
+            return;
+
+        std::sort(samples.begin(), samples.end());
+
+        min = samples.front();
+        max = samples.back();
+        mean = std::accumulate(samples.begin(), samples.end(), 0.0) / count;
+        median = percentile(samples, 0.5);
+        p95 = percentile(samples, 0.95);
+        p99 = percentile(samples, 0.99);
+
+        double variance = 0.0;
+        for(const auto& sample : samples)
+            variance += (sample - mean) * (sample - mean);
+
+        stddev = count > 1 ? std::sqrt(variance / (count - 1)) : 0.0;
+    }
+
+    double Statistics::percentile(const std::vector<double>& sorted, double p) noexcept
+    {
+        // linear interpolation between closest ranks
+
+        const double rank = p * (sorted.size() - 1);
+        const size_t lower = static_cast<size_t>(rank);
+        const size_t upper = std::min(lower + 1, sorted.size() - 1);
+
+        return sorted[lower] + (sorted[upper] - sorted[lower]) * (rank - lower);
+    }
+}
\ No newline at end of file
@@ -3,16 +3,30 @@
 
 #include <limits>
 #include <algorithm>
+#include <array>
+#include <iterator>
+#include <memory>
 
 namespace dot
 {
-    Swapchain::Swapchain(Window& wnd, Device& device, std::shared_ptr<Swapchain> oldSwapchain)
-        : wnd(wnd), device(device), oldSwapchain(oldSwapchain)
+    Swapchain::Swapchain
+    (
+        Window& wnd, Device& device, Swapchain* pOldSwapchain, vk::Format depthFormat,
+        vk::SampleCountFlagBits samples, const PostConfig& post, bool dynamicRendering
+    )
+        : wnd(wnd), device(device), depthFormat(depthFormat), samples(samples), dynamicRendering(dynamicRendering), post(post)
     {
-        createSwapchain();
+        // the old swapchain is retired by the caller once its frames completed, it is only borrowed here
+
+        createSwapchain(pOldSwapchain);
         createImageViews();
-        createRenderPass();
+        createDepthImages();
+        createPostTargets();
+        createColorImages();
+        createRenderPass(pOldSwapchain);
+        createStageRenderPasses(pOldSwapchain);
         createFramebuffers();
+        createStageFramebuffers();
         createSyncObjects();
     }
 
@@ -23,7 +37,16 @@ namespace dot
         for(const auto& framebuffer : framebuffers)
             device.getVkDevice().destroyFramebuffer(framebuffer);
 
-        device.getVkDevice().destroyRenderPass(renderPass);
+        for(const auto& stage : stageFramebuffers)
+            for(const auto& framebuffer : stage)
+                device.getVkDevice().destroyFramebuffer(framebuffer);
+
+        if(ownsRenderPass)
+            device.getVkDevice().destroyRenderPass(renderPass);
+
+        if(ownsStageRenderPasses)
+            for(const auto& stageRenderPass : stageRenderPasses)
+                device.getVkDevice().destroyRenderPass(stageRenderPass);
 
         for(const auto& imageView : imageViews)
             device.getVkDevice().destroyImageView(imageView);
@@ -31,39 +54,18 @@ namespace dot
         device.getVkDevice().destroySwapchainKHR(swapchain);
     }
 
-    vk::Result Swapchain::acquireNextImage(uint32_t& index) const
+    vk::Result Swapchain::acquireNextImage(VkSemaphore imageAvailable, uint32_t& index) const noexcept
     {
-        const vk::Device& device = this->device.getVkDevice();
-        const size_t frame = currentFrameInFlight;
-        const uint64_t max = std::numeric_limits<uint64_t>::max();
-
-        device.waitForFences(imageInFlightFences[frame], VK_TRUE, max);
-
         // using vulkan c api to prevent from throwing an exception
 
-        return vk::Result(vkAcquireNextImageKHR(device, swapchain, max, imageAvailableSemaphores[frame], nullptr, &index));
+        return vk::Result(vkAcquireNextImageKHR(device.getVkDevice(), swapchain, std::numeric_limits<uint64_t>::max(), imageAvailable, nullptr, &index));
     }
 
-    vk::Result Swapchain::submitCmdBuffer(const vk::CommandBuffer& cmdBuffer, uint32_t imageIndex)
+    vk::Result Swapchain::present(uint32_t imageIndex) const noexcept
     {
-        device.getVkDevice().waitForFences(imageInFlightFences[currentFrameInFlight], VK_TRUE, std::numeric_limits<uint64_t>::max());
-
-        vk::PipelineStageFlags waitStages[] = {vk::PipelineStageFlagBits::eColorAttachmentOutput};
-        vk::SubmitInfo submitInfo
-        (
-            imageAvailableSemaphores[currentFrameInFlight], // waitSemaphores
-            waitStages,                                     // waitDstStageMask
-            cmdBuffer,                                      // commandBuffers
-            renderFinishedSemaphores[currentFrameInFlight]  // signalSemaphores
-        );
-
-        device.getVkDevice().resetFences(imageInFlightFences[currentFrameInFlight]);
-
-        device.getGfxQueue().submit(submitInfo, imageInFlightFences[currentFrameInFlight]);
-
         // using vulkan c api to prevent from throwing an exception
 
-        VkSemaphore waitSemaphores[] = {renderFinishedSemaphores[currentFrameInFlight]};
+        VkSemaphore waitSemaphores[] = {renderFinishedSemaphores[imageIndex]};
         VkSwapchainKHR swapchains[] = {swapchain};
 
         VkPresentInfoKHR vkPresentInfo
@@ -76,8 +78,6 @@ namespace dot
             .pImageIndices = &imageIndex
         };
 
-        currentFrameInFlight = (currentFrameInFlight + 1) % maxFramesInFlight;
-
         return vk::Result(vkQueuePresentKHR(device.getPresentQueue(), &vkPresentInfo));
     }
 
@@ -96,17 +96,261 @@ namespace dot
         return renderPass;
     }
 
+    const std::vector<vk::ClearValue>& Swapchain::getClearValues() const noexcept
+    {
+        return clearValues;
+    }
+
+    bool Swapchain::hasDepth() const noexcept
+    {
+        return depthFormat != vk::Format::eUndefined;
+    }
+
+    bool Swapchain::usesDynamicRendering() const noexcept
+    {
+        return dynamicRendering;
+    }
+
+    vk::Format Swapchain::getColorFormat() const noexcept
+    {
+        return getStageFormat(0);
+    }
+
+    vk::Format Swapchain::getDepthFormat() const noexcept
+    {
+        return depthFormat;
+    }
+
+    void Swapchain::beginRendering(const vk::CommandBuffer& cmdBuffer, size_t index, vk::RenderingFlagsKHR flags) const noexcept
+    {
+        // without a render pass the layout transitions are recorded here; nothing is kept from the previous frame,
+        // every attachment starts undefined once the previous writes to it finished
+
+        const vk::ImageSubresourceRange colorRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1);
+        const vk::ImageAspectFlags depthAspect = depthFormat == vk::Format::eD32Sfloat ?
+                                                 vk::ImageAspectFlagBits::eDepth :
+                                                 vk::ImageAspectFlagBits::eDepth | vk::ImageAspectFlagBits::eStencil;
+        const vk::ImageSubresourceRange depthRange(depthAspect, 0, 1, 0, 1);
+
+        auto colorBarrier = [&](const vk::Image& image)
+        {
+            return vk::ImageMemoryBarrier
+            (
+                vk::AccessFlagBits::eNone,                      // srcAccessMask
+                vk::AccessFlagBits::eColorAttachmentWrite,      // dstAccessMask
+                vk::ImageLayout::eUndefined,                    // oldLayout
+                vk::ImageLayout::eColorAttachmentOptimal,       // newLayout
+                VK_QUEUE_FAMILY_IGNORED,                        // srcQueueFamilyIndex
+                VK_QUEUE_FAMILY_IGNORED,                        // dstQueueFamilyIndex
+                image,                                          // image
+                colorRange                                      // subresourceRange
+            );
+        };
+
+        std::array<vk::ImageMemoryBarrier, 3> barriers;
+        uint32_t barrierCount = 0;
+
+        barriers[barrierCount++] = colorBarrier(images[index]);
+        if(!colorImages.empty())
+            barriers[barrierCount++] = colorBarrier(*colorImages[index]);
+
+        vk::PipelineStageFlags stages = vk::PipelineStageFlagBits::eColorAttachmentOutput;
+        if(hasDepth())
+        {
+            stages |= vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests;
+            barriers[barrierCount++] = vk::ImageMemoryBarrier
+            (
+                vk::AccessFlagBits::eDepthStencilAttachmentWrite,                                                   // srcAccessMask
+                vk::AccessFlagBits::eDepthStencilAttachmentRead | vk::AccessFlagBits::eDepthStencilAttachmentWrite, // dstAccessMask
+                vk::ImageLayout::eUndefined,                                                                        // oldLayout
+                vk::ImageLayout::eDepthStencilAttachmentOptimal,                                                    // newLayout
+                VK_QUEUE_FAMILY_IGNORED,                                                                            // srcQueueFamilyIndex
+                VK_QUEUE_FAMILY_IGNORED,                                                                            // dstQueueFamilyIndex
+                *depthImages[index],                                                                                // image
+                depthRange                                                                                          // subresourceRange
+            );
+        }
+
+        cmdBuffer.pipelineBarrier(stages, stages, vk::DependencyFlagBits::eByRegion, 0, nullptr, 0, nullptr, barrierCount, barriers.data());
+
+        // multisampled color is resolved into the swapchain image when rendering ends
+
+        vk::RenderingAttachmentInfoKHR colorAttachment
+        (
+            imageViews[index],                                  // imageView
+            vk::ImageLayout::eColorAttachmentOptimal,           // imageLayout
+            vk::ResolveModeFlagBits::eNone,                     // resolveMode
+            {},                                                 // resolveImageView
+            vk::ImageLayout::eUndefined,                        // resolveImageLayout
+            vk::AttachmentLoadOp::eClear,                       // loadOp
+            vk::AttachmentStoreOp::eStore,                      // storeOp
+            clearValues[0]                                      // clearValue
+        );
+
+        if(!colorImages.empty())
+        {
+            colorAttachment.imageView = colorImages[index]->getView();
+            colorAttachment.resolveMode = vk::ResolveModeFlagBits::eAverage;
+            colorAttachment.resolveImageView = imageViews[index];
+            colorAttachment.resolveImageLayout = vk::ImageLayout::eColorAttachmentOptimal;
+            colorAttachment.storeOp = vk::AttachmentStoreOp::eDontCare;
+        }
+
+        vk::RenderingAttachmentInfoKHR depthAttachment
+        (
+            hasDepth() ? depthImages[index]->getView() : vk::ImageView(),    // imageView
+            vk::ImageLayout::eDepthStencilAttachmentOptimal,                // imageLayout
+            vk::ResolveModeFlagBits::eNone,                                 // resolveMode
+            {},                                                             // resolveImageView
+            vk::ImageLayout::eUndefined,                                    // resolveImageLayout
+            vk::AttachmentLoadOp::eClear,                                   // loadOp
+            vk::AttachmentStoreOp::eDontCare,                               // storeOp
+            vk::ClearDepthStencilValue(1.0f, 0)                             // clearValue
+        );
+
+        vk::RenderingInfoKHR renderingInfo
+        (
+            flags,                                              // flags
+            vk::Rect2D(vk::Offset2D(0, 0), extent),             // renderArea
+            1,                                                  // layerCount
+            0,                                                  // viewMask
+            colorAttachment,                                    // colorAttachments
+            hasDepth() ? &depthAttachment : nullptr             // pDepthAttachment
+        );
+
+        device.cmdBeginRendering(cmdBuffer, renderingInfo);
+    }
+
+    void Swapchain::endRendering(const vk::CommandBuffer& cmdBuffer, size_t index) const noexcept
+    {
+        device.cmdEndRendering(cmdBuffer);
+
+        vk::ImageMemoryBarrier presentBarrier
+        (
+            vk::AccessFlagBits::eColorAttachmentWrite,                          // srcAccessMask
+            vk::AccessFlagBits::eNone,                                          // dstAccessMask
+            vk::ImageLayout::eColorAttachmentOptimal,                           // oldLayout
+            vk::ImageLayout::ePresentSrcKHR,                                    // newLayout
+            VK_QUEUE_FAMILY_IGNORED,                                            // srcQueueFamilyIndex
+            VK_QUEUE_FAMILY_IGNORED,                                            // dstQueueFamilyIndex
+            images[index],                                                      // image
+            vk::ImageSubresourceRange(vk::ImageAspectFlagBits::eColor, 0, 1, 0, 1) // subresourceRange
+        );
+
+        cmdBuffer.pipelineBarrier
+        (
+            vk::PipelineStageFlagBits::eColorAttachmentOutput, vk::PipelineStageFlagBits::eBottomOfPipe,
+            vk::DependencyFlags(), 0, nullptr, 0, nullptr, 1, &presentBarrier
+        );
+    }
+
+    void Swapchain::setSamples(vk::SampleCountFlagBits newSamples)
+    {
+        if(newSamples == samples)
+            return;
+
+        samples = newSamples;
+
+        // only the scene attachments depend on the sample count, the swapchain, post targets and stage passes are kept;
+        // frames in flight may still use the old render pass, framebuffers and the attachments they reference
+
+        auto pImages = std::make_shared<std::vector<std::unique_ptr<Image>>>(std::move(depthImages));
+        std::move(colorImages.begin(), colorImages.end(), std::back_inserter(*pImages));
+
+        auto destroy = [&device = device, renderPass = ownsRenderPass ? renderPass : vk::RenderPass(), framebuffers = framebuffers, pImages]
+        {
+            for(const auto& framebuffer : framebuffers)
+                device.getVkDevice().destroyFramebuffer(framebuffer);
+
+            if(renderPass)
+                device.getVkDevice().destroyRenderPass(renderPass);
+
+            pImages->clear();
+        };
+
+        device.retire(destroy);
+
+        framebuffers.clear();
+        depthImages.clear();
+        colorImages.clear();
+        ownsRenderPass = true;
+
+        createDepthImages();
+        createColorImages();
+        createRenderPass(nullptr);
+        createFramebuffers();
+    }
+
+    vk::SampleCountFlagBits Swapchain::getSamples() const noexcept
+    {
+        return samples;
+    }
+
     const vk::Framebuffer& Swapchain::getFramebuffer(size_t index) const noexcept
     {
         return framebuffers[index];
     }
 
-    size_t Swapchain::getMaxFramesInFlight() const noexcept
+    size_t Swapchain::getStageCount() const noexcept
     {
-        return maxFramesInFlight;
+        return effects.size();
     }
 
-    void Swapchain::createSwapchain()
+    size_t Swapchain::getMergedStageCount() const noexcept
+    {
+        return mergedStages;
+    }
+
+    PostEffect Swapchain::getStageEffect(size_t stage) const noexcept
+    {
+        return effects[stage - 1];
+    }
+
+    const vk::RenderPass& Swapchain::getStageRenderPass(size_t stage) const noexcept
+    {
+        return stage <= mergedStages ? renderPass : stageRenderPasses[stage - mergedStages - 1];
+    }
+
+    uint32_t Swapchain::getStageSubpass(size_t stage) const noexcept
+    {
+        return stage <= mergedStages ? static_cast<uint32_t>(stage) : 0U;
+    }
+
+    const vk::Framebuffer& Swapchain::getStageFramebuffer(size_t stage, size_t index) const noexcept
+    {
+        return stageFramebuffers[stage - mergedStages - 1][index];
+    }
+
+    const vk::ImageView& Swapchain::getStageInput(size_t stage, size_t index) const noexcept
+    {
+        return getStageOutput(stage - 1, index);
+    }
+
+    vk::DeviceSize Swapchain::getPostTrafficBytes() const noexcept
+    {
+        // every stored target is written once and read once per frame, merged targets stay in tile memory
+
+        vk::DeviceSize bytes = 0;
+        for(size_t stage = mergedStages; stage < effects.size(); stage++)
+        {
+            const vk::DeviceSize texelSize = getStageFormat(stage) == vk::Format::eR16G16B16A16Sfloat ? 8 : 4;
+            bytes += 2 * texelSize * extent.width * extent.height;
+        }
+
+        return bytes;
+    }
+
+    const vk::Semaphore& Swapchain::getRenderFinishedSemaphore(size_t index) const noexcept
+    {
+        return renderFinishedSemaphores[index];
+    }
+
+    size_t Swapchain::getImageCount() const noexcept
+    {
+        return images.size();
+    }
+
+    void Swapchain::createSwapchain(Swapchain* pOldSwapchain)
     {
         auto swapchainDetails = device.getSwapchainDetails();
         auto queueIndices = device.getQueueFamiliyIndices();
@@ -121,8 +365,6 @@ namespace dot
         if(swapchainDetails.capabilities.maxImageCount > 0 && imageCount > swapchainDetails.capabilities.maxImageCount)
             imageCount = swapchainDetails.capabilities.maxImageCount;
 
-        maxFramesInFlight = imageCount;
-
         uint32_t queueFamilyIndices[] = {queueIndices.graphicFamily.value(), queueIndices.presentFamily.value()};
         
         vk::SwapchainCreateInfoKHR createInfo
@@ -141,7 +383,7 @@ namespace dot
             vk::CompositeAlphaFlagBitsKHR::eOpaque,                     // compositeAplha
             presentMode,                                                // presentMode
             VK_TRUE,                                                    // clipped
-            oldSwapchain == nullptr ? nullptr : oldSwapchain->swapchain // oldSwapchain        
+            pOldSwapchain ? pOldSwapchain->swapchain : nullptr          // oldSwapchain        
         );
 
         if(queueIndices.graphicFamily != queueIndices.presentFamily)
@@ -235,54 +477,272 @@ namespace dot
         }
     }
 
-    void Swapchain::createRenderPass()
+    void Swapchain::createDepthImages()
     {
-        vk::AttachmentDescription colorAttachment
+        if(!hasDepth())
+            return;
+
+        // depth is only needed while the render pass runs, its contents are never stored
+
+        depthImages.reserve(images.size());
+        for(size_t i = 0; i < images.size(); i++)
+            depthImages.emplace_back(std::make_unique<Image>
+            (
+                device, extent, depthFormat,
+                vk::ImageUsageFlagBits::eDepthStencilAttachment | vk::ImageUsageFlagBits::eTransientAttachment,
+                vk::MemoryPropertyFlagBits::eDeviceLocal | vk::MemoryPropertyFlagBits::eLazilyAllocated,
+                vk::ImageAspectFlagBits::eDepth, samples
+            ));
+    }
+
+    void Swapchain::createColorImages()
+    {
+        if(samples == vk::SampleCountFlagBits::e1)
+            return;
+
+        // the samples are resolved at the end of the scene subpass, only the resolved image is ever stored
+
+        colorImages.reserve(images.size());
+        for(size_t i = 0; i < images.size(); i++)
+            colorImages.emplace_back(std::make_unique<Image>
+            (
+                device, extent, getStageFormat(0),
+                vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eTransientAttachment,
+                vk::MemoryPropertyFlagBits::eDeviceLocal | vk::MemoryPropertyFlagBits::eLazilyAllocated,
+                vk::ImageAspectFlagBits::eColor, samples
+            ));
+    }
+
+    void Swapchain::createPostTargets()
+    {
+        for(auto effect : {PostTonemap, PostGrade, PostVignette, PostFxaa})
+            if(post.effects & effect)
+                effects.push_back(effect);
+
+        // merging stops at the first effect reading neighbouring pixels, an input attachment only sees its own
+
+        mergedStages = 0;
+        if(post.merged)
+            while(mergedStages < effects.size() && effects[mergedStages] != PostFxaa)
+                mergedStages++;
+
+        // effects read their input as input attachments, which only exist inside a render pass
+
+        if(!effects.empty())
+            dynamicRendering = false;
+
+        // a target consumed by a subpass of the same render pass never leaves tile memory on tiled gpus,
+        // lazily allocated memory lets the driver skip backing it at all
+
+        postTargets.resize(effects.size());
+        for(size_t stage = 0; stage < effects.size(); stage++)
+        {
+            const bool transient = stage < mergedStages;
+
+            vk::ImageUsageFlags usage = vk::ImageUsageFlagBits::eColorAttachment | vk::ImageUsageFlagBits::eInputAttachment;
+            usage |= transient ? vk::ImageUsageFlagBits::eTransientAttachment : vk::ImageUsageFlagBits::eSampled;
+
+            vk::MemoryPropertyFlags memoryProperty = vk::MemoryPropertyFlagBits::eDeviceLocal;
+            if(transient)
+                memoryProperty |= vk::MemoryPropertyFlagBits::eLazilyAllocated;
+
+            postTargets[stage].reserve(images.size());
+            for(size_t i = 0; i < images.size(); i++)
+                postTargets[stage].emplace_back(std::make_unique<Image>
+                (
+                    device, extent, getStageFormat(stage), usage, memoryProperty, vk::ImageAspectFlagBits::eColor
+                ));
+        }
+    }
+
+    void Swapchain::createRenderPass(Swapchain* pOldSwapchain)
+    {
+        const bool multisampled = samples != vk::SampleCountFlagBits::e1;
+
+        clearValues.assign(mergedStages + 1, vk::ClearColorValue());
+        if(hasDepth())
+            clearValues.emplace_back(vk::ClearDepthStencilValue(1.0f, 0));
+        if(multisampled)
+            clearValues.emplace_back(vk::ClearColorValue());
+
+        if(dynamicRendering)
+            return;
+
+        // a render pass only depends on the attachment formats, pipelines built for it stay valid across resizes
+
+        if(
+            pOldSwapchain && pOldSwapchain->ownsRenderPass && !pOldSwapchain->dynamicRendering && pOldSwapchain->imageFormat == imageFormat &&
+            pOldSwapchain->depthFormat == depthFormat && pOldSwapchain->samples == samples && pOldSwapchain->post == post
+        )
+        {
+            renderPass = pOldSwapchain->renderPass;
+            pOldSwapchain->ownsRenderPass = false;
+            return;
+        }
+
+        // one color attachment per merged stage followed by depth and the multisampled scene color; only the last
+        // stage is stored, presented when no render pass of its own follows. with multisampling the first stage
+        // is the resolve target, written in full by the resolve
+
+        std::vector<vk::AttachmentDescription> attachments;
+        for(size_t stage = 0; stage <= mergedStages; stage++)
+        {
+            const bool last = stage == mergedStages;
+            const bool presented = last && mergedStages == effects.size();
+
+            attachments.emplace_back
+            (
+                stage == 0 ? vk::AttachmentDescriptionFlagBits::eMayAlias : vk::AttachmentDescriptionFlags(0U), // flags
+                getStageFormat(stage),                                                                          // format
+                vk::SampleCountFlagBits::e1,                                                                    // samples
+                stage == 0 && !multisampled ? vk::AttachmentLoadOp::eClear : vk::AttachmentLoadOp::eDontCare,   // loadOp
+                last ? vk::AttachmentStoreOp::eStore : vk::AttachmentStoreOp::eDontCare,                        // storeOp
+                vk::AttachmentLoadOp::eDontCare,                                                                // stencilLoadOp
+                vk::AttachmentStoreOp::eDontCare,                                                               // stencilStoreOp
+                vk::ImageLayout::eUndefined,                                                                    // initialLayout
+                presented ? vk::ImageLayout::ePresentSrcKHR : vk::ImageLayout::eShaderReadOnlyOptimal           // finalLayout
+            );
+        }
+
+        vk::AttachmentDescription depthAttachment
         (
-            vk::AttachmentDescriptionFlagBits::eMayAlias,   // flags
-            imageFormat,                                    // format
-            vk::SampleCountFlagBits::e1,                    // samples
-            vk::AttachmentLoadOp::eClear,                   // loadOp
-            vk::AttachmentStoreOp::eStore,                  // storeOp
-            vk::AttachmentLoadOp::eDontCare,                // stencilLoadOp
-            vk::AttachmentStoreOp::eDontCare,               // stencilStoreOp
-            vk::ImageLayout::eUndefined,                    // initialLayout
-            vk::ImageLayout::ePresentSrcKHR                 // finalLayout
+            vk::AttachmentDescriptionFlags(0U),                 // flags
+            depthFormat,                                        // format
+            samples,                                            // samples
+            vk::AttachmentLoadOp::eClear,                       // loadOp
+            vk::AttachmentStoreOp::eDontCare,                   // storeOp
+            vk::AttachmentLoadOp::eDontCare,                    // stencilLoadOp
+            vk::AttachmentStoreOp::eDontCare,                   // stencilStoreOp
+            vk::ImageLayout::eUndefined,                        // initialLayout
+            vk::ImageLayout::eDepthStencilAttachmentOptimal     // finalLayout
         );
 
-        vk::AttachmentReference colorAttachmentRef
+        vk::AttachmentReference depthAttachmentRef
         (
-            0,                                          // attachment
-            vk::ImageLayout::eColorAttachmentOptimal    // layout
+            static_cast<uint32_t>(mergedStages + 1),            // attachment
+            vk::ImageLayout::eDepthStencilAttachmentOptimal     // layout
         );
 
-        auto colorAttachments = {colorAttachment};
+        if(hasDepth())
+            attachments.push_back(depthAttachment);
 
-        vk::SubpassDescription subpass
+        vk::AttachmentDescription colorAttachment
         (
-            vk::SubpassDescriptionFlags(0U),    // flags
-            vk::PipelineBindPoint::eGraphics,   // pipelineBindPoint
-            {},                                 // inputAttachments
-            colorAttachmentRef                  // colorAttachments
+            vk::AttachmentDescriptionFlags(0U),                 // flags
+            getStageFormat(0),                                  // format
+            samples,                                            // samples
+            vk::AttachmentLoadOp::eClear,                       // loadOp
+            vk::AttachmentStoreOp::eDontCare,                   // storeOp
+            vk::AttachmentLoadOp::eDontCare,                    // stencilLoadOp
+            vk::AttachmentStoreOp::eDontCare,                   // stencilStoreOp
+            vk::ImageLayout::eUndefined,                        // initialLayout
+            vk::ImageLayout::eColorAttachmentOptimal            // finalLayout
         );
 
-        vk::SubpassDependency dependency
+        vk::AttachmentReference resolveAttachmentRef
+        (
+            0U,                                                 // attachment
+            vk::ImageLayout::eColorAttachmentOptimal            // layout
+        );
+
+        if(multisampled)
+            attachments.push_back(colorAttachment);
+
+        std::vector<vk::AttachmentReference> colorAttachmentRefs;
+        std::vector<vk::AttachmentReference> inputAttachmentRefs;
+        std::vector<vk::SubpassDescription> subpasses;
+
+        for(uint32_t stage = 0; stage <= mergedStages; stage++)
+        {
+            const uint32_t attachment = stage == 0 && multisampled ? static_cast<uint32_t>(attachments.size() - 1) : stage;
+
+            colorAttachmentRefs.emplace_back(attachment, vk::ImageLayout::eColorAttachmentOptimal);
+            inputAttachmentRefs.emplace_back(stage - 1, vk::ImageLayout::eShaderReadOnlyOptimal);
+        }
+
+        for(size_t stage = 0; stage <= mergedStages; stage++)
+            subpasses.emplace_back
+            (
+                vk::SubpassDescriptionFlags(0U),                                // flags
+                vk::PipelineBindPoint::eGraphics,                               // pipelineBindPoint
+                stage ? 1U : 0U,                                                // inputAttachmentCount
+                &inputAttachmentRefs[stage],                                    // pInputAttachments
+                1U,                                                             // colorAttachmentCount
+                &colorAttachmentRefs[stage],                                    // pColorAttachments
+                stage == 0 && multisampled ? &resolveAttachmentRef : nullptr,   // pResolveAttachments
+                stage == 0 && hasDepth() ? &depthAttachmentRef : nullptr        // pDepthStencilAttachment
+            );
+
+        // the previous frame's depth tests and color writes to the same attachments finish before this pass touches them
+
+        vk::PipelineStageFlags stages = vk::PipelineStageFlagBits::eColorAttachmentOutput;
+        vk::AccessFlags srcAccess = vk::AccessFlagBits::eNone;
+        vk::AccessFlags dstAccess = vk::AccessFlagBits::eColorAttachmentWrite;
+        if(hasDepth())
+        {
+            stages |= vk::PipelineStageFlagBits::eEarlyFragmentTests | vk::PipelineStageFlagBits::eLateFragmentTests;
+            srcAccess |= vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+            dstAccess |= vk::AccessFlagBits::eDepthStencilAttachmentWrite;
+        }
+
+        std::vector<vk::SubpassDependency> dependencies;
+        dependencies.emplace_back
         (
-            0U,                                                 // srcSubpass 
+            VK_SUBPASS_EXTERNAL,                                // srcSubpass 
             0U,                                                 // dstSubpass
-            vk::PipelineStageFlagBits::eColorAttachmentOutput,  // srcStageMask
-            vk::PipelineStageFlagBits::eColorAttachmentOutput,  // dstStageMask
-            vk::AccessFlagBits::eNone,                          // srcAccessMask      
-            vk::AccessFlagBits::eColorAttachmentWrite,          // dstAccessMask
+            stages,                                             // srcStageMask
+            stages,                                             // dstStageMask
+            srcAccess,                                          // srcAccessMask      
+            dstAccess,                                          // dstAccessMask
             vk::DependencyFlagBits::eByRegion                   // dependencyFlags
         );
 
+        // each effect reads only the pixel it writes, by region lets tiled gpus run the whole chain per tile
+
+        for(uint32_t stage = 1; stage <= mergedStages; stage++)
+            dependencies.emplace_back
+            (
+                stage - 1,                                          // srcSubpass
+                stage,                                              // dstSubpass
+                vk::PipelineStageFlagBits::eColorAttachmentOutput,  // srcStageMask
+                vk::PipelineStageFlagBits::eFragmentShader,         // dstStageMask
+                vk::AccessFlagBits::eColorAttachmentWrite,          // srcAccessMask
+                vk::AccessFlagBits::eInputAttachmentRead,           // dstAccessMask
+                vk::DependencyFlagBits::eByRegion                   // dependencyFlags
+            );
+
+        // the last merged stage writes the presented image, it waits for the acquire like the first subpass
+
+        if(mergedStages)
+            dependencies.emplace_back
+            (
+                VK_SUBPASS_EXTERNAL,                                // srcSubpass
+                static_cast<uint32_t>(mergedStages),                // dstSubpass
+                vk::PipelineStageFlagBits::eColorAttachmentOutput,  // srcStageMask
+                vk::PipelineStageFlagBits::eColorAttachmentOutput,  // dstStageMask
+                vk::AccessFlagBits::eNone,                          // srcAccessMask
+                vk::AccessFlagBits::eColorAttachmentWrite,          // dstAccessMask
+                vk::DependencyFlags()                               // dependencyFlags
+            );
+
+        if(mergedStages < effects.size())
+            dependencies.emplace_back
+            (
+                static_cast<uint32_t>(mergedStages),                                            // srcSubpass
+                VK_SUBPASS_EXTERNAL,                                                            // dstSubpass
+                vk::PipelineStageFlagBits::eColorAttachmentOutput,                              // srcStageMask
+                vk::PipelineStageFlagBits::eFragmentShader,                                     // dstStageMask
+                vk::AccessFlagBits::eColorAttachmentWrite,                                      // srcAccessMask
+                vk::AccessFlagBits::eInputAttachmentRead | vk::AccessFlagBits::eShaderRead,     // dstAccessMask
+                vk::DependencyFlags()                                                           // dependencyFlags
+            );
+
         vk::RenderPassCreateInfo createInfo
         (
             vk::RenderPassCreateFlags(0U),  // flags
-            colorAttachment,                // attachments
-            subpass,                        // subpasses
-            dependency                      // dependencies
+            attachments,                    // attachments
+            subpasses,                      // subpasses
+            dependencies                    // dependencies
         );
 
         try
@@ -295,26 +755,101 @@ namespace dot
         }
     }
 
-    void Swapchain::createFramebuffers()
+    void Swapchain::createStageRenderPasses(Swapchain* pOldSwapchain)
     {
-        const size_t length = imageViews.size();
-        framebuffers.reserve(length);
+        if(
+            pOldSwapchain && pOldSwapchain->ownsStageRenderPasses &&
+            pOldSwapchain->imageFormat == imageFormat && pOldSwapchain->post == post
+        )
+        {
+            stageRenderPasses = pOldSwapchain->stageRenderPasses;
+            pOldSwapchain->ownsStageRenderPasses = false;
+            return;
+        }
 
-        for(size_t i = 0; i < length; i++)
+        // every stage after the merged ones reads the stored output of the previous stage, from memory
+
+        for(size_t stage = mergedStages + 1; stage <= effects.size(); stage++)
         {
-            vk::FramebufferCreateInfo createInfo
+            const bool presented = stage == effects.size();
+            const bool input = effects[stage - 1] != PostFxaa;
+
+            std::vector<vk::AttachmentDescription> attachments;
+            attachments.emplace_back
             (
-                vk::FramebufferCreateFlags(0U), // flags
-                renderPass,                     // renderPass
-                imageViews[i],                  // attachments
-                extent.width,                   // width
-                extent.height,                  // height
-                1                               // layers 
+                vk::AttachmentDescriptionFlags(0U),                                                     // flags
+                getStageFormat(stage),                                                                  // format
+                vk::SampleCountFlagBits::e1,                                                            // samples
+                vk::AttachmentLoadOp::eDontCare,                                                        // loadOp
+                vk::AttachmentStoreOp::eStore,                                                          // storeOp
+                vk::AttachmentLoadOp::eDontCare,                                                        // stencilLoadOp
+                vk::AttachmentStoreOp::eDontCare,                                                       // stencilStoreOp
+                vk::ImageLayout::eUndefined,                                                            // initialLayout
+                presented ? vk::ImageLayout::ePresentSrcKHR : vk::ImageLayout::eShaderReadOnlyOptimal   // finalLayout
+            );
+
+            if(input)
+                attachments.emplace_back
+                (
+                    vk::AttachmentDescriptionFlags(0U),         // flags
+                    getStageFormat(stage - 1),                  // format
+                    vk::SampleCountFlagBits::e1,                // samples
+                    vk::AttachmentLoadOp::eLoad,                // loadOp
+                    vk::AttachmentStoreOp::eDontCare,           // storeOp
+                    vk::AttachmentLoadOp::eDontCare,            // stencilLoadOp
+                    vk::AttachmentStoreOp::eDontCare,           // stencilStoreOp
+                    vk::ImageLayout::eShaderReadOnlyOptimal,    // initialLayout
+                    vk::ImageLayout::eShaderReadOnlyOptimal     // finalLayout
+                );
+
+            vk::AttachmentReference colorAttachmentRef(0, vk::ImageLayout::eColorAttachmentOptimal);
+            vk::AttachmentReference inputAttachmentRef(1, vk::ImageLayout::eShaderReadOnlyOptimal);
+
+            vk::SubpassDescription subpass
+            (
+                vk::SubpassDescriptionFlags(0U),        // flags
+                vk::PipelineBindPoint::eGraphics,       // pipelineBindPoint
+                input ? 1U : 0U,                        // inputAttachmentCount
+                &inputAttachmentRef,                    // pInputAttachments
+                1U,                                     // colorAttachmentCount
+                &colorAttachmentRef                     // pColorAttachments
+            );
+
+            std::vector<vk::SubpassDependency> dependencies;
+            dependencies.emplace_back
+            (
+                VK_SUBPASS_EXTERNAL,                                                                                            // srcSubpass
+                0U,                                                                                                             // dstSubpass
+                vk::PipelineStageFlagBits::eColorAttachmentOutput,                                                              // srcStageMask
+                vk::PipelineStageFlagBits::eFragmentShader | vk::PipelineStageFlagBits::eColorAttachmentOutput,                 // dstStageMask
+                vk::AccessFlagBits::eColorAttachmentWrite,                                                                      // srcAccessMask
+                vk::AccessFlagBits::eInputAttachmentRead | vk::AccessFlagBits::eShaderRead | vk::AccessFlagBits::eColorAttachmentWrite, // dstAccessMask
+                vk::DependencyFlags()                                                                                           // dependencyFlags
+            );
+
+            if(!presented)
+                dependencies.emplace_back
+                (
+                    0U,                                                                             // srcSubpass
+                    VK_SUBPASS_EXTERNAL,                                                            // dstSubpass
+                    vk::PipelineStageFlagBits::eColorAttachmentOutput,                              // srcStageMask
+                    vk::PipelineStageFlagBits::eFragmentShader,                                     // dstStageMask
+                    vk::AccessFlagBits::eColorAttachmentWrite,                                      // srcAccessMask
+                    vk::AccessFlagBits::eInputAttachmentRead | vk::AccessFlagBits::eShaderRead,     // dstAccessMask
+                    vk::DependencyFlags()                                                           // dependencyFlags
+                );
+
+            vk::RenderPassCreateInfo createInfo
+            (
+                vk::RenderPassCreateFlags(0U),  // flags
+                attachments,                    // attachments
+                subpass,                        // subpasses
+                dependencies                    // dependencies
             );
 
             try
             {
-                framebuffers.emplace_back(device.getVkDevice().createFramebuffer(createInfo));
+                stageRenderPasses.push_back(device.getVkDevice().createRenderPass(createInfo));
             }
             catch(const std::runtime_error& e)
             {
@@ -322,24 +857,92 @@ namespace dot
             }
         }
     }
-    
+
+    void Swapchain::createFramebuffers()
+    {
+        if(dynamicRendering)
+            return;
+
+        for(size_t i = 0; i < imageViews.size(); i++)
+        {
+            std::vector<vk::ImageView> attachments;
+            for(size_t stage = 0; stage <= mergedStages; stage++)
+                attachments.push_back(getStageOutput(stage, i));
+
+            if(hasDepth())
+                attachments.push_back(depthImages[i]->getView());
+
+            if(!colorImages.empty())
+                attachments.push_back(colorImages[i]->getView());
+
+            framebuffers.emplace_back(createFramebuffer(renderPass, attachments));
+        }
+    }
+
+    void Swapchain::createStageFramebuffers()
+    {
+        stageFramebuffers.resize(stageRenderPasses.size());
+
+        for(size_t i = 0; i < imageViews.size(); i++)
+            for(size_t stage = mergedStages + 1; stage <= effects.size(); stage++)
+            {
+                std::vector<vk::ImageView> attachments = {getStageOutput(stage, i)};
+                if(effects[stage - 1] != PostFxaa)
+                    attachments.push_back(getStageInput(stage, i));
+
+                stageFramebuffers[stage - mergedStages - 1].emplace_back(createFramebuffer(getStageRenderPass(stage), attachments));
+            }
+    }
+
+    vk::Framebuffer Swapchain::createFramebuffer(const vk::RenderPass& pass, const std::vector<vk::ImageView>& attachments) const
+    {
+        vk::FramebufferCreateInfo createInfo
+        (
+            vk::FramebufferCreateFlags(0U), // flags
+            pass,                           // renderPass
+            attachments,                    // attachments
+            extent.width,                   // width
+            extent.height,                  // height
+            1                               // layers 
+        );
+
+        try
+        {
+            return device.getVkDevice().createFramebuffer(createInfo);
+        }
+        catch(const std::runtime_error& e)
+        {
+            throw DOT_RUNTIME_WHAT(e);
+        }
+    }
+
+    vk::Format Swapchain::getStageFormat(size_t stage) const noexcept
+    {
+        // tonemapping needs the scene in high dynamic range, everything after it is display referred
+
+        if(stage == effects.size())
+            return imageFormat;
+
+        return stage == 0 && effects.front() == PostTonemap ? vk::Format::eR16G16B16A16Sfloat : imageFormat;
+    }
+
+    const vk::ImageView& Swapchain::getStageOutput(size_t stage, size_t index) const noexcept
+    {
+        return stage == effects.size() ? imageViews[index] : postTargets[stage][index]->getView();
+    }
+
     void Swapchain::createSyncObjects()
     {
-        imageAvailableSemaphores.reserve(maxFramesInFlight);
-        renderFinishedSemaphores.reserve(maxFramesInFlight);
-        imageInFlightFences.reserve(maxFramesInFlight);
+        // presentation waits on a semaphore per image, safe to signal again once the image is acquired again
+
+        renderFinishedSemaphores.reserve(images.size());
 
         vk::SemaphoreCreateInfo semaphoreInfo;
-        vk::FenceCreateInfo fenceInfo(vk::FenceCreateFlagBits::eSignaled);
 
         try
         {
-            for(size_t i = 0; i < maxFramesInFlight; i++)
-            {
-                imageAvailableSemaphores.emplace_back(device.getVkDevice().createSemaphore(semaphoreInfo));
+            for(size_t i = 0; i < images.size(); i++)
                 renderFinishedSemaphores.emplace_back(device.getVkDevice().createSemaphore(semaphoreInfo));
-                imageInFlightFences.emplace_back(device.getVkDevice().createFence(fenceInfo));
-            }
         }
         catch(const std::runtime_error& e)
         {
@@ -349,11 +952,7 @@ namespace dot
 
     void Swapchain::destroySyncObjects()
     {
-        for(size_t i = 0; i < maxFramesInFlight; i++)
-        {
-            device.getVkDevice().destroySemaphore(imageAvailableSemaphores[i]);
-            device.getVkDevice().destroySemaphore(renderFinishedSemaphores[i]);
-            device.getVkDevice().destroyFence(imageInFlightFences[i]);
-        }
+        for(const auto& semaphore : renderFinishedSemaphores)
+            device.getVkDevice().destroySemaphore(semaphore);
     }
 }
\ No newline at end of file
@@ -0,0 +1,143 @@
+#include "dot_Transforms.h"
+#include "dot_Exception.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstring>
+
+namespace dot
+{
+    static vk::DeviceSize alignUp(vk::DeviceSize size, vk::DeviceSize alignment) noexcept
+    {
+        return alignment ? (size + alignment - 1) / alignment * alignment : size;
+    }
+
+    Transforms::Transforms(Device& device, Descriptors& descriptors, size_t regionCount, uint32_t capacity)
+        : allocator(device.getVkDevice(), 1), regionCount(std::max<size_t>(regionCount, 1)), capacity(std::max(capacity, 1U)), device(device), descriptors(descriptors)
+    {
+        createBuffers();
+        createDescriptorSet();
+    }
+
+    void Transforms::begin(size_t region) noexcept
+    {
+        this->region = region % regionCount;
+        count = 0;
+
+        setCamera(camera);
+    }
+
+    void Transforms::setCamera(const glm::mat4& viewProj) noexcept
+    {
+        camera = viewProj;
+        std::memcpy(static_cast<char*>(pCameraBuffer->data) + region * cameraStride, &camera, sizeof(camera));
+    }
+
+    const glm::mat4& Transforms::getCamera() const noexcept
+    {
+        return camera;
+    }
+
+    Result<uint32_t> Transforms::add(const glm::mat4& model) noexcept
+    {
+        return add({&model, 1});
+    }
+
+    Result<uint32_t> Transforms::add(std::span<const glm::mat4> models) noexcept
+    {
+        if(models.size() > capacity - count)
+            return Error{vk::Result::eErrorOutOfDeviceMemory, "Object buffer region is full!"};
+
+        const uint32_t first = count;
+        std::memcpy(static_cast<char*>(pObjectBuffer->data) + region * objectStride + first * sizeof(glm::mat4), models.data(), models.size_bytes());
+        count += static_cast<uint32_t>(models.size());
+
+        return first;
+    }
+
+    void Transforms::bind(const vk::CommandBuffer& cmdBuffer, const vk::PipelineLayout& layout) const noexcept
+    {
+        const uint32_t offsets[] = {static_cast<uint32_t>(region * cameraStride), static_cast<uint32_t>(region * objectStride)};
+        cmdBuffer.bindDescriptorSets(vk::PipelineBindPoint::eGraphics, layout, 0, descriptorSet, offsets);
+    }
+
+    size_t Transforms::getRegionCount() const noexcept
+    {
+        return regionCount;
+    }
+
+    uint32_t Transforms::getCount() const noexcept
+    {
+        return count;
+    }
+
+    uint32_t Transforms::getCapacity() const noexcept
+    {
+        return capacity;
+    }
+
+    void Transforms::push(const vk::CommandBuffer& cmdBuffer, const vk::PipelineLayout& layout, const TransformPush& transform) noexcept
+    {
+        cmdBuffer.pushConstants(layout, vk::ShaderStageFlagBits::eVertex, 0, offsetof(TransformPush, materialIndex) + sizeof(TransformPush::materialIndex), &transform);
+    }
+
+    void Transforms::pushObject(const vk::CommandBuffer& cmdBuffer, const vk::PipelineLayout& layout, uint32_t objectIndex) noexcept
+    {
+        // four bytes per draw, the matrix stays whatever was pushed before
+
+        cmdBuffer.pushConstants(layout, vk::ShaderStageFlagBits::eVertex, offsetof(TransformPush, objectIndex), sizeof(objectIndex), &objectIndex);
+    }
+
+    void Transforms::pushMaterial(const vk::CommandBuffer& cmdBuffer, const vk::PipelineLayout& layout, uint32_t materialIndex) noexcept
+    {
+        cmdBuffer.pushConstants(layout, vk::ShaderStageFlagBits::eVertex, offsetof(TransformPush, materialIndex), sizeof(materialIndex), &materialIndex);
+    }
+
+    std::vector<vk::DescriptorSetLayoutBinding> Transforms::getBindings()
+    {
+        return
+        {
+            {0, vk::DescriptorType::eUniformBufferDynamic, 1, vk::ShaderStageFlagBits::eVertex},   // camera
+            {1, vk::DescriptorType::eStorageBufferDynamic, 1, vk::ShaderStageFlagBits::eVertex}    // objects
+        };
+    }
+
+    void Transforms::createBuffers()
+    {
+        // host visible and coherent, written by the cpu while the gpu reads the regions of other frames
+
+        const vk::PhysicalDeviceLimits limits = device.getLimits();
+        cameraStride = alignUp(sizeof(glm::mat4), limits.minUniformBufferOffsetAlignment);
+        objectStride = alignUp(vk::DeviceSize(capacity) * sizeof(glm::mat4), limits.minStorageBufferOffsetAlignment);
+
+        const vk::MemoryPropertyFlags memoryProperty = vk::MemoryPropertyFlagBits::eHostVisible | vk::MemoryPropertyFlagBits::eHostCoherent;
+
+        pCameraBuffer = std::make_unique<Buffer>(device, cameraStride, regionCount, vk::BufferUsageFlagBits::eUniformBuffer, memoryProperty);
+        pObjectBuffer = std::make_unique<Buffer>(device, objectStride, regionCount, vk::BufferUsageFlagBits::eStorageBuffer, memoryProperty);
+
+        DOT_CHECK(pCameraBuffer->map());
+        DOT_CHECK(pObjectBuffer->map());
+
+        for(size_t i = 0; i < regionCount; i++)
+            std::memcpy(static_cast<char*>(pCameraBuffer->data) + i * cameraStride, &camera, sizeof(camera));
+    }
+
+    void Transforms::createDescriptorSet()
+    {
+        // one set for every region, the dynamic offsets select the region
+
+        const DescriptorLayout& layout = descriptors.getLayout(getBindings());
+
+        const DescriptorInfo infos[] =
+        {
+            DescriptorInfo::fromBuffer(*pCameraBuffer, 0, sizeof(glm::mat4)),
+            DescriptorInfo::fromBuffer(*pObjectBuffer, 0, objectStride)
+        };
+
+        auto set = allocator.allocate(layout.setLayout);
+        DOT_CHECK(set);
+        DOT_CHECK(descriptors.update(set.value(), layout, infos));
+
+        descriptorSet = set.value();
+    }
+}
\ No newline at end of file
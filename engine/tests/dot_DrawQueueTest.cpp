@@ -0,0 +1,77 @@
+#include "dot_DrawQueue.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <numeric>
+#include <random>
+#include <vector>
+
+// the queue sorts on the cpu only, draws are never recorded so no device is needed
+
+namespace
+{
+    bool checkSort(size_t drawCount, size_t workerCount, uint32_t seed)
+    {
+        // few distinct keys so most of them repeat, the object index tells the submission order of a draw
+
+        std::mt19937 random(seed);
+        std::uniform_int_distribution<uint32_t> state(0, 7);
+        std::uniform_real_distribution<float> depth(0.0f, 1.0f);
+
+        std::vector<uint64_t> keys(drawCount);
+        for(auto& key : keys)
+            key = dot::DrawQueue::makeKey(state(random) % 2, state(random), state(random), state(random), static_cast<float>(state(random)) / 7.0f);
+
+        std::vector<uint32_t> expected(drawCount);
+        std::iota(expected.begin(), expected.end(), 0U);
+        std::stable_sort(expected.begin(), expected.end(), [&](uint32_t a, uint32_t b){ return keys[a] < keys[b]; });
+
+        dot::DrawQueue queue(workerCount);
+
+        // a second round reuses the workers the first one started
+
+        for(int round = 0; round < 2; round++)
+        {
+            queue.clear();
+            queue.reserve(drawCount);
+
+            for(size_t i = 0; i < drawCount; i++)
+            {
+                dot::DrawQueue::Draw draw{};
+                draw.objectIndex = static_cast<uint32_t>(i);
+                queue.push(keys[i], draw);
+            }
+
+            queue.sort();
+
+            for(size_t position = 0; position < drawCount; position++)
+                if(queue.getDraw(position).objectIndex != expected[position])
+                {
+                    std::printf("%zu draws on %zu workers: draw %u at %zu, expected %u\n",
+                        drawCount, workerCount, queue.getDraw(position).objectIndex, position, expected[position]);
+                    return false;
+                }
+        }
+
+        return true;
+    }
+}
+
+int main()
+{
+    // below and above the parallel threshold, with one worker and with several
+
+    bool passed = true;
+    passed &= checkSort(0, 1, 1);
+    passed &= checkSort(1, 1, 2);
+    passed &= checkSort(1000, 1, 3);
+    passed &= checkSort(1000, 4, 4);
+    passed &= checkSort(50000, 1, 5);
+    passed &= checkSort(50000, 4, 6);
+    passed &= checkSort(50001, 3, 7);
+    passed &= checkSort(20000, 8, 8);
+
+    std::printf(passed ? "draw queue sort passed\n" : "draw queue sort failed\n");
+
+    return passed ? 0 : 1;
+}
\ No newline at end of file